@@ -0,0 +1,166 @@
+/**
+ * @brief - Implements cpu affinity and numa placement helpers.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <cpu_affinity.h>
+
+namespace firewall {
+
+//
+// node masks are one word, enough for the sensors we run on
+#define CPU_AFFINITY_MAX_NUMA_NODES 64
+
+static int cpu_list_parse_num(const std::string &s, uint32_t &val)
+{
+    if (s.empty() || !std::all_of(s.begin(), s.end(), ::isdigit)) {
+        return -1;
+    }
+
+    try {
+        unsigned long v = std::stoul(s);
+
+        if (v >= CPU_SETSIZE) {
+            return -1;
+        }
+
+        val = v;
+    } catch (...) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int cpu_list_parse(const std::string &list, std::vector<uint32_t> &cpus)
+{
+    size_t start = 0;
+
+    cpus.clear();
+
+    while (start < list.size()) {
+        size_t end = list.find(',', start);
+        std::string range;
+        size_t dash;
+        uint32_t lo;
+        uint32_t hi;
+
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+
+        range = list.substr(start, end - start);
+        start = end + 1;
+
+        // trailing newline of the sysfs files
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty()) {
+            continue;
+        }
+
+        dash = range.find('-');
+        if (dash == std::string::npos) {
+            if (cpu_list_parse_num(range, lo) < 0) {
+                return -1;
+            }
+            hi = lo;
+        } else {
+            if ((cpu_list_parse_num(range.substr(0, dash), lo) < 0) ||
+                (cpu_list_parse_num(range.substr(dash + 1), hi) < 0) ||
+                (lo > hi)) {
+                return -1;
+            }
+        }
+
+        for (; lo <= hi; lo ++) {
+            cpus.push_back(lo);
+        }
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    return 0;
+}
+
+int cpu_affinity_set(pthread_t thr, const std::vector<uint32_t> &cpus)
+{
+    cpu_set_t set;
+
+    if (cpus.empty()) {
+        return 0;
+    }
+
+    CPU_ZERO(&set);
+    for (auto it : cpus) {
+        CPU_SET(it, &set);
+    }
+
+    if (pthread_setaffinity_np(thr, sizeof(set), &set) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int cpu_affinity_intf_numa_node(const std::string &ifname)
+{
+    std::ifstream f("/sys/class/net/" + ifname + "/device/numa_node");
+    int node = -1;
+
+    if (!f.is_open()) {
+        return -1;
+    }
+
+    f >> node;
+    if (f.fail() || (node < 0) || (node >= CPU_AFFINITY_MAX_NUMA_NODES)) {
+        return -1;
+    }
+
+    return node;
+}
+
+int cpu_affinity_numa_cpus(int node, std::vector<uint32_t> &cpus)
+{
+    std::ifstream f("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+
+    if (!f.is_open()) {
+        return -1;
+    }
+
+    std::getline(f, list);
+
+    return cpu_list_parse(list, cpus);
+}
+
+//
+// no libnuma, the syscall takes a bitmask of nodes.
+int numa_prefer_node(int node)
+{
+    unsigned long mask;
+    long rc;
+
+    if (node >= CPU_AFFINITY_MAX_NUMA_NODES) {
+        return -1;
+    }
+
+    if (node < 0) {
+        rc = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    } else {
+        mask = 1UL << node;
+        rc = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask,
+                     CPU_AFFINITY_MAX_NUMA_NODES + 1);
+    }
+
+    return (rc < 0) ? -1 : 0;
+}
+
+}
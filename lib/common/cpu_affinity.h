@@ -0,0 +1,69 @@
+/**
+ * @brief - Implements cpu affinity and numa placement helpers.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_LIB_COMMON_CPU_AFFINITY_H__
+#define __FW_LIB_COMMON_CPU_AFFINITY_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+namespace firewall {
+
+/**
+ * @brief - parse a cpu list such as "0-3,8,10-11".
+ *
+ * @param [in] list - cpu list, same format as the kernel cpulist files
+ * @param [out] cpus - cpus of the list in increasing order
+ *
+ * @return 0 on success, -1 if the list is malformed.
+*/
+int cpu_list_parse(const std::string &list, std::vector<uint32_t> &cpus);
+
+/**
+ * @brief - pin a thread to a set of cpus.
+ *
+ * An empty set leaves the thread free to run on any cpu.
+ *
+ * @param [in] thr - thread
+ * @param [in] cpus - cpus to run on
+ *
+ * @return 0 on success, -1 on failure.
+*/
+int cpu_affinity_set(pthread_t thr, const std::vector<uint32_t> &cpus);
+
+/**
+ * @brief - numa node the network device is attached to.
+ *
+ * @param [in] ifname - interface name
+ *
+ * @return node, -1 if the device has no node (virtual or single node system).
+*/
+int cpu_affinity_intf_numa_node(const std::string &ifname);
+
+/**
+ * @brief - cpus of a numa node.
+ *
+ * @param [in] node - numa node
+ * @param [out] cpus - cpus of the node
+ *
+ * @return 0 on success, -1 on failure.
+*/
+int cpu_affinity_numa_cpus(int node, std::vector<uint32_t> &cpus);
+
+/**
+ * @brief - prefer a numa node for the memory the calling thread faults in.
+ *
+ * @param [in] node - numa node, -1 to go back to the default policy
+ *
+ * @return 0 on success, -1 on failure.
+*/
+int numa_prefer_node(int node);
+
+}
+
+#endif
@@ -0,0 +1,225 @@
+/**
+ * @brief - Implements longest prefix match of ip addresses.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <arpa/inet.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <ip_lpm.h>
+
+namespace firewall {
+
+int ip_prefix_parse(const std::string &str,
+                    uint32_t &addr_len,
+                    uint8_t *addr,
+                    uint32_t &prefix_len)
+{
+    std::string ip = str;
+    size_t slash = str.find('/');
+    char *end = nullptr;
+
+    memset(addr, 0, IP_LPM_V6_ADDR_LEN);
+
+    if (slash != std::string::npos) {
+        ip = str.substr(0, slash);
+    }
+
+    if (inet_pton(AF_INET, ip.c_str(), addr) == 1) {
+        addr_len = IP_LPM_V4_ADDR_LEN;
+    } else if (inet_pton(AF_INET6, ip.c_str(), addr) == 1) {
+        addr_len = IP_LPM_V6_ADDR_LEN;
+    } else {
+        return -1;
+    }
+
+    prefix_len = addr_len * 8;
+    if (slash != std::string::npos) {
+        if (slash + 1 == str.size()) {
+            return -1;
+        }
+
+        prefix_len = strtoul(str.c_str() + slash + 1, &end, 10);
+        if ((*end != '\0') || (prefix_len > addr_len * 8)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int ip_lpm::add(const uint8_t *addr, uint32_t prefix_len, uint32_t value)
+{
+    prefix p;
+    uint32_t i;
+
+    if ((prefix_len > addr_len_ * 8) || (value == 0) || (value & IP_LPM_NODE)) {
+        return -1;
+    }
+
+    //
+    // the host bits are cleared, the prefix then starts its range
+    memset(p.addr, 0, sizeof(p.addr));
+    for (i = 0; i < addr_len_; i ++) {
+        if (prefix_len >= (i + 1) * 8) {
+            p.addr[i] = addr[i];
+        } else if (prefix_len > i * 8) {
+            p.addr[i] = addr[i] & (0xFF << (8 - (prefix_len - i * 8)));
+        }
+    }
+    p.len = prefix_len;
+    p.value = value;
+
+    prefixes_.push_back(p);
+
+    return 0;
+}
+
+void ip_lpm::build()
+{
+    uint32_t root_bits = root_bytes_ * 8;
+    prefix_it mid;
+    prefix_it it;
+    prefix_it next;
+    uint32_t idx;
+
+    root_.clear();
+    nodes_.clear();
+    vals_.clear();
+
+    if (prefixes_.empty()) {
+        return;
+    }
+
+    //
+    // the prefixes that end in the flat table go in shortest first, a
+    // longer one then overwrites the part of the range it covers. The
+    // longer prefixes follow in address order, so the prefixes under one
+    // entry are next to each other. The sorts are stable, of a prefix
+    // added twice the last one wins.
+    mid = std::stable_partition(prefixes_.begin(), prefixes_.end(),
+                                [root_bits](const prefix &p) {
+                                    return p.len <= root_bits;
+                                });
+    std::stable_sort(prefixes_.begin(), mid,
+                     [](const prefix &a, const prefix &b) {
+                        return a.len < b.len;
+                     });
+    std::stable_sort(mid, prefixes_.end(),
+                     [this](const prefix &a, const prefix &b) {
+                        int cmp = memcmp(a.addr, b.addr, addr_len_);
+
+                        return (cmp < 0) || ((cmp == 0) && (a.len < b.len));
+                     });
+
+    root_.resize(1U << root_bits, 0);
+    for (it = prefixes_.begin(); it != mid; it ++) {
+        idx = root_index(it->addr);
+        std::fill(root_.begin() + idx,
+                  root_.begin() + idx + (1ULL << (root_bits - it->len)),
+                  it->value);
+    }
+
+    for (it = mid; it != prefixes_.end(); it = next) {
+        idx = root_index(it->addr);
+        for (next = it; (next != prefixes_.end()) && (root_index(next->addr) == idx); next ++) { }
+
+        root_[idx] = IP_LPM_NODE | build_node(it, next, root_bytes_, root_[idx]);
+    }
+
+    vals_.shrink_to_fit();
+    prefixes_.clear();
+    prefixes_.shrink_to_fit();
+}
+
+//
+// build the node of the prefixes in [first, last), which share the address
+// up to byte and are longer than byte * 8 bits or end at the parent. The
+// entries start with the value of the parent entry. The child nodes are
+// built and packed first, only the 256 entries of one node per level are
+// held unpacked.
+uint32_t ip_lpm::build_node(prefix_it first, prefix_it last, uint32_t byte, uint32_t fill)
+{
+    uint32_t ent[IP_LPM_NODE_ENTRIES];
+    uint32_t depth = byte * 8;
+    std::vector<const prefix *> ends;
+    prefix_it next;
+    prefix_it it;
+    uint32_t start;
+
+    std::fill(ent, ent + IP_LPM_NODE_ENTRIES, fill);
+
+    //
+    // prefixes ending in this node, shortest first
+    for (it = first; it != last; it ++) {
+        if ((it->len > depth) && (it->len <= depth + 8)) {
+            ends.push_back(&*it);
+        }
+    }
+    std::stable_sort(ends.begin(), ends.end(),
+                     [](const prefix *a, const prefix *b) {
+                        return a->len < b->len;
+                     });
+    for (auto p : ends) {
+        start = p->addr[byte];
+        std::fill(ent + start, ent + start + (1U << (depth + 8 - p->len)), p->value);
+    }
+
+    //
+    // longer prefixes go on in a child node per entry
+    for (it = first; it != last; it = next) {
+        if (it->len <= depth + 8) {
+            next = it + 1;
+            continue;
+        }
+
+        for (next = it; (next != last) && (next->addr[byte] == it->addr[byte]); next ++) { }
+
+        ent[it->addr[byte]] = IP_LPM_NODE | build_node(it, next, byte + 1, ent[it->addr[byte]]);
+    }
+
+    return pack_node(ent);
+}
+
+uint32_t ip_lpm::pack_node(const uint32_t *ent)
+{
+    node n;
+    uint32_t i;
+    uint32_t w;
+
+    memset(&n, 0, sizeof(n));
+    n.base = vals_.size();
+
+    for (i = 0; i < IP_LPM_NODE_ENTRIES; i ++) {
+        if ((i == 0) || (ent[i] != ent[i - 1])) {
+            n.runs[i >> 6] |= 1ULL << (i & 63);
+            vals_.push_back(ent[i]);
+        }
+    }
+
+    for (w = 1; w < 4; w ++) {
+        n.before[w] = n.before[w - 1] + __builtin_popcountll(n.runs[w - 1]);
+    }
+
+    nodes_.push_back(n);
+
+    return nodes_.size() - 1;
+}
+
+void ip_lpm::clear()
+{
+    prefixes_.clear();
+    root_.clear();
+    nodes_.clear();
+    vals_.clear();
+}
+
+size_t ip_lpm::mem_bytes() const
+{
+    return root_.size() * sizeof(uint32_t) +
+           nodes_.size() * sizeof(node) +
+           vals_.size() * sizeof(uint32_t);
+}
+
+}
@@ -0,0 +1,207 @@
+/**
+ * @brief - Implements longest prefix match of ip addresses.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_LIB_COMMON_IP_LPM_H__
+#define __FW_LIB_COMMON_IP_LPM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace firewall {
+
+#define IP_LPM_V4_ADDR_LEN 4
+#define IP_LPM_V6_ADDR_LEN 16
+
+/**
+ * @brief - parse an ip prefix, "10.0.0.0/8", "2001:db8::/32" or a bare
+ *          address that is taken as a host prefix.
+ *
+ * @param [in] str - prefix string
+ * @param [out] addr_len - IP_LPM_V4_ADDR_LEN or IP_LPM_V6_ADDR_LEN
+ * @param [out] addr - address in network byte order, IP_LPM_V6_ADDR_LEN bytes
+ * @param [out] prefix_len - prefix length in bits
+ *
+ * @return 0 on success, -1 if the prefix is malformed.
+*/
+int ip_prefix_parse(const std::string &str,
+                    uint32_t &addr_len,
+                    uint8_t *addr,
+                    uint32_t &prefix_len);
+
+/**
+ * @brief - longest prefix match table of one address family.
+ *
+ * The first 24 bits of an ipv4 address, or 16 bits of an ipv6 address,
+ * index a flat table as in DIR-24-8. Longer prefixes continue in nodes of
+ * 8 bits each. A node keeps its 256 entries as runs, in the manner of
+ * Poptrie: a 256 bit map has a bit set where an entry differs from the
+ * one before it and only the first entry of each run is stored, so a node
+ * that holds one /28 takes 3 entries and not 256. An entry in a node is
+ * found with a popcount of the map up to its bit.
+ *
+ * A lookup takes one load of the flat table and two loads per node it
+ * walks, at most 3 loads for ipv4 and 29 for ipv6.
+ *
+ * Prefixes are collected with add() and the table is made with build(),
+ * afterwards it is read only and shared by all the parsers without locks.
+ * The flat table is allocated in full once a prefix is added, 64 MB for
+ * ipv4 and 256 KB for ipv6. The nodes are built one at a time in address
+ * order and packed as soon as their prefixes are in, so the build takes
+ * little more than the prefixes and the final table.
+*/
+class ip_lpm {
+    public:
+        /**
+         * @brief - create an empty table.
+         *
+         * @param [in] addr_len - IP_LPM_V4_ADDR_LEN or IP_LPM_V6_ADDR_LEN
+        */
+        explicit ip_lpm(uint32_t addr_len) :
+                        addr_len_(addr_len),
+                        root_bytes_(addr_len == IP_LPM_V4_ADDR_LEN ? 3 : 2)
+        { }
+        ~ip_lpm() { }
+
+        /**
+         * @brief - add a prefix, if a prefix is added twice the last value
+         *          is kept.
+         *
+         * @param [in] addr - address in network byte order
+         * @param [in] prefix_len - prefix length in bits
+         * @param [in] value - value returned on a match, 1 to 0x7FFFFFFF
+         *
+         * @return 0 on success, -1 if the length or the value is invalid.
+        */
+        int add(const uint8_t *addr, uint32_t prefix_len, uint32_t value);
+
+        /**
+         * @brief - make the table of the added prefixes.
+        */
+        void build();
+
+        void clear();
+
+        bool empty() const { return root_.empty(); }
+
+        /**
+         * @brief - memory taken by the table.
+        */
+        size_t mem_bytes() const;
+
+        /**
+         * @brief - find the longest prefix of an address.
+         *
+         * @param [in] addr - address in network byte order
+         *
+         * @return value of the prefix, 0 if no prefix matches.
+        */
+        inline uint32_t lookup(const uint8_t *addr) const
+        {
+            uint32_t idx = 0;
+            uint32_t e;
+            uint32_t i;
+
+            if (root_.empty()) {
+                return 0;
+            }
+
+            for (i = 0; i < root_bytes_; i ++) {
+                idx = (idx << 8) | addr[i];
+            }
+
+            e = root_[idx];
+            for (; (e & IP_LPM_NODE) && (i < addr_len_); i ++) {
+                e = node_entry(e, addr[i]);
+            }
+
+            return e;
+        }
+
+        /**
+         * @brief - find the longest prefix of an ipv4 address.
+         *
+         * @param [in] addr - address in host byte order
+         *
+         * @return value of the prefix, 0 if no prefix matches.
+        */
+        inline uint32_t lookup_v4(uint32_t addr) const
+        {
+            uint32_t e;
+
+            if (root_.empty()) {
+                return 0;
+            }
+
+            e = root_[addr >> 8];
+            if (e & IP_LPM_NODE) {
+                e = node_entry(e, addr & 0xFF);
+            }
+
+            return e;
+        }
+
+    private:
+        //
+        // entry points to a node, the low bits are the node index
+        static constexpr uint32_t IP_LPM_NODE = 0x80000000;
+        static constexpr uint32_t IP_LPM_NODE_ENTRIES = 256;
+
+        struct prefix {
+            uint8_t addr[IP_LPM_V6_ADDR_LEN];
+            uint32_t len;
+            uint32_t value;
+        };
+
+        struct node {
+            // bit i is set if entry i starts a run
+            uint64_t runs[4];
+            // bits set in the words before
+            uint8_t before[4];
+            // first run of the node in vals_
+            uint32_t base;
+        };
+
+        inline uint32_t node_entry(uint32_t e, uint8_t b) const
+        {
+            const node &n = nodes_[e & ~IP_LPM_NODE];
+            uint32_t rank;
+
+            rank = n.before[b >> 6] +
+                   __builtin_popcountll(n.runs[b >> 6] & (~0ULL >> (63 - (b & 63))));
+
+            return vals_[n.base + rank - 1];
+        }
+
+        typedef std::vector<prefix>::iterator prefix_it;
+
+        uint32_t root_index(const uint8_t *addr) const
+        {
+            uint32_t idx = 0;
+            uint32_t i;
+
+            for (i = 0; i < root_bytes_; i ++) {
+                idx = (idx << 8) | addr[i];
+            }
+
+            return idx;
+        }
+
+        uint32_t build_node(prefix_it first, prefix_it last, uint32_t byte, uint32_t fill);
+        uint32_t pack_node(const uint32_t *ent);
+
+        uint32_t addr_len_;
+        // bytes of the address that index root_
+        uint32_t root_bytes_;
+        std::vector<prefix> prefixes_;
+        std::vector<uint32_t> root_;
+        std::vector<node> nodes_;
+        std::vector<uint32_t> vals_;
+};
+
+}
+
+#endif
@@ -1,3 +1,6 @@
+#include <ifaddrs.h>
+#include <netinet/in.h>
+#include <string.h>
 #include <nw_ioctl.h>
 
 namespace firewall {
@@ -8,5 +11,36 @@ int nw_ioctl_get_broadcast_addr(const char *ifname,
     return -1;
 }
 
+int nw_ioctl_has_ip_addr(const char *ifname)
+{
+    struct ifaddrs *addrs;
+    struct ifaddrs *it;
+    struct sockaddr_in6 *in6;
+    int found = 0;
+
+    if (getifaddrs(&addrs) < 0) {
+        return -1;
+    }
+
+    for (it = addrs; it != nullptr; it = it->ifa_next) {
+        if ((it->ifa_addr == nullptr) || (strcmp(it->ifa_name, ifname) != 0)) {
+            continue;
+        }
+
+        if (it->ifa_addr->sa_family == AF_INET) {
+            found = 1;
+        } else if (it->ifa_addr->sa_family == AF_INET6) {
+            in6 = (struct sockaddr_in6 *)it->ifa_addr;
+            if (!IN6_IS_ADDR_LINKLOCAL(&in6->sin6_addr)) {
+                found = 1;
+            }
+        }
+    }
+
+    freeifaddrs(addrs);
+
+    return found;
+}
+
 }
 
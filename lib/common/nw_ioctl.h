@@ -8,6 +8,16 @@ namespace firewall {
 int nw_ioctl_get_broadcast_addr(const char *ifname,
                                 uint32_t *addr);
 
+/**
+ * @brief - check if the interface has an ipv4 or a non link local ipv6
+ *          address, that is if the host stack uses it.
+ *
+ * @param [in] ifname - interface name
+ *
+ * @return 1 if it has an address, 0 if not, -1 on failure.
+*/
+int nw_ioctl_has_ip_addr(const char *ifname);
+
 }
 
 #endif
@@ -0,0 +1,138 @@
+/**
+ * @brief - Implements lock-free single producer single consumer ring.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_SPSC_RING_H__
+#define __FW_SPSC_RING_H__
+
+#include <cstdint>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace firewall {
+
+#define FW_CACHE_LINE_SIZE 64
+
+/**
+ * @brief - implements a bounded single producer single consumer ring.
+ *
+ * Exactly one thread may push and exactly one thread may pop. The producer
+ * and consumer indices are kept on separate cache lines, each side caches
+ * the index of the other side and re-reads it only when the ring looks
+ * full or empty.
+*/
+template <typename T>
+class spsc_ring {
+    public:
+        /**
+         * @brief - create ring.
+         *
+         * @param [in] size - number of slots, rounded up to power of 2.
+        */
+        explicit spsc_ring(uint32_t size) :
+                        head_(0),
+                        cached_tail_(0),
+                        tail_(0),
+                        cached_head_(0)
+        {
+            uint32_t cap = 1;
+
+            while (cap < size) {
+                cap <<= 1;
+            }
+
+            slots_.resize(cap);
+            mask_ = cap - 1;
+        }
+        ~spsc_ring() { }
+
+        spsc_ring(const spsc_ring &) = delete;
+        spsc_ring &operator=(const spsc_ring &) = delete;
+
+        /**
+         * @brief - push an item, called by the producer.
+         *
+         * @return true if pushed, false if the ring is full.
+        */
+        inline bool push(const T &item) noexcept
+        {
+            T copy = item;
+
+            return push(std::move(copy));
+        }
+
+        inline bool push(T &&item) noexcept
+        {
+            uint32_t tail = tail_.load(std::memory_order_relaxed);
+
+            if (tail - cached_head_ == capacity()) {
+                cached_head_ = head_.load(std::memory_order_acquire);
+                if (tail - cached_head_ == capacity()) {
+                    return false;
+                }
+            }
+
+            slots_[tail & mask_] = std::move(item);
+            tail_.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * @brief - pop an item, called by the consumer.
+         *
+         * @return true if popped, false if the ring is empty.
+        */
+        inline bool pop(T &item) noexcept
+        {
+            uint32_t head = head_.load(std::memory_order_relaxed);
+
+            if (head == cached_tail_) {
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if (head == cached_tail_) {
+                    return false;
+                }
+            }
+
+            //
+            // move out so that the slot does not keep a reference to the item
+            item = std::move(slots_[head & mask_]);
+            head_.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        inline bool empty() const noexcept
+        {
+            return head_.load(std::memory_order_acquire) ==
+                   tail_.load(std::memory_order_acquire);
+        }
+
+        inline uint32_t count() const noexcept
+        {
+            return tail_.load(std::memory_order_acquire) -
+                   head_.load(std::memory_order_acquire);
+        }
+
+        inline uint32_t capacity() const noexcept { return mask_ + 1; }
+
+    private:
+        //
+        // consumer side
+        alignas(FW_CACHE_LINE_SIZE) std::atomic<uint32_t> head_;
+        uint32_t cached_tail_;
+        //
+        // producer side
+        alignas(FW_CACHE_LINE_SIZE) std::atomic<uint32_t> tail_;
+        uint32_t cached_head_;
+        //
+        // read only after construction
+        alignas(FW_CACHE_LINE_SIZE) std::vector<T> slots_;
+        uint32_t mask_;
+};
+
+}
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * @brief - Implements spin then sleep wait strategy of the pipeline threads.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_LIB_COMMON_WAIT_STRATEGY_H__
+#define __FW_LIB_COMMON_WAIT_STRATEGY_H__
+
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+
+namespace firewall {
+
+/**
+ * @brief - how an idle thread waits for the next frame.
+*/
+enum class Wait_Mode {
+    // sleep right away, lowest cpu use
+    Sleep,
+    // spin up to the spin budget, then sleep
+    Adaptive,
+    // never sleep, for threads on dedicated cores
+    Spin,
+};
+
+//
+// clock is read once every these many spins
+#define WAIT_STRATEGY_CLOCK_SPINS 64
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief - spins on a condition before the caller goes to sleep.
+ *
+ * In the adaptive mode the spin window starts at the spin budget. It is
+ * halved when a spin runs out without work, and doubled back up to the
+ * budget when work shows up within the window or soon after going to
+ * sleep. A bursty feed keeps spinning across its gaps, an idle feed
+ * quickly stops burning the cpu.
+*/
+class wait_strategy {
+    public:
+        explicit wait_strategy(Wait_Mode mode = Wait_Mode::Sleep, uint32_t spin_us = 0) :
+                        mode_(mode),
+                        max_ns_((uint64_t)spin_us * 1000),
+                        window_ns_((uint64_t)spin_us * 1000)
+        { }
+
+        Wait_Mode mode() const { return mode_; }
+
+        /**
+         * @brief - spin until the condition holds or the window is used up.
+         *
+         * @param [in] ready - condition, may have side effects such as
+         *                     receiving a frame.
+         *
+         * @return true if the condition holds, false if the caller should sleep.
+        */
+        template <typename Ready>
+        bool spin(Ready ready)
+        {
+            struct timespec start;
+            uint64_t elapsed;
+            uint32_t n = 0;
+
+            if (mode_ == Wait_Mode::Sleep) {
+                return false;
+            }
+
+            if (mode_ == Wait_Mode::Spin) {
+                while (!ready()) {
+                    cpu_relax();
+                }
+                return true;
+            }
+
+            if (window_ns_ == 0) {
+                return false;
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+
+            while (1) {
+                if (ready()) {
+                    window_ns_ = std::min(window_ns_ * 2, max_ns_);
+                    return true;
+                }
+
+                cpu_relax();
+
+                if (++ n % WAIT_STRATEGY_CLOCK_SPINS) {
+                    continue;
+                }
+
+                elapsed = elapsed_ns(start);
+                if (elapsed >= window_ns_) {
+                    break;
+                }
+            }
+
+            window_ns_ /= 2;
+            return false;
+        }
+
+        /**
+         * @brief - report the time spent asleep before work showed up.
+         *
+         * A short sleep would have been caught by a longer spin, so the
+         * window grows back.
+        */
+        void slept(uint64_t sleep_ns)
+        {
+            if ((mode_ == Wait_Mode::Adaptive) && (sleep_ns < max_ns_)) {
+                window_ns_ = std::max<uint64_t>(std::min(window_ns_ * 2, max_ns_), 1000);
+            }
+        }
+
+        static uint64_t elapsed_ns(const struct timespec &start)
+        {
+            struct timespec now;
+
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            return (uint64_t)(now.tv_sec - start.tv_sec) * 1000000000ULL +
+                   now.tv_nsec - start.tv_nsec;
+        }
+
+    private:
+        Wait_Mode mode_;
+        uint64_t max_ns_;
+        uint64_t window_ns_;
+};
+
+}
+
+#endif
@@ -3,19 +3,77 @@
  * 
  * @copyright - 2023-present All rights reserved. Devendra Naga.
 */
+#include <algorithm>
 #include <packet.h>
 
 namespace firewall {
 
-packet::packet()
+packet::packet() : storage_(new uint8_t[PACKET_BUF_SIZE]()),
+                   storage_size_(PACKET_BUF_SIZE)
 {
-    std::memset(buf, 0, sizeof(buf));
+    buf = storage_.get();
     buf_len = 0;
+    buf_size = storage_size_;
     off = 0;
+    rx_flags = 0;
+    vlan_tci = 0;
+    vlan_tpid = 0;
+    rx_ts.tv_sec = 0;
+    rx_ts.tv_nsec = 0;
+    sample_rate = 1;
 }
 
-packet::packet(uint32_t pkt_len) : buf_len(pkt_len), off(0)
+packet::packet(uint32_t pkt_len) : buf_len(pkt_len), buf_size(pkt_len), off(0),
+                                   rx_flags(0), vlan_tci(0), vlan_tpid(0),
+                                   rx_ts(), sample_rate(1),
+                                   storage_(new uint8_t[pkt_len]()),
+                                   storage_size_(pkt_len)
 {
+    buf = storage_.get();
+}
+
+packet::packet(uint8_t *data, uint32_t data_len) :
+                        buf(data), buf_len(data_len), buf_size(data_len), off(0),
+                        rx_flags(0), vlan_tci(0), vlan_tpid(0),
+                        rx_ts(), sample_rate(1),
+                        storage_(nullptr),
+                        storage_size_(0)
+{
+}
+
+packet::packet(const packet &pkt) : buf(nullptr), buf_len(0), buf_size(0),
+                                    storage_(nullptr), storage_size_(0)
+{
+    *this = pkt;
+}
+
+packet &packet::operator=(const packet &pkt)
+{
+    if (this == &pkt) {
+        return *this;
+    }
+
+    //
+    // copies always own the data, a view is only valid in the receive path.
+    if (storage_size_ < pkt.buf_len) {
+        storage_.reset(new uint8_t[pkt.buf_len]);
+        storage_size_ = pkt.buf_len;
+    }
+
+    buf = storage_.get();
+    buf_len = pkt.buf_len;
+    buf_size = storage_size_;
+    off = pkt.off;
+    rx_flags = pkt.rx_flags;
+    vlan_tci = pkt.vlan_tci;
+    vlan_tpid = pkt.vlan_tpid;
+    rx_ts = pkt.rx_ts;
+    sample_rate = pkt.sample_rate;
+    if (buf_len > 0) {
+        std::memcpy(buf, pkt.buf, buf_len);
+    }
+
+    return *this;
 }
 
 packet::~packet()
@@ -10,19 +10,81 @@
 #include <cstring>
 #include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 #include <vector>
+#include <memory>
 #include <common.h>
 
 namespace firewall {
 
+//
+// size of the storage of a packet created with no length
+#define PACKET_BUF_SIZE 4096
+
+/**
+ * @brief - receive metadata of the frame reported by the kernel.
+ */
+enum class Packet_Rx_Flag : uint32_t {
+    // checksum offloaded to the NIC and not yet computed,
+    // seen on the locally sent frames
+    Csum_Not_Ready = 0x0001,
+    // l4 checksum is verified by the NIC or the kernel
+    Csum_Valid = 0x0002,
+    // vlan tag is stripped by the NIC into vlan_tci and vlan_tpid
+    Vlan = 0x0004,
+};
+
 struct packet {
-    uint8_t buf[4096];
+    //
+    // points to the storage owned by the packet, or to an externally
+    // owned frame if the packet is a view (pool slab, UMEM frame).
+    uint8_t *buf;
     uint32_t buf_len;
+    // capacity of buf
+    uint32_t buf_size;
     uint32_t off;
 
+    //
+    // receive metadata, bitmask of Packet_Rx_Flag
+    uint32_t rx_flags;
+    uint16_t vlan_tci;
+    uint16_t vlan_tpid;
+
+    //
+    // receive timestamp (CLOCK_REALTIME), from the kernel or the NIC
+    // if available, else taken by the receive thread.
+    struct timespec rx_ts;
+
+    //
+    // 1 in sample_rate flows is inspected when the frame is received
+    uint32_t sample_rate;
+
+    inline bool has_rx_flag(Packet_Rx_Flag f) const
+    {
+        return !!(rx_flags & static_cast<uint32_t>(f));
+    }
+
+    inline void set_rx_flag(Packet_Rx_Flag f)
+    {
+        rx_flags |= static_cast<uint32_t>(f);
+    }
+
     explicit packet();
     explicit packet(uint32_t pkt_len);
+    /**
+     * @brief - create a view over an externally owned frame.
+     *
+     * No copy is made, the frame must stay valid while the packet is in use.
+     * Copying a view copies the frame into storage owned by the copy.
+     *
+     * @param [in] data - frame data
+     * @param [in] data_len - frame length
+     */
+    explicit packet(uint8_t *data, uint32_t data_len);
+    packet(const packet &pkt);
+    packet &operator=(const packet &pkt);
     int remaining_len() { return buf_len - off; }
+    bool is_view() const { return buf != storage_.get(); }
     ~packet();
 
     fw_error_type serialize(uint8_t byte);
@@ -48,6 +110,10 @@ struct packet {
         }
         printf("\n");
     }
+
+    private:
+        std::unique_ptr<uint8_t[]> storage_;
+        uint32_t storage_size_;
 };
 
 }
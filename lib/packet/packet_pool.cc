@@ -0,0 +1,193 @@
+/**
+ * @brief - Implements preallocated pool of refcounted packets.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <packet_pool.h>
+
+namespace firewall {
+
+//
+// hugepages are allocated in multiples of the default 2M hugepage
+#define PACKET_POOL_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+//
+// buffers start on a cache line
+#define PACKET_POOL_BUF_ALIGN 64
+
+packet_pool::packet_pool(const std::vector<packet_pool_size_class> &classes,
+                         bool hugepages) :
+                            n_classes_(0),
+                            count_(0),
+                            hugepages_(hugepages),
+                            n_alloc_(0),
+                            n_put_(0)
+{
+    uint32_t i;
+
+    if (classes.empty() || (classes.size() > PACKET_POOL_MAX_CLASSES)) {
+        throw std::runtime_error("invalid number of packet pool size classes");
+    }
+
+    for (i = 0; i < classes.size(); i ++) {
+        if ((classes[i].count == 0) || (classes[i].buf_size == 0) ||
+            ((i > 0) && (classes[i].buf_size <= classes[i - 1].buf_size))) {
+            throw std::runtime_error("invalid packet pool size class");
+        }
+    }
+
+    for (i = 0; i < classes.size(); i ++) {
+        size_class &c = classes_[i];
+
+        c.buf_size = classes[i].buf_size;
+        c.count = classes[i].count;
+
+        //
+        // destructor does not run for a throwing constructor, free
+        // the classes set up so far.
+        try {
+            init_class(c, hugepages);
+        } catch (...) {
+            release();
+            throw;
+        }
+
+        n_classes_ ++;
+        count_ += c.count;
+    }
+}
+
+void packet_pool::init_class(size_class &c, bool hugepages)
+{
+    void *mem = MAP_FAILED;
+    size_t hdr_len;
+    size_t buf_size;
+    uint8_t *bufs;
+    uint32_t i;
+
+    //
+    // pool_packet headers first, the buffers of the class follow.
+    hdr_len = ((size_t)c.count * sizeof(pool_packet) + PACKET_POOL_BUF_ALIGN - 1) &
+                            ~((size_t)PACKET_POOL_BUF_ALIGN - 1);
+    buf_size = ((size_t)c.buf_size + PACKET_POOL_BUF_ALIGN - 1) &
+                            ~((size_t)PACKET_POOL_BUF_ALIGN - 1);
+    c.map_len = hdr_len + (size_t)c.count * buf_size;
+
+    if (hugepages) {
+        size_t huge_len;
+
+        huge_len = (c.map_len + PACKET_POOL_HUGEPAGE_SIZE - 1) &
+                            ~((size_t)PACKET_POOL_HUGEPAGE_SIZE - 1);
+        mem = mmap(nullptr, huge_len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (mem != MAP_FAILED) {
+            c.map_len = huge_len;
+        }
+    }
+
+    if (mem == MAP_FAILED) {
+        hugepages_ = false;
+        mem = mmap(nullptr, c.map_len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (mem == MAP_FAILED) {
+            throw std::runtime_error("failed to allocate packet pool");
+        }
+    }
+
+    c.mem = mem;
+    c.pkts = (pool_packet *)mem;
+    bufs = (uint8_t *)mem + hdr_len;
+
+    for (i = 0; i < c.count; i ++) {
+        pool_packet *p = new (&c.pkts[i]) pool_packet(this, &c - classes_,
+                                                      bufs + (size_t)i * buf_size,
+                                                      c.buf_size);
+
+        p->next = (i + 1 < c.count) ? &c.pkts[i + 1] : nullptr;
+    }
+
+    c.free_list.store(&c.pkts[0], std::memory_order_release);
+}
+
+packet_pool::~packet_pool()
+{
+    release();
+}
+
+void packet_pool::release() noexcept
+{
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < n_classes_; i ++) {
+        size_class &c = classes_[i];
+
+        for (j = 0; j < c.count; j ++) {
+            c.pkts[j].~pool_packet();
+        }
+
+        munmap(c.mem, c.map_len);
+    }
+
+    n_classes_ = 0;
+}
+
+//
+// only one thread allocates, so the head can not be popped and pushed back
+// under us between the load and the compare exchange (no ABA).
+packet_ref packet_pool::alloc(uint32_t len) noexcept
+{
+    pool_packet *head = nullptr;
+    uint32_t i;
+
+    for (i = 0; i < n_classes_; i ++) {
+        size_class &c = classes_[i];
+
+        if (c.buf_size < len) {
+            continue;
+        }
+
+        head = c.free_list.load(std::memory_order_acquire);
+        while (head && !c.free_list.compare_exchange_weak(head, head->next,
+                                                          std::memory_order_acquire,
+                                                          std::memory_order_acquire)) {
+        }
+
+        if (head != nullptr) {
+            break;
+        }
+    }
+
+    if (head == nullptr) {
+        return packet_ref();
+    }
+
+    n_alloc_.store(n_alloc_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    head->refcnt.store(1, std::memory_order_relaxed);
+    head->pkt.buf_len = 0;
+    head->pkt.off = 0;
+    head->pkt.rx_flags = 0;
+    head->pkt.sample_rate = 1;
+
+    return packet_ref(head);
+}
+
+void packet_pool::put(pool_packet *p) noexcept
+{
+    size_class &c = classes_[p->cls];
+    pool_packet *head = c.free_list.load(std::memory_order_relaxed);
+
+    do {
+        p->next = head;
+    } while (!c.free_list.compare_exchange_weak(head, p,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+
+    n_put_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,190 @@
+/**
+ * @brief - Implements preallocated pool of refcounted packets.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+ */
+#ifndef __FW_PACKET_POOL_H__
+#define __FW_PACKET_POOL_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <vector>
+#include <packet.h>
+
+namespace firewall {
+
+class packet_pool;
+
+//
+// maximum number of buffer size classes of a pool
+#define PACKET_POOL_MAX_CLASSES 4
+
+/**
+ * @brief - Defines a buffer size class of the pool.
+ */
+struct packet_pool_size_class {
+    // size of each packet buffer in the class
+    uint32_t buf_size;
+    // number of packets in the class
+    uint32_t count;
+};
+
+/**
+ * @brief - Defines a packet owned by the pool.
+ */
+struct pool_packet {
+    packet pkt;
+    std::atomic<uint32_t> refcnt;
+    pool_packet *next;
+    packet_pool *pool;
+    // size class the buffer belongs to
+    uint32_t cls;
+
+    explicit pool_packet(packet_pool *owner, uint32_t size_class,
+                         uint8_t *buf, uint32_t buf_size) :
+                    pkt(buf, buf_size),
+                    refcnt(0),
+                    next(nullptr),
+                    pool(owner),
+                    cls(size_class)
+    { }
+};
+
+/**
+ * @brief - Implements a refcounted handle to a pool packet.
+ *
+ * Copying the handle takes a reference, the packet goes back to the pool
+ * when the last handle is released. Handles can be released from any thread.
+ */
+class packet_ref {
+    public:
+        packet_ref() : p_(nullptr) { }
+        // takes over the reference held by the caller
+        explicit packet_ref(pool_packet *p) : p_(p) { }
+        packet_ref(const packet_ref &ref) : p_(ref.p_)
+        {
+            if (p_) {
+                p_->refcnt.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        packet_ref(packet_ref &&ref) noexcept : p_(ref.p_) { ref.p_ = nullptr; }
+        packet_ref &operator=(const packet_ref &ref)
+        {
+            packet_ref copy(ref);
+
+            std::swap(p_, copy.p_);
+            return *this;
+        }
+        packet_ref &operator=(packet_ref &&ref) noexcept
+        {
+            if (this != &ref) {
+                reset();
+                p_ = ref.p_;
+                ref.p_ = nullptr;
+            }
+            return *this;
+        }
+        ~packet_ref() { reset(); }
+
+        inline void reset() noexcept;
+
+        packet *get() const noexcept { return &p_->pkt; }
+        packet &operator*() const noexcept { return p_->pkt; }
+        packet *operator->() const noexcept { return &p_->pkt; }
+        explicit operator bool() const noexcept { return p_ != nullptr; }
+
+    private:
+        pool_packet *p_;
+};
+
+/**
+ * @brief - Implements preallocated pool of packets.
+ *
+ * All the packets are allocated at init, optionally on hugepages, so that
+ * there is no allocation in the packet path. The buffers are carved out of
+ * one slab per size class, so the small frames are packed densely and the
+ * jumbo and GRO frames are still kept whole. Packets are allocated by a
+ * single thread and can be freed by any thread.
+ */
+class packet_pool {
+    public:
+        /**
+         * @brief - Create packet pool.
+         *
+         * @param [in] classes - buffer size classes, in increasing buffer size.
+         * @param [in] hugepages - back the pool with hugepages, falls back to
+         *                         regular pages if no hugepages are available.
+         *
+         * This constructor will throw exception.
+         */
+        explicit packet_pool(const std::vector<packet_pool_size_class> &classes,
+                             bool hugepages);
+        ~packet_pool();
+
+        packet_pool(const packet_pool &) = delete;
+        packet_pool &operator=(const packet_pool &) = delete;
+
+        /**
+         * @brief - Allocate a packet, must be called by a single thread.
+         *
+         * The packet comes from the smallest class that holds len bytes,
+         * or from a larger class if that one is exhausted.
+         *
+         * @param [in] len - bytes the packet must hold.
+         *
+         * @return packet handle on success.
+         * @return empty handle if no class holding len bytes has a free packet.
+         */
+        packet_ref alloc(uint32_t len = 0) noexcept;
+
+        // total number of packets of all classes
+        uint32_t count() const noexcept { return count_; }
+        // packets allocated and not yet freed, a snapshot
+        uint32_t in_use() const noexcept
+        {
+            return n_alloc_.load(std::memory_order_relaxed) -
+                   n_put_.load(std::memory_order_relaxed);
+        }
+        // buffer size of the largest class
+        uint32_t max_buf_size() const noexcept { return classes_[n_classes_ - 1].buf_size; }
+        bool is_hugepage_backed() const noexcept { return hugepages_; }
+
+    private:
+        friend class packet_ref;
+        void put(pool_packet *p) noexcept;
+
+        struct size_class {
+            uint32_t buf_size;
+            uint32_t count;
+            pool_packet *pkts;
+            void *mem;
+            size_t map_len;
+            std::atomic<pool_packet *> free_list;
+        };
+
+        void init_class(size_class &c, bool hugepages);
+        void release() noexcept;
+
+        size_class classes_[PACKET_POOL_MAX_CLASSES];
+        uint32_t n_classes_;
+        uint32_t count_;
+        bool hugepages_;
+        //
+        // written only by the allocating thread, and by the freeing
+        // threads. Kept apart so the two sides do not share a line.
+        alignas(64) std::atomic<uint32_t> n_alloc_;
+        alignas(64) std::atomic<uint32_t> n_put_;
+};
+
+inline void packet_ref::reset() noexcept
+{
+    if (p_ && (p_->refcnt.fetch_sub(1, std::memory_order_acq_rel) == 1)) {
+        p_->pool->put(p_);
+    }
+    p_ = nullptr;
+}
+
+}
+
+#endif
@@ -7,7 +7,6 @@
 #include <iostream>
 #include <cstring>
 #include <time.h>
-#include <sys/time.h>
 #include <pcap_intf.h>
 
 namespace firewall {
@@ -34,16 +33,20 @@ pcap_writer::~pcap_writer()
     }
 }
 
-pcaprec_hdr_t pcap_writer::format_pcap_pkthdr(size_t pktsize)
+pcaprec_hdr_t pcap_writer::format_pcap_pkthdr(size_t pktsize,
+                                              const struct timespec *ts)
 {
     pcaprec_hdr_t rec_hdr;
-    struct timeval tv;
+    struct timespec tp;
 
     std::memset(&rec_hdr, 0, sizeof(rec_hdr));
-    gettimeofday(&tv, 0);
+    if (ts == nullptr) {
+        clock_gettime(CLOCK_REALTIME, &tp);
+        ts = &tp;
+    }
 
-    rec_hdr.ts_sec = tv.tv_sec;
-    rec_hdr.ts_usec = tv.tv_usec;
+    rec_hdr.ts_sec = ts->tv_sec;
+    rec_hdr.ts_usec = ts->tv_nsec / 1000u;
     rec_hdr.incl_len = pktsize;
     rec_hdr.orig_len = pktsize;
 
@@ -69,25 +72,22 @@ int pcap_writer::write_packet(pcaprec_hdr_t *rec, uint8_t *buf)
 
 int pcap_writer::write_packet(uint8_t *buf, uint32_t buf_len)
 {
-    pcaprec_hdr_t rec_hdr;
     struct timespec tp;
-    int ret;
 
-    std::memset(&rec_hdr, 0, sizeof(rec_hdr));
     clock_gettime(CLOCK_REALTIME, &tp);
 
-    rec_hdr.ts_sec = tp.tv_sec;
-    rec_hdr.ts_usec = tp.tv_nsec / 1000u;
-    rec_hdr.incl_len = buf_len;
-    rec_hdr.orig_len = buf_len;
+    return write_packet(buf, buf_len, tp);
+}
 
-    ret = fwrite(&rec_hdr, sizeof(rec_hdr), 1, fp);
-    if (ret != 1) {
-        return -1;
-    }
+int pcap_writer::write_packet(uint8_t *buf, uint32_t buf_len, const struct timespec &ts)
+{
+    pcaprec_hdr_t rec_hdr;
+    int ret;
 
-    ret = fwrite(buf, rec_hdr.incl_len, 1, fp);
-    if (ret != 1) {
+    rec_hdr = format_pcap_pkthdr(buf_len, &ts);
+
+    ret = write_packet(&rec_hdr, buf);
+    if (ret < 0) {
         return -1;
     }
 
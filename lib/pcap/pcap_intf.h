@@ -8,6 +8,7 @@
 
 #include <cstdint>
 #include <string>
+#include <time.h>
 #include <pcap_intf.h>
 #include <lang_hints.h>
 
@@ -43,7 +44,16 @@ class pcap_writer {
         pcap_writer(const std::string &filename) THROWS;
         ~pcap_writer();
 
-        pcaprec_hdr_t format_pcap_pkthdr(size_t pktsize);
+        /**
+         * @brief - format pcap record header.
+         *
+         * @param [in] pktsize - packet length
+         * @param [in] ts - receive timestamp, current time if null
+         *
+         * @return record header.
+         */
+        pcaprec_hdr_t format_pcap_pkthdr(size_t pktsize,
+                                         const struct timespec *ts = nullptr);
         int write_packet(pcaprec_hdr_t *rec, uint8_t *buf);
         /**
          * @brief - write pcap record.
@@ -54,6 +64,16 @@ class pcap_writer {
          * @return 0 on success -1 on failure.
          */
         int write_packet(uint8_t *buf, uint32_t buf_len);
+        /**
+         * @brief - write pcap record with the receive timestamp of the packet.
+         *
+         * @param [in] buf - packet buffer
+         * @param [in] buf_len - packet length
+         * @param [in] ts - receive timestamp (CLOCK_REALTIME)
+         *
+         * @return 0 on success -1 on failure.
+         */
+        int write_packet(uint8_t *buf, uint32_t buf_len, const struct timespec &ts);
 
     private:
         FILE *fp;
@@ -114,199 +114,108 @@ event_description dhcp_opt_client_id::parse(packet &p, logger *log, bool debug)
 
 event_description dhcp_opts::deserialize(packet &p, logger *log, bool debug)
 {
-    event_description evt_desc;
+    event_description evt_desc = event_description::Evt_Parse_Ok;
+    opt_area area(p, p.remaining_len());
+    uint32_t val_off;
+    uint8_t len;
 
-    end.val = 0;
+    reset();
 
-    while (p.off < p.buf_len) {
+    while (area.has_more(p)) {
         dhcp_param_req_list byte = static_cast<dhcp_param_req_list>(p.buf[p.off]);
 
         p.off ++;
 
-        if (end.val == static_cast<uint8_t>(dhcp_param_req_list::End)) {
+        //
+        // single byte options
+        if (byte == dhcp_param_req_list::Pad) {
+            continue;
+        } else if (byte == dhcp_param_req_list::End) {
+            end.val = static_cast<uint8_t>(dhcp_param_req_list::End);
             break;
         }
 
+        //
+        // every other option is type, length and value and
+        // must fit in the frame.
+        if (!area.fits(p, 1)) {
+            return event_description::Evt_DHCP_Opt_Len_Inval;
+        }
+
+        val_off = p.off;
+        len = p.buf[p.off];
+        if (!area.fits(p, 1 + len)) {
+            return event_description::Evt_DHCP_Opt_Len_Inval;
+        }
+
         switch (byte) {
             case dhcp_param_req_list::DHCP_Msg_Type: {
-                type = std::make_shared<dhcp_opt_msg_type>();
-                if (!type) {
-                    return event_description::Evt_Unknown_Error;
-                }
-                p.deserialize(type->len);
-                p.deserialize(type->type);
+                dhcp_opt_msg_type *t = type.emplace();
+
+                p.deserialize(t->len);
+                p.deserialize(t->type);
             } break;
             case dhcp_param_req_list::Req_IPAddr: {
-                req_ipaddr = std::make_shared<dhcp_opt_req_ipaddr>();
-                if (!req_ipaddr) {
-                    return event_description::Evt_Unknown_Error;
-                }
-                p.deserialize(req_ipaddr->len);
-                p.deserialize(req_ipaddr->req_ipaddr);
+                dhcp_opt_req_ipaddr *r = req_ipaddr.emplace();
+
+                p.deserialize(r->len);
+                p.deserialize(r->req_ipaddr);
             } break;
             case dhcp_param_req_list::Host_Name: {
-                hostname = std::make_shared<dhcp_opt_hostname>();
-                if (!hostname) {
-                    return event_description::Evt_Unknown_Error;
-                }
-                p.deserialize(hostname->len);
-                hostname->hostname = (uint8_t *)calloc(1, hostname->len);
-                if (!hostname->hostname) {
-                    return event_description::Evt_Unknown_Error;
-                }
-                p.deserialize(hostname->hostname, hostname->len);
+                evt_desc = hostname.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Parameter_Req_List: {
-                req_list = std::make_shared<dhcp_opt_param_req_list>();
-                if (!req_list) {
-                    return event_description::Evt_Unknown_Error;
-                }
-                p.deserialize(req_list->len);
-                for (auto i = 0; (i < req_list->len) &&
-                                 (p.off < p.buf_len); i ++) {
-                    uint8_t byte_1;
-
-                    p.deserialize(byte_1);
-                    req_list->list.push_back(static_cast<dhcp_param_req_list>(byte_1));
-                }
-            } break;
-            case dhcp_param_req_list::End: {
-                p.deserialize(end.val);
+                evt_desc = req_list.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Client_Id: {
-                client_id = std::make_shared<dhcp_opt_client_id>();
-                if (!client_id) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = client_id->parse(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = client_id.emplace()->parse(p, log, debug);
             } break;
             case dhcp_param_req_list::Renewal_Time: {
-                renewal_time = std::make_shared<dhcp_opt_renewal_time>();
-                if (!renewal_time) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = renewal_time->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = renewal_time.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Rebinding_Time: {
-                rebind_time = std::make_shared<dhcp_opt_rebindig_time>();
-                if (!rebind_time) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = rebind_time->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = rebind_time.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Ipaddr_Lease_Time: {
-                lease_time = std::make_shared<dhcp_opt_ipaddr_lease_time>();
-                if (!lease_time) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = lease_time->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = lease_time.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::DHCP_Server_Id: {
-                dhcp_server_id = std::make_shared<dhcp_opt_dhcp_server_id>();
-                if (!dhcp_server_id) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = dhcp_server_id->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = dhcp_server_id.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Subnet_Mask: {
-                subnet_mask = std::make_shared<dhcp_opt_subnet_mask>();
-                if (!subnet_mask) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = subnet_mask->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = subnet_mask.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Domain_Name: {
-                domain_name = std::make_shared<dhcp_opt_domain_name>();
-                if (!domain_name) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = domain_name->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = domain_name.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Router: {
-                router = std::make_shared<dhcp_opt_router>();
-                if (!router) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = router->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Unknown_Error) {
-                    return evt_desc;
-                }
+                evt_desc = router.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Domain_Name_Server: {
-                dns = std::make_shared<dhcp_opt_dns>();
-                if (!dns) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = dns->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = dns.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Perform_Router_Discover: {
-                perf_rdisc = std::make_shared<dhcp_opt_perform_router_discover>();
-                if (!perf_rdisc) {
-                    return event_description::Evt_Unknown_Error;
-                }
-
-                evt_desc = perf_rdisc->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok) {
-                    return evt_desc;
-                }
+                evt_desc = perf_rdisc.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::DHCP_Auto_Config: {
-                dhcp_autoconf = std::make_shared<dhcp_opt_autoconf>();
-                if (!dhcp_autoconf)
-                    return event_description::Evt_Out_Of_Memory;
-
-                evt_desc = dhcp_autoconf->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok)
-                    return evt_desc;
+                evt_desc = dhcp_autoconf.emplace()->deserialize(p, log, debug);
             } break;
             case dhcp_param_req_list::Vendor_Class_Identifier: {
-                vendor_class_id = std::make_shared<dhcp_opt_vendor_class_identifier>();
-                if (!vendor_class_id)
-                    return event_description::Evt_Out_Of_Memory;
-
-                evt_desc = vendor_class_id->deserialize(p, log, debug);
-                if (evt_desc != event_description::Evt_Parse_Ok)
-                    return evt_desc;
-            } break;
-            case dhcp_param_req_list::Pad: {
+                evt_desc = vendor_class_id.emplace()->deserialize(p, log, debug);
             } break;
             default: {
-                evt_desc = event_description::Evt_Unknown_Error;
+                //
+                // options that we do not decode are skipped
             } break;
         }
+
+        if (evt_desc != event_description::Evt_Parse_Ok) {
+            return evt_desc;
+        }
+
+        //
+        // move to the next option
+        p.off = val_off + 1 + len;
     }
 
     return event_description::Evt_Parse_Ok;
@@ -7,14 +7,19 @@
 #define __FW_PROTOCOLS_APP_DHCP_H__
 
 #include <stdlib.h>
-#include <vector>
-#include <memory>
 #include <packet.h>
 #include <event_def.h>
 #include <logger.h>
+#include <inline_options.h>
 
 namespace firewall {
 
+//
+// option length is a single byte
+#define DHCP_OPT_VAL_MAX 255
+#define DHCP_OPT_PARAM_REQ_LIST_MAX 64
+#define DHCP_OPT_DNS_SERVERS_MAX 16
+
 enum class dhcp_param_req_list {
     Pad = 0,
     Subnet_Mask = 1,
@@ -80,16 +85,20 @@ struct dhcp_opt_req_ipaddr {
 
 struct dhcp_opt_hostname {
     uint8_t len;
-    uint8_t *hostname;
+    inline_list<uint8_t, DHCP_OPT_VAL_MAX> hostname;
 
-    explicit dhcp_opt_hostname() : len(0), hostname(nullptr)
+    explicit dhcp_opt_hostname() : len(0)
     { }
 
-    ~dhcp_opt_hostname() {
-        if (hostname) {
-            free(hostname);
-            hostname = nullptr;
-        }
+    ~dhcp_opt_hostname() { }
+
+    event_description deserialize(packet &p, logger *log, bool debug)
+    {
+        p.deserialize(len);
+        hostname.assign(p.buf + p.off, len);
+        p.off += len;
+
+        return event_description::Evt_Parse_Ok;
     }
 
     void print(logger *log)
@@ -97,8 +106,8 @@ struct dhcp_opt_hostname {
     #if defined(FW_ENABLE_DEBUG)
         log->verbose("\t\t hostname: {\n");
         log->verbose("\t\t\t len: %d\n", len);
-        if (hostname)
-            log->verbose("\t\t\t hostname: %s\n", (char *)hostname);
+        log->verbose("\t\t\t hostname: %.*s\n",
+                     (int)hostname.size(), (char *)hostname.data());
         log->verbose("\t\t }\n");
     #endif
     }
@@ -125,12 +134,27 @@ struct dhcp_opt_client_id {
     }
 
     private:
-        const int len_ = 7;
+        static constexpr int len_ = 7;
 };
 
 struct dhcp_opt_param_req_list {
     uint8_t len;
-    std::vector<dhcp_param_req_list> list;
+    inline_list<dhcp_param_req_list, DHCP_OPT_PARAM_REQ_LIST_MAX> list;
+
+    event_description deserialize(packet &p, logger *log, bool debug)
+    {
+        p.deserialize(len);
+        for (auto i = 0; i < len; i ++) {
+            uint8_t byte_1;
+
+            p.deserialize(byte_1);
+            if (!list.push_back(static_cast<dhcp_param_req_list>(byte_1))) {
+                return event_description::Evt_DHCP_Opt_List_Overflow;
+            }
+        }
+
+        return event_description::Evt_Parse_Ok;
+    }
 
     void print(logger *log)
     {
@@ -165,7 +189,7 @@ struct dhcp_opt_subnet_mask {
     uint8_t len;
     uint32_t subnet_mask;
 
-    explicit dhcp_opt_subnet_mask() { }
+    explicit dhcp_opt_subnet_mask() : len(0), subnet_mask(0) { }
     ~dhcp_opt_subnet_mask() { }
 
     event_description deserialize(packet &p, logger *log, bool debug)
@@ -190,7 +214,7 @@ struct dhcp_opt_subnet_mask {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 struct dhcp_opt_renewal_time {
@@ -219,7 +243,7 @@ struct dhcp_opt_renewal_time {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 struct dhcp_opt_rebindig_time {
@@ -248,7 +272,7 @@ struct dhcp_opt_rebindig_time {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 struct dhcp_opt_ipaddr_lease_time {
@@ -277,7 +301,7 @@ struct dhcp_opt_ipaddr_lease_time {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 struct dhcp_opt_dhcp_server_id {
@@ -306,24 +330,21 @@ struct dhcp_opt_dhcp_server_id {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 struct dhcp_opt_domain_name {
     uint8_t len;
-    uint8_t *val;
+    inline_list<uint8_t, DHCP_OPT_VAL_MAX> val;
 
-    explicit dhcp_opt_domain_name() : len(0), val(nullptr) { }
+    explicit dhcp_opt_domain_name() : len(0) { }
     ~dhcp_opt_domain_name() { }
 
     event_description deserialize(packet &p, logger *log, bool debug)
     {
         p.deserialize(len);
-        val = (uint8_t *)calloc(1, len);
-        if (!val) {
-            return event_description::Evt_Unknown_Error;
-        }
-        p.deserialize(val, len);
+        val.assign(p.buf + p.off, len);
+        p.off += len;
 
         return event_description::Evt_Parse_Ok;
     }
@@ -361,7 +382,7 @@ struct dhcp_opt_router {
 
 struct dhcp_opt_dns {
     uint8_t len;
-    std::vector<uint32_t> dns_server_list;
+    inline_list<uint32_t, DHCP_OPT_DNS_SERVERS_MAX> dns_server_list;
 
     event_description deserialize(packet &p, logger *log, bool debug)
     {
@@ -374,7 +395,9 @@ struct dhcp_opt_dns {
             uint32_t dns_server;
 
             p.deserialize(dns_server);
-            dns_server_list.push_back(dns_server);
+            if (!dns_server_list.push_back(dns_server)) {
+                return event_description::Evt_DHCP_Opt_List_Overflow;
+            }
             count --;
         }
 
@@ -439,12 +462,13 @@ struct dhcp_opt_autoconf {
 
 struct dhcp_opt_vendor_class_identifier {
     uint8_t len;
-    std::vector<uint8_t> val;
+    inline_list<uint8_t, DHCP_OPT_VAL_MAX> val;
 
     event_description deserialize(packet &p, logger *log, bool debug)
     {
         p.deserialize(len);
-        p.deserialize(val, len);
+        val.assign(p.buf + p.off, len);
+        p.off += len;
 
         return event_description::Evt_Parse_Ok;
     }
@@ -458,43 +482,55 @@ struct dhcp_opt_vendor_class_identifier {
     }
 };
 
+/**
+ * @brief - implements DHCP options.
+ *
+ * Each option is decoded into its own inline slot, list options keep a
+ * fixed number of entries and report an overflow event beyond that.
+*/
 struct dhcp_opts {
-    std::shared_ptr<dhcp_opt_msg_type> type;
-    std::shared_ptr<dhcp_opt_req_ipaddr> req_ipaddr;
-    std::shared_ptr<dhcp_opt_hostname> hostname;
-    std::shared_ptr<dhcp_opt_param_req_list> req_list;
-    std::shared_ptr<dhcp_opt_client_id> client_id;
-    std::shared_ptr<dhcp_opt_subnet_mask> subnet_mask;
-    std::shared_ptr<dhcp_opt_renewal_time> renewal_time;
-    std::shared_ptr<dhcp_opt_rebindig_time> rebind_time;
-    std::shared_ptr<dhcp_opt_ipaddr_lease_time> lease_time;
-    std::shared_ptr<dhcp_opt_dhcp_server_id> dhcp_server_id;
-    std::shared_ptr<dhcp_opt_domain_name> domain_name;
-    std::shared_ptr<dhcp_opt_router> router;
-    std::shared_ptr<dhcp_opt_dns> dns;
-    std::shared_ptr<dhcp_opt_perform_router_discover> perf_rdisc;
-    std::shared_ptr<dhcp_opt_autoconf> dhcp_autoconf;
-    std::shared_ptr<dhcp_opt_vendor_class_identifier> vendor_class_id;
+    inline_opt<dhcp_opt_msg_type> type;
+    inline_opt<dhcp_opt_req_ipaddr> req_ipaddr;
+    inline_opt<dhcp_opt_hostname> hostname;
+    inline_opt<dhcp_opt_param_req_list> req_list;
+    inline_opt<dhcp_opt_client_id> client_id;
+    inline_opt<dhcp_opt_subnet_mask> subnet_mask;
+    inline_opt<dhcp_opt_renewal_time> renewal_time;
+    inline_opt<dhcp_opt_rebindig_time> rebind_time;
+    inline_opt<dhcp_opt_ipaddr_lease_time> lease_time;
+    inline_opt<dhcp_opt_dhcp_server_id> dhcp_server_id;
+    inline_opt<dhcp_opt_domain_name> domain_name;
+    inline_opt<dhcp_opt_router> router;
+    inline_opt<dhcp_opt_dns> dns;
+    inline_opt<dhcp_opt_perform_router_discover> perf_rdisc;
+    inline_opt<dhcp_opt_autoconf> dhcp_autoconf;
+    inline_opt<dhcp_opt_vendor_class_identifier> vendor_class_id;
     dhcp_opt_param_end end;
 
-    explicit dhcp_opts() : 
-                type(nullptr),
-                req_ipaddr(nullptr),
-                hostname(nullptr),
-                req_list(nullptr),
-                client_id(nullptr),
-                subnet_mask(nullptr),
-                renewal_time(nullptr),
-                lease_time(nullptr),
-                dhcp_server_id(nullptr),
-                domain_name(nullptr),
-                router(nullptr),
-                dns(nullptr),
-                perf_rdisc(nullptr),
-                dhcp_autoconf(nullptr),
-                vendor_class_id(nullptr) { }
+    explicit dhcp_opts() { }
     ~dhcp_opts() { }
 
+    void reset()
+    {
+        type.reset();
+        req_ipaddr.reset();
+        hostname.reset();
+        req_list.reset();
+        client_id.reset();
+        subnet_mask.reset();
+        renewal_time.reset();
+        rebind_time.reset();
+        lease_time.reset();
+        dhcp_server_id.reset();
+        domain_name.reset();
+        router.reset();
+        dns.reset();
+        perf_rdisc.reset();
+        dhcp_autoconf.reset();
+        vendor_class_id.reset();
+        end.val = 0;
+    }
+
     int serialize(packet &p);
 
     /**
@@ -582,7 +618,7 @@ struct dhcp_hdr {
     void print(logger *log);
 
     private:
-        const int dhcp_hdr_len_no_opt_ = 240;
+        static constexpr int dhcp_hdr_len_no_opt_ = 240;
 };
 
 }
@@ -0,0 +1,161 @@
+/**
+ * @brief - implements internet checksum (RFC 1071) kernels.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <cstring>
+#include <checksum.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace firewall {
+
+typedef uint64_t (*csum_kernel)(const uint8_t *buf, uint32_t len);
+
+//
+// fold the 64 bit accumulator of a kernel to 32 bits
+static inline uint32_t csum_fold64(uint64_t sum)
+{
+    sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+    sum = (sum & 0xFFFFFFFF) + (sum >> 32);
+
+    return static_cast<uint32_t>(sum);
+}
+
+//
+// tail of the buffer, less than 8 bytes
+static inline uint64_t csum_tail(const uint8_t *buf, uint32_t len)
+{
+    uint64_t sum = 0;
+    uint16_t word;
+
+    while (len >= 2) {
+        std::memcpy(&word, buf, sizeof(word));
+        sum += word;
+        buf += 2;
+        len -= 2;
+    }
+
+    //
+    // odd byte is the high byte of a word in network order
+    if (len) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        sum += buf[0];
+#else
+        sum += static_cast<uint64_t>(buf[0]) << 8;
+#endif
+    }
+
+    return sum;
+}
+
+static uint64_t csum_scalar(const uint8_t *buf, uint32_t len)
+{
+    uint64_t sum = 0;
+    uint32_t word;
+
+    //
+    // 32 bit words in a 64 bit accumulator, carries are folded at the end
+    while (len >= 8) {
+        std::memcpy(&word, buf, sizeof(word));
+        sum += word;
+        std::memcpy(&word, buf + 4, sizeof(word));
+        sum += word;
+        buf += 8;
+        len -= 8;
+    }
+
+    return sum + csum_tail(buf, len);
+}
+
+#if defined(__x86_64__)
+
+//
+// each 32 bit lane takes two 16 bit words per block, so the lanes are
+// spilled to the 64 bit sum every 256K bytes, well before they overflow.
+#define CSUM_SIMD_SPILL_BYTES (256 * 1024)
+
+static uint64_t csum_sse2(const uint8_t *buf, uint32_t len)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t sum = 0;
+
+    while (len >= 16) {
+        uint32_t chunk = (len < CSUM_SIMD_SPILL_BYTES) ? len : CSUM_SIMD_SPILL_BYTES;
+        __m128i acc = _mm_setzero_si128();
+        uint32_t lanes[4];
+
+        chunk &= ~15U;
+        len -= chunk;
+
+        for (; chunk; chunk -= 16, buf += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+
+            acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+            acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+        sum += static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    return sum + csum_scalar(buf, len);
+}
+
+__attribute__((target("avx2")))
+static uint64_t csum_avx2(const uint8_t *buf, uint32_t len)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t sum = 0;
+
+    while (len >= 32) {
+        uint32_t chunk = (len < CSUM_SIMD_SPILL_BYTES) ? len : CSUM_SIMD_SPILL_BYTES;
+        __m256i acc = _mm256_setzero_si256();
+        uint32_t lanes[8];
+
+        chunk &= ~31U;
+        len -= chunk;
+
+        for (; chunk; chunk -= 32, buf += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf));
+
+            acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, zero));
+            acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, zero));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        sum += static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3] +
+               static_cast<uint64_t>(lanes[4]) + lanes[5] + lanes[6] + lanes[7];
+    }
+
+    return sum + csum_sse2(buf, len);
+}
+
+#endif
+
+static csum_kernel csum_select()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return csum_avx2;
+
+    //
+    // SSE2 is part of the x86_64 baseline
+    return csum_sse2;
+#else
+    return csum_scalar;
+#endif
+}
+
+//
+// selected once at startup
+static const csum_kernel csum_impl = csum_select();
+
+uint32_t csum_partial(const uint8_t *buf, uint32_t len, uint32_t sum)
+{
+    return csum_add(sum, csum_fold64(csum_impl(buf, len)));
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * @brief - implements internet checksum (RFC 1071) kernels.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_PROTOCOLS_COMMON_CHECKSUM_H__
+#define __FW_PROTOCOLS_COMMON_CHECKSUM_H__
+
+#include <stdint.h>
+#include <arpa/inet.h>
+
+namespace firewall {
+
+/**
+ * @brief - one's complement sum of a buffer.
+ *
+ * The 16 bit words are added in host order, so any value added to the
+ * sum with csum_add must be in network order. The sum is valid after
+ * csum_fold in either byte order, a header that carries its checksum
+ * folds to 0xFFFF.
+ *
+ * Uses AVX2 or SSE2 when the cpu has them, a scalar loop otherwise.
+ *
+ * @param [in] buf - buffer, no alignment needed
+ * @param [in] len - length of the buffer in bytes
+ * @param [in] sum - sum to continue from
+ *
+ * @return partial sum.
+*/
+uint32_t csum_partial(const uint8_t *buf, uint32_t len, uint32_t sum);
+
+//
+// add a 32 bit value with end around carry
+static inline uint32_t csum_add(uint32_t sum, uint32_t val)
+{
+    sum += val;
+    return sum + (sum < val);
+}
+
+//
+// fold the partial sum to 16 bits
+static inline uint16_t csum_fold(uint32_t sum)
+{
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+
+    return static_cast<uint16_t>(sum);
+}
+
+/**
+ * @brief - sum of the ipv4 pseudo header.
+ *
+ * @param [in] ip - ipv4 header in the frame
+ * @param [in] proto - l4 protocol
+ * @param [in] l4_len - l4 header and payload length
+ *
+ * @return partial sum.
+*/
+static inline uint32_t csum_pseudo_ipv4(const uint8_t *ip, uint8_t proto, uint16_t l4_len)
+{
+    uint32_t sum;
+
+    // source and destination address
+    sum = csum_partial(ip + 12, 8, 0);
+    sum = csum_add(sum, htons(proto));
+    sum = csum_add(sum, htons(l4_len));
+
+    return sum;
+}
+
+/**
+ * @brief - sum of the ipv6 pseudo header.
+ *
+ * @param [in] ip - ipv6 header in the frame
+ * @param [in] nh - l4 protocol
+ * @param [in] l4_len - l4 header and payload length
+ *
+ * @return partial sum.
+*/
+static inline uint32_t csum_pseudo_ipv6(const uint8_t *ip, uint8_t nh, uint32_t l4_len)
+{
+    uint32_t sum;
+
+    // source and destination address
+    sum = csum_partial(ip + 8, 32, 0);
+    sum = csum_add(sum, htonl(l4_len));
+    sum = csum_add(sum, htonl(nh));
+
+    return sum;
+}
+
+}
+
+#endif
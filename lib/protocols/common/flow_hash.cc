@@ -0,0 +1,150 @@
+/**
+ * @brief - implements symmetric flow hash of a frame.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <utility>
+#include <ether_types.h>
+#include <protocols_types.h>
+#include <hdr_views.h>
+#include <flow_hash.h>
+
+namespace firewall {
+
+#define FLOW_HASH_ETH_HDR_LEN 14
+#define FLOW_HASH_VLAN_TAG_LEN 4
+#define FLOW_HASH_IPV6_HDR_LEN 40
+#define FLOW_HASH_ARP_HDR_LEN 28
+#define FLOW_HASH_SEED 0x9E3779B9
+
+//
+// murmur3 finalizer
+static inline uint32_t flow_hash_fmix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static inline uint32_t flow_hash_mix(uint32_t h, uint32_t k)
+{
+    k *= 0xCC9E2D51;
+    k = (k << 15) | (k >> 17);
+    k *= 0x1B873593;
+
+    h ^= k;
+    h = (h << 13) | (h >> 19);
+
+    return h * 5 + 0xE6546B64;
+}
+
+//
+// endpoints are ordered so that both directions give the same hash
+static uint32_t flow_hash_tuple(uint32_t addr_a, uint32_t addr_b,
+                                uint16_t port_a, uint16_t port_b,
+                                uint8_t proto)
+{
+    uint32_t h = FLOW_HASH_SEED;
+
+    if ((addr_a > addr_b) || ((addr_a == addr_b) && (port_a > port_b))) {
+        std::swap(addr_a, addr_b);
+        std::swap(port_a, port_b);
+    }
+
+    h = flow_hash_mix(h, addr_a);
+    h = flow_hash_mix(h, addr_b);
+    h = flow_hash_mix(h, (static_cast<uint32_t>(port_a) << 16) | port_b);
+    h = flow_hash_mix(h, proto);
+
+    return flow_hash_fmix(h);
+}
+
+//
+// ipv6 address folded to 32 bits
+static inline uint32_t flow_hash_fold6(const uint8_t *addr)
+{
+    return load_be32(addr) ^ load_be32(addr + 4) ^
+           load_be32(addr + 8) ^ load_be32(addr + 12);
+}
+
+static inline bool flow_hash_has_ports(uint8_t proto)
+{
+    return (proto == static_cast<uint8_t>(protocols_types::Protocol_Tcp)) ||
+           (proto == static_cast<uint8_t>(protocols_types::Protocol_Udp));
+}
+
+uint32_t flow_hash(const uint8_t *buf, uint32_t len)
+{
+    uint32_t off = FLOW_HASH_ETH_HDR_LEN;
+    uint16_t port_a = 0;
+    uint16_t port_b = 0;
+    uint16_t ethertype;
+
+    if (len < FLOW_HASH_ETH_HDR_LEN) {
+        return 0;
+    }
+
+    ethertype = load_be16(buf + 12);
+
+    while (((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_VLAN)) ||
+            (ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_8021_AD))) &&
+           (off + FLOW_HASH_VLAN_TAG_LEN <= len)) {
+        ethertype = load_be16(buf + off + 2);
+        off += FLOW_HASH_VLAN_TAG_LEN;
+    }
+
+    if ((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv4)) &&
+        (off + 20 <= len)) {
+        const uint8_t *ip = buf + off;
+        uint32_t ihl = (ip[0] & 0x0F) * 4;
+        uint16_t frag = load_be16(ip + 6);
+        uint8_t proto = ip[9];
+
+        //
+        // more fragments flag or a fragment offset, no ports.
+        if (flow_hash_has_ports(proto) && ((frag & 0x3FFF) == 0) &&
+            (ihl >= 20) && (off + ihl + 4 <= len)) {
+            port_a = load_be16(ip + ihl);
+            port_b = load_be16(ip + ihl + 2);
+        }
+
+        return flow_hash_tuple(load_be32(ip + 12), load_be32(ip + 16),
+                               port_a, port_b, proto);
+    }
+
+    if ((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv6)) &&
+        (off + FLOW_HASH_IPV6_HDR_LEN <= len)) {
+        const uint8_t *ip = buf + off;
+        uint8_t nh = ip[6];
+
+        if (flow_hash_has_ports(nh) &&
+            (off + FLOW_HASH_IPV6_HDR_LEN + 4 <= len)) {
+            port_a = load_be16(ip + FLOW_HASH_IPV6_HDR_LEN);
+            port_b = load_be16(ip + FLOW_HASH_IPV6_HDR_LEN + 2);
+        }
+
+        return flow_hash_tuple(flow_hash_fold6(ip + 8), flow_hash_fold6(ip + 24),
+                               port_a, port_b, nh);
+    }
+
+    if ((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_ARP)) &&
+        (off + FLOW_HASH_ARP_HDR_LEN <= len)) {
+        const uint8_t *arp = buf + off;
+
+        // sender and target protocol address
+        return flow_hash_tuple(load_be32(arp + 14), load_be32(arp + 24),
+                               0, 0, 0);
+    }
+
+    //
+    // 48 bit mac addresses as a 32 bit word and a 16 bit port
+    return flow_hash_tuple(load_be32(buf), load_be32(buf + 6),
+                           load_be16(buf + 4), load_be16(buf + 10),
+                           0);
+}
+
+}
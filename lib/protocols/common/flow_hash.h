@@ -0,0 +1,35 @@
+/**
+ * @brief - implements symmetric flow hash of a frame.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_PROTOCOLS_COMMON_FLOW_HASH_H__
+#define __FW_PROTOCOLS_COMMON_FLOW_HASH_H__
+
+#include <stdint.h>
+
+namespace firewall {
+
+/**
+ * @brief - symmetric hash of the 5-tuple of a frame.
+ *
+ * Both directions of a flow hash to the same value, the endpoints are
+ * ordered before they are mixed. VLAN tags are skipped and not hashed, so
+ * a flow seen on two interfaces or two VLANs hashes the same.
+ *
+ * IPv4 fragments hash on the addresses and protocol only, the ports are
+ * only in the first fragment. IPv6 extension headers are not walked, the
+ * ports are hashed only when tcp or udp follows the fixed header.
+ * ARP hashes on the sender and target protocol addresses, any other frame
+ * on the pair of mac addresses.
+ *
+ * @param [in] buf - frame starting at the ethernet header
+ * @param [in] len - length of the frame
+ *
+ * @return hash value.
+*/
+uint32_t flow_hash(const uint8_t *buf, uint32_t len);
+
+}
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @brief - implements priority classification of a received frame.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <ether_types.h>
+#include <protocols_types.h>
+#include <port_numbers.h>
+#include <hdr_views.h>
+#include <known_exploits.h>
+#include <frame_class.h>
+
+namespace firewall {
+
+#define FRAME_CLASS_ETH_HDR_LEN 14
+#define FRAME_CLASS_VLAN_TAG_LEN 4
+#define FRAME_CLASS_IPV6_HDR_LEN 40
+
+#define FRAME_CLASS_DHCP6_CLIENT_PORT 546
+#define FRAME_CLASS_DHCP6_SERVER_PORT 547
+
+//
+// router solicitation to redirect
+#define FRAME_CLASS_ND_TYPE_MIN 133
+#define FRAME_CLASS_ND_TYPE_MAX 137
+
+#define FRAME_CLASS_TCP_FIN 0x01
+#define FRAME_CLASS_TCP_SYN 0x02
+#define FRAME_CLASS_TCP_RST 0x04
+#define FRAME_CLASS_TCP_PSH 0x08
+#define FRAME_CLASS_TCP_URG 0x20
+
+//
+// match only reads the exploit table, shared by all the rx threads
+static exploit_match expl;
+
+static bool frame_class_ports(uint8_t proto, const uint8_t *l4, uint32_t l4_len)
+{
+    uint16_t src_port;
+    uint16_t dst_port;
+
+    if (l4_len < 4) {
+        return false;
+    }
+
+    src_port = load_be16(l4);
+    dst_port = load_be16(l4 + 2);
+
+    if (proto == static_cast<uint8_t>(protocols_types::Protocol_Udp)) {
+        if ((dst_port == static_cast<uint16_t>(Port_Numbers::Port_Number_DHCP_Client)) ||
+            (dst_port == static_cast<uint16_t>(Port_Numbers::Port_Number_DHCP_Server)) ||
+            (dst_port == FRAME_CLASS_DHCP6_CLIENT_PORT) ||
+            (dst_port == FRAME_CLASS_DHCP6_SERVER_PORT)) {
+            return true;
+        }
+    } else if (proto == static_cast<uint8_t>(protocols_types::Protocol_Tcp)) {
+        uint8_t flags;
+
+        if (l4_len < 14) {
+            return false;
+        }
+
+        //
+        // null, xmas and syn-fin scans
+        flags = l4[13];
+        if ((flags == 0) ||
+            ((flags & (FRAME_CLASS_TCP_FIN | FRAME_CLASS_TCP_PSH | FRAME_CLASS_TCP_URG)) ==
+                (FRAME_CLASS_TCP_FIN | FRAME_CLASS_TCP_PSH | FRAME_CLASS_TCP_URG)) ||
+            ((flags & (FRAME_CLASS_TCP_SYN | FRAME_CLASS_TCP_FIN)) ==
+                (FRAME_CLASS_TCP_SYN | FRAME_CLASS_TCP_FIN)) ||
+            ((flags & (FRAME_CLASS_TCP_SYN | FRAME_CLASS_TCP_RST)) ==
+                (FRAME_CLASS_TCP_SYN | FRAME_CLASS_TCP_RST))) {
+            return true;
+        }
+    } else {
+        return false;
+    }
+
+    return expl.match(static_cast<Port_Numbers>(dst_port)) ||
+           expl.match(static_cast<Port_Numbers>(src_port));
+}
+
+bool frame_is_priority(const uint8_t *buf, uint32_t len)
+{
+    uint32_t off = FRAME_CLASS_ETH_HDR_LEN;
+    uint16_t ethertype;
+
+    if (len < FRAME_CLASS_ETH_HDR_LEN) {
+        return false;
+    }
+
+    ethertype = load_be16(buf + 12);
+
+    while (((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_VLAN)) ||
+            (ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_8021_AD))) &&
+           (off + FRAME_CLASS_VLAN_TAG_LEN <= len)) {
+        ethertype = load_be16(buf + off + 2);
+        off += FRAME_CLASS_VLAN_TAG_LEN;
+    }
+
+    if (ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_ARP)) {
+        return true;
+    }
+
+    if ((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv4)) &&
+        (off + 20 <= len)) {
+        const uint8_t *ip = buf + off;
+        uint32_t ihl = (ip[0] & 0x0F) * 4;
+
+        //
+        // ports are only in the first fragment
+        if ((ihl < 20) || (off + ihl > len) || (load_be16(ip + 6) & 0x1FFF)) {
+            return false;
+        }
+
+        return frame_class_ports(ip[9], ip + ihl, len - off - ihl);
+    }
+
+    if ((ethertype == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv6)) &&
+        (off + FRAME_CLASS_IPV6_HDR_LEN <= len)) {
+        const uint8_t *ip = buf + off;
+        const uint8_t *l4 = ip + FRAME_CLASS_IPV6_HDR_LEN;
+        uint32_t l4_len = len - off - FRAME_CLASS_IPV6_HDR_LEN;
+
+        if (ip[6] == static_cast<uint8_t>(protocols_types::Protocol_Icmp6)) {
+            return (l4_len >= 1) &&
+                   (l4[0] >= FRAME_CLASS_ND_TYPE_MIN) &&
+                   (l4[0] <= FRAME_CLASS_ND_TYPE_MAX);
+        }
+
+        return frame_class_ports(ip[6], l4, l4_len);
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,30 @@
+/**
+ * @brief - implements priority classification of a received frame.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_PROTOCOLS_COMMON_FRAME_CLASS_H__
+#define __FW_PROTOCOLS_COMMON_FRAME_CLASS_H__
+
+#include <stdint.h>
+
+namespace firewall {
+
+/**
+ * @brief - check if a frame must be kept over bulk traffic under overload.
+ *
+ * Looks only at the headers, before the frame is parsed. Priority frames
+ * are ARP, DHCP and DHCPv6, ICMPv6 router and neighbor discovery, tcp
+ * scans with invalid flag combinations and frames to or from a port of
+ * a known exploit.
+ *
+ * @param [in] buf - frame starting at the ethernet header
+ * @param [in] len - length of the frame
+ *
+ * @return true if priority.
+*/
+bool frame_is_priority(const uint8_t *buf, uint32_t len);
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @brief - implements zero copy header views over the packet buffer.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_PROTOCOLS_COMMON_HDR_VIEWS_H__
+#define __FW_PROTOCOLS_COMMON_HDR_VIEWS_H__
+
+#include <stdint.h>
+
+namespace firewall {
+
+//
+// headers are not aligned in the frame, so fields are read byte wise.
+// The result is in host order, same as packet::deserialize.
+static inline uint16_t load_be16(const uint8_t *b)
+{
+    return static_cast<uint16_t>((b[0] << 8) | b[1]);
+}
+
+static inline uint32_t load_be32(const uint8_t *b)
+{
+    return (static_cast<uint32_t>(b[0]) << 24) |
+           (static_cast<uint32_t>(b[1]) << 16) |
+           (static_cast<uint32_t>(b[2]) << 8) |
+           static_cast<uint32_t>(b[3]);
+}
+
+//
+// layer is not present in the packet
+#define LAYER_OFF_NONE 0xFFFF
+
+/**
+ * @brief - layers recorded in the offset table.
+*/
+enum class Layer_Flag : uint16_t {
+    Vlan = 0x0001,
+    IPv4 = 0x0002,
+    IPv6 = 0x0004,
+    Tcp = 0x0008,
+    Udp = 0x0010,
+};
+
+/**
+ * @brief - offset of each layer of a packet.
+ *
+ * Filled by the parser once per packet, the header views are created from
+ * these offsets when a filter reads a header field. The addresses and ports
+ * are read most often and are kept here as well.
+*/
+struct layer_offsets {
+    uint16_t l2;
+    uint16_t l3;
+    uint16_t l4;
+    uint16_t payload;
+    // ethertype of the l3 header, after any vlan tag
+    uint16_t ethertype;
+    // tag control of the vlan tag, in the frame or stripped by the NIC
+    uint16_t vlan_tci;
+    // ipv4 protocol or ipv6 next header
+    uint8_t l4_proto;
+    uint16_t flags;
+    // 5-tuple in host order, addresses are set only for ipv4
+    uint32_t src_addr;
+    uint32_t dst_addr;
+    uint16_t src_port;
+    uint16_t dst_port;
+
+    explicit layer_offsets() :
+                    l2(LAYER_OFF_NONE),
+                    l3(LAYER_OFF_NONE),
+                    l4(LAYER_OFF_NONE),
+                    payload(LAYER_OFF_NONE),
+                    ethertype(0),
+                    vlan_tci(0),
+                    l4_proto(0),
+                    flags(0),
+                    src_addr(0),
+                    dst_addr(0),
+                    src_port(0),
+                    dst_port(0) { }
+    ~layer_offsets() { }
+
+    inline void set(Layer_Flag f) { flags |= static_cast<uint16_t>(f); }
+    inline bool has(Layer_Flag f) const
+    {
+        return !!(flags & static_cast<uint16_t>(f));
+    }
+};
+
+/**
+ * @brief - ethernet header view.
+*/
+struct eth_view {
+    static constexpr uint32_t hdr_len = 14;
+
+    explicit eth_view(const uint8_t *h) : h_(h) { }
+
+    inline const uint8_t *dst_mac() const { return h_; }
+    inline const uint8_t *src_mac() const { return h_ + 6; }
+    inline uint16_t ethertype() const { return load_be16(h_ + 12); }
+
+    private:
+        const uint8_t *h_;
+};
+
+/**
+ * @brief - vlan tag view, starts after the TPID.
+*/
+struct vlan_view {
+    static constexpr uint32_t hdr_len = 4;
+
+    explicit vlan_view(const uint8_t *h) : h_(h) { }
+
+    inline uint8_t pri() const { return (h_[0] & 0xE0) >> 5; }
+    inline uint16_t vid() const { return load_be16(h_) & 0x0FFF; }
+    inline uint16_t ethertype() const { return load_be16(h_ + 2); }
+
+    private:
+        const uint8_t *h_;
+};
+
+/**
+ * @brief - ipv4 header view.
+*/
+struct ipv4_view {
+    static constexpr uint32_t hdr_len_min = 20;
+
+    explicit ipv4_view(const uint8_t *h) : h_(h) { }
+
+    inline uint8_t version() const { return (h_[0] & 0xF0) >> 4; }
+    inline uint32_t hdr_len() const { return (h_[0] & 0x0F) * 4; }
+    inline uint16_t total_len() const { return load_be16(h_ + 2); }
+    inline uint16_t identification() const { return load_be16(h_ + 4); }
+    inline bool reserved() const { return !!(h_[6] & 0x80); }
+    inline bool dont_frag() const { return !!(h_[6] & 0x40); }
+    inline bool more_frag() const { return !!(h_[6] & 0x20); }
+    inline uint32_t frag_off() const { return load_be16(h_ + 6) & 0x1FFF; }
+    inline bool is_a_frag() const { return more_frag() || (frag_off() > 0); }
+    inline uint8_t ttl() const { return h_[8]; }
+    inline uint8_t protocol() const { return h_[9]; }
+    inline uint16_t hdr_chksum() const { return load_be16(h_ + 10); }
+    inline uint32_t src_addr() const { return load_be32(h_ + 12); }
+    inline uint32_t dst_addr() const { return load_be32(h_ + 16); }
+
+    private:
+        const uint8_t *h_;
+};
+
+/**
+ * @brief - ipv6 header view.
+*/
+struct ipv6_view {
+    static constexpr uint32_t hdr_len = 40;
+
+    explicit ipv6_view(const uint8_t *h) : h_(h) { }
+
+    inline uint8_t version() const { return (h_[0] & 0xF0) >> 4; }
+    inline uint16_t payload_len() const { return load_be16(h_ + 4); }
+    inline uint8_t nh() const { return h_[6]; }
+    inline uint8_t hop_limit() const { return h_[7]; }
+    inline const uint8_t *src_addr() const { return h_ + 8; }
+    inline const uint8_t *dst_addr() const { return h_ + 24; }
+
+    private:
+        const uint8_t *h_;
+};
+
+/**
+ * @brief - tcp header view.
+*/
+struct tcp_view {
+    static constexpr uint32_t hdr_len_min = 20;
+
+    explicit tcp_view(const uint8_t *h) : h_(h) { }
+
+    inline uint16_t src_port() const { return load_be16(h_); }
+    inline uint16_t dst_port() const { return load_be16(h_ + 2); }
+    inline uint32_t seq_no() const { return load_be32(h_ + 4); }
+    inline uint32_t ack_no() const { return load_be32(h_ + 8); }
+    inline uint32_t hdr_len() const { return ((h_[12] & 0xF0) >> 4) * 4; }
+    inline uint8_t flags() const { return h_[13]; }
+    inline uint16_t window() const { return load_be16(h_ + 14); }
+    inline uint16_t checksum() const { return load_be16(h_ + 16); }
+
+    private:
+        const uint8_t *h_;
+};
+
+/**
+ * @brief - udp header view.
+*/
+struct udp_view {
+    static constexpr uint32_t hdr_len = 8;
+
+    explicit udp_view(const uint8_t *h) : h_(h) { }
+
+    inline uint16_t src_port() const { return load_be16(h_); }
+    inline uint16_t dst_port() const { return load_be16(h_ + 2); }
+    inline uint16_t length() const { return load_be16(h_ + 4); }
+    inline uint16_t checksum() const { return load_be16(h_ + 6); }
+
+    private:
+        const uint8_t *h_;
+};
+
+}
+
+#endif
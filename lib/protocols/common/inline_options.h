@@ -0,0 +1,163 @@
+/**
+ * @brief - implements allocation free storage for decoded protocol options.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_PROTOCOLS_COMMON_INLINE_OPTIONS_H__
+#define __FW_PROTOCOLS_COMMON_INLINE_OPTIONS_H__
+
+#include <stdint.h>
+#include <cstring>
+#include <utility>
+#include <packet.h>
+
+namespace firewall {
+
+/**
+ * @brief - holds a decoded option inline in the header.
+ *
+ * Behaves like a pointer to the option, it is true once the option is
+ * decoded and the option is accessed with -> or *. The option storage is
+ * part of the header, so decoding an option never allocates.
+*/
+template <typename T>
+struct inline_opt {
+    explicit inline_opt() : present_(false), val_() { }
+    ~inline_opt() { }
+
+    /**
+     * @brief - mark the option present and construct it in the slot.
+     *
+     * @param [in] args - option constructor arguments
+     *
+     * @return option slot.
+    */
+    template <typename... Args>
+    inline T *emplace(Args&&... args)
+    {
+        val_ = T(std::forward<Args>(args)...);
+        present_ = true;
+        return &val_;
+    }
+
+    inline void reset() { present_ = false; }
+
+    explicit operator bool() const { return present_; }
+    T *operator->() { return &val_; }
+    const T *operator->() const { return &val_; }
+    T &operator*() { return val_; }
+    const T &operator*() const { return val_; }
+
+    private:
+        bool present_;
+        T val_;
+};
+
+/**
+ * @brief - fixed capacity list of decoded option values.
+ *
+ * Values beyond the capacity are not stored, the list is marked as
+ * overflowed instead so that the parser can report it as an event.
+*/
+template <typename T, uint32_t N>
+struct inline_list {
+    explicit inline_list() : count_(0), overflow_(false), items_() { }
+    ~inline_list() { }
+
+    /**
+     * @brief - append a value.
+     *
+     * @return true if stored, false if the list is full.
+    */
+    inline bool push_back(const T &val)
+    {
+        if (count_ == N) {
+            overflow_ = true;
+            return false;
+        }
+
+        items_[count_ ++] = val;
+        return true;
+    }
+
+    /**
+     * @brief - copy a run of values.
+     *
+     * @param [in] vals - values
+     * @param [in] n - number of values
+     *
+     * @return true if all the values are stored, false if truncated.
+    */
+    inline bool assign(const T *vals, uint32_t n)
+    {
+        count_ = (n > N) ? N : n;
+        overflow_ = n > N;
+        std::memcpy(items_, vals, count_ * sizeof(T));
+
+        return !overflow_;
+    }
+
+    inline void clear()
+    {
+        count_ = 0;
+        overflow_ = false;
+    }
+
+    inline uint32_t size() const { return count_; }
+    inline bool empty() const { return count_ == 0; }
+    inline bool overflowed() const { return overflow_; }
+    static constexpr uint32_t capacity() { return N; }
+
+    T &operator[](uint32_t i) { return items_[i]; }
+    const T &operator[](uint32_t i) const { return items_[i]; }
+    T *data() { return items_; }
+    const T *data() const { return items_; }
+    T *begin() { return items_; }
+    T *end() { return items_ + count_; }
+    const T *begin() const { return items_; }
+    const T *end() const { return items_ + count_; }
+
+    private:
+        uint32_t count_;
+        bool overflow_;
+        T items_[N];
+};
+
+/**
+ * @brief - bounds the options area of a header.
+ *
+ * Options are decoded in place from the packet, the area makes sure that
+ * an option length never walks into the next header or past the frame.
+*/
+struct opt_area {
+    explicit opt_area(const packet &p, uint32_t len) :
+                    end_((p.off + len < p.buf_len) ? p.off + len : p.buf_len) { }
+    ~opt_area() { }
+
+    //
+    // more options to decode
+    inline bool has_more(const packet &p) const { return p.off < end_; }
+
+    //
+    // len bytes from the current offset are within the area
+    inline bool fits(const packet &p, uint32_t len) const
+    {
+        return (p.off <= end_) && (len <= end_ - p.off);
+    }
+
+    //
+    // move to the end of an option whose value is val_len bytes
+    inline void skip(packet &p, uint32_t val_len) const
+    {
+        p.off = fits(p, val_len) ? p.off + val_len : end_;
+    }
+
+    inline uint32_t end() const { return end_; }
+
+    private:
+        uint32_t end_;
+};
+
+}
+
+#endif
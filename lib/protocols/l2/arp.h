@@ -79,7 +79,7 @@ struct arp_hdr {
     uint16_t get_hdr_len() { return arp_hdr_len_; }
 
     private:
-        const int arp_hdr_len_ = 28;
+        static constexpr int arp_hdr_len_ = 28;
 };
 
 }
@@ -10,8 +10,8 @@ namespace firewall {
 
 void eth_hdr::serialize(packet &p)
 {
-    p.serialize(src_mac);
     p.serialize(dst_mac);
+    p.serialize(src_mac);
     p.serialize(ethertype);
 }
 
@@ -22,8 +22,8 @@ event_description eth_hdr::deserialize(packet &p, logger *log, bool debug)
     if (p.remaining_len() < eth_hdr_len_)
         return event_description::Evt_Eth_Hdrlen_Too_Small;
 
-    p.deserialize(src_mac);
     p.deserialize(dst_mac);
+    p.deserialize(src_mac);
     p.deserialize(ethertype);
 
     if (debug)
@@ -24,6 +24,12 @@ struct eth_hdr {
     uint8_t dst_mac[FW_MACADDR_LEN];
     uint16_t ethertype;
 
+    explicit eth_hdr() : ethertype(0)
+    {
+        std::memset(src_mac, 0, sizeof(src_mac));
+        std::memset(dst_mac, 0, sizeof(dst_mac));
+    }
+
     inline bool has_ethertype_ipv4() const
     {
         return (Ether_Type)ethertype == Ether_Type::Ether_Type_IPv4;
@@ -92,7 +98,7 @@ struct eth_hdr {
 
     private:
         void print(logger *log);
-        const uint16_t eth_hdr_len_ = 14;
+        static constexpr uint16_t eth_hdr_len_ = 14;
 };
 
 };
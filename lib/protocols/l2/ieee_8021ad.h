@@ -61,7 +61,7 @@ struct ieee8021ad_hdr {
     }
 
     private:
-        const int len_ = 4;
+        static constexpr int len_ = 4;
 };
 
 }
@@ -97,6 +97,27 @@ event_description vlan_hdr::deserialize(packet &p, logger *log, bool debug)
     return evt_desc;
 }
 
+event_description vlan_hdr::deserialize_tag(uint16_t tci, uint16_t inner_ethertype,
+                                            logger *log, bool debug)
+{
+    pri = (tci & 0xE000) >> 13;
+    dei = !!(tci & 0x1000);
+    vid = tci & 0x0FFF;
+    ethertype = inner_ethertype;
+
+    //
+    // match the reserved VIDs
+    for (auto i : reserved_vlan_ids) {
+        if (vid == i)
+            return event_description::Evt_VLAN_Inval_VID;
+    }
+
+    if (debug)
+        print(log);
+
+    return event_description::Evt_Parse_Ok;
+}
+
 void vlan_hdr::print(logger *log)
 {
 #if defined(FW_ENABLE_DEBUG)
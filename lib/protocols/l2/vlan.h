@@ -43,6 +43,18 @@ struct vlan_hdr {
     */
     event_description deserialize(packet &p, logger *log, bool debug = false);
 
+    /**
+     * @brief - rebuild the VLAN header from a tag stripped by the NIC.
+     *
+     * @param [in] tci - tag control information
+     * @param [in] inner_ethertype - ethertype following the tag
+     * @param [in] log - logger.
+     * @param [in] debug - debug flag.
+     * @return returns event_description type.
+    */
+    event_description deserialize_tag(uint16_t tci, uint16_t inner_ethertype,
+                                      logger *log, bool debug = false);
+
     /**
      * @brief - return the ethertype
      *
@@ -50,7 +50,7 @@ struct ipsec_ah_hdr {
     void print(logger *log);
 
     private:
-        const int len_ = 1;
+        static constexpr int len_ = 1;
 };
 
 }
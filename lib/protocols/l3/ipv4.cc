@@ -5,6 +5,7 @@
 */
 #include <ipv4.h>
 #include <ipv6.h>
+#include <checksum.h>
 
 namespace firewall {
 
@@ -99,45 +100,51 @@ int ipv4_hdr::serialize(packet &p)
 
 bool ipv4_hdr::validate_checksum(packet &p)
 {
-    uint32_t csum = 0;
-    uint32_t carry = 0;
-    uint32_t i = 0;
-
     //
-    // every two bytes are added until the end of the frame
-    for (i = start_off; i < end_off; i += 2) {
-        csum += (p.buf[i + 1] << 8) | p.buf[i];
-    }
+    // sum of the header along with the checksum must fold to 0xFFFF
+    return csum_fold(csum_partial(p.buf + start_off, end_off - start_off, 0)) == 0xFFFF;
+}
 
-    // if over 0xFFFF, get the carry in the 3rd byte
-    carry = (csum & 0xFF0000) >> 16;
-    // find the resulting checksum without carry
-    csum = csum & 0xFFFF;
+uint16_t ipv4_hdr::generate_checksum(packet &p)
+{
+    return ~csum_fold(csum_partial(p.buf + start_off, end_off - start_off, 0));
+}
 
-    // the sum of checksum and carry now must be 0xFFFF
-    // this means that the checksum is valid.
-    if (csum + carry == 0xFFFF) {
-        return true;
+event_description ipv4_hdr::check_addrs(uint32_t src, uint32_t dst)
+{
+    //
+    // Source and Destination IPv4 addresses are same
+    if (!is_loopback(src) &&
+        !is_loopback(dst) &&
+        (src == dst)) {
+        return event_description::Evt_IPv4_Src_And_Dst_Addr_Same;
     }
 
-    return false;
-}
+    //
+    // drop if Src IPv4 address is a broadcast address
+    if (is_broadcast(src)) {
+        return event_description::Evt_IPv4_Src_Is_Broadcast;
+    }
 
-uint16_t ipv4_hdr::generate_checksum(packet &p)
-{
-    uint32_t csum = 0;
-    uint32_t carry = 0;
-    uint32_t i = 0;
+    //
+    // drop if Src IPv4 address is a multicast address
+    if (is_multicast(src)) {
+        return event_description::Evt_IPv4_Src_Is_Multicast;
+    }
 
-    for (i = start_off; i < end_off; i += 2) {
-        csum += (p.buf[i + 1] << 8) | p.buf[i];
+    //
+    // IPv4 Src address is reserved
+    if (is_reserved(src)) {
+        return event_description::Evt_IPv4_Src_Is_Reserved;
     }
 
-    carry = (csum & 0xFF0000) >> 16;
-    csum = csum & 0xFFFF;
-    csum += carry;
+    //
+    // IPv4 Dst address is reserved
+    if (is_reserved(dst)) {
+        return event_description::Evt_IPv4_Dst_Is_Reserved;
+    }
 
-    return ~csum;
+    return event_description::Evt_Parse_Ok;
 }
 
 event_description ipv4_hdr::deserialize(packet &p, logger *log, bool debug)
@@ -218,40 +225,14 @@ event_description ipv4_hdr::deserialize(packet &p, logger *log, bool debug)
     p.deserialize(src_addr);
     p.deserialize(dst_addr);
 
-    //
-    // Source and Destination IPv4 addresses are same
-    if (!is_src_loopback() &&
-        !is_dst_loopback() &&
-        (src_addr == dst_addr)) {
-        return event_description::Evt_IPv4_Src_And_Dst_Addr_Same;
-    }
-
-    //
-    // drop if Src IPv4 address is a broadcast address
-    if (is_broadcast(src_addr)) {
-        return event_description::Evt_IPv4_Src_Is_Broadcast;
-    }
-
-    //
-    // drop if Src IPv4 address is a multicast address
-    if (is_multicast(src_addr)) {
-        return event_description::Evt_IPv4_Src_Is_Multicast;
-    }
-
-    //
-    // IPv4 Src address is reserved
-    if (is_reserved(src_addr)) {
-        return event_description::Evt_IPv4_Src_Is_Reserved;
-    }
-
-    //
-    // IPv4 Dst address is reserved
-    if (is_reserved(dst_addr)) {
-        return event_description::Evt_IPv4_Dst_Is_Reserved;
+    evt_desc = check_addrs(src_addr, dst_addr);
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        return evt_desc;
     }
 
     //
     // parse options
+    opt.reset();
     if (hdr_len > IPV4_HDR_NO_OPTIONS) {
         evt_desc = opt.deserialize(p, log, hdr_len - IPV4_HDR_NO_OPTIONS, debug);
         if (evt_desc != event_description::Evt_Parse_Ok)
@@ -287,8 +268,9 @@ event_description ipv4_hdr::deserialize(packet &p, logger *log, bool debug)
     }
 
     //
-    // validate the checksum
-    if (validate_checksum(p) == false) {
+    // validate the checksum, unless it is offloaded and not yet computed
+    if (!p.has_rx_flag(Packet_Rx_Flag::Csum_Not_Ready) &&
+        (validate_checksum(p) == false)) {
         return event_description::Evt_IPV4_Hdr_Chksum_Invalid;
     }
 
@@ -342,65 +324,71 @@ void ipv4_hdr::get_ipaddr_str(uint32_t ipaddr, std::string &ipaddr_str)
 
 event_description ipv4_options::deserialize(packet &p, logger *log, uint32_t opt_len, bool debug)
 {
-    event_description evt_desc = event_description::Evt_IPV4_Unknown_Opt;
+    event_description evt_desc = event_description::Evt_Parse_Ok;
+    opt_area area(p, opt_len);
     uint32_t copy_on_frag;
     uint32_t cls;
+    uint32_t val_off;
     IPv4_Opt opt;
     uint8_t val = 0;
-    uint32_t len = opt_len + p.off;
+    uint8_t len = 0;
 
-    while (p.off < len) {
+    while (area.has_more(p)) {
         p.deserialize(val);
         copy_on_frag = !!(val & 0x80);
         cls = (val & 0x60) >> 5;
         opt = static_cast<IPv4_Opt>(val & 0x1F);
 
+        //
+        // single byte options
+        if (opt == IPv4_Opt::End_Of_Options) {
+            //
+            // rest of the options area is padding
+            p.off = area.end();
+            break;
+        } else if (opt == IPv4_Opt::Nop) {
+            continue;
+        }
+
+        //
+        // rest of the options carry the length including type and length,
+        // the option must fit within the options area.
+        val_off = p.off;
+        if (!area.fits(p, 1))
+            return event_description::Evt_IPv4_Opt_Len_Inval;
+
+        len = p.buf[p.off];
+        if ((len < IPV4_OPT_HDR_LEN) || !area.fits(p, len - 1))
+            return event_description::Evt_IPv4_Opt_Len_Inval;
+
         switch (opt) {
-            case IPv4_Opt::End_Of_Options: {
-                // 0 bytes in length - generally is 0
-                p.off ++;
-            } break;
-            case IPv4_Opt::Nop: {
-            } break;
             case IPv4_Opt::Timestamp: {
-                ts = std::make_shared<ipv4_opt_timestamp>(copy_on_frag, cls);
-                if (!ts)
-                    return event_description::Evt_Unknown_Error;
-
-                evt_desc = ts->deserialize(p, log, debug);
+                evt_desc = ts.emplace(copy_on_frag, cls)->deserialize(p, log, debug);
             } break;
             case IPv4_Opt::Router_Alert: {
-                ra = std::make_shared<ipv4_opt_router_alert>(copy_on_frag, cls);
-                if (!ra)
-                    return event_description::Evt_Unknown_Error;
-
-                evt_desc = ra->deserialize(p, log, debug);
+                evt_desc = ra.emplace(copy_on_frag, cls)->deserialize(p, log, debug);
             } break;
             case IPv4_Opt::Commercial_IP_Security: {
-                comm_sec = std::make_shared<ipv4_opt_comm_sec>(copy_on_frag, cls);
-                if (!comm_sec)
-                    return event_description::Evt_Unknown_Error;
-
-                evt_desc = comm_sec->deserialize(p, log, debug);
+                evt_desc = comm_sec.emplace(copy_on_frag, cls)->deserialize(p, log, debug);
             } break;
             case IPv4_Opt::Strict_Source_Route: {
-                ssr = std::make_shared<ipv4_opt_strict_source_route>(copy_on_frag, cls);
-                if (!ssr)
-                    return event_description::Evt_Unknown_Error;
-
-                evt_desc = ssr->deserialize(p, log, debug);
+                evt_desc = ssr.emplace(copy_on_frag, cls)->deserialize(p, log, debug);
             } break;
             case IPv4_Opt::Loose_Source_Route: {
-                lsr = std::make_shared<ipv4_opt_loose_source_route>(copy_on_frag, cls);
-                if (!lsr)
-                    return event_description::Evt_Unknown_Error;
-
-                evt_desc = lsr->deserialize(p, log, debug);
+                evt_desc = lsr.emplace(copy_on_frag, cls)->deserialize(p, log, debug);
             } break;
             default:
                 return event_description::Evt_IPV4_Unknown_Opt;
         }
+
+        if (evt_desc != event_description::Evt_Parse_Ok)
+            return evt_desc;
+
+        //
+        // skip any part of the option that is not decoded
+        p.off = val_off + len - 1;
     }
+
     return evt_desc;
 }
 
@@ -417,6 +405,7 @@ event_description ipv4_opt_timestamp::deserialize(packet &p, logger *log, bool d
 {
     uint8_t byte;
     uint32_t len_parsed = 4;
+    uint32_t entry_len;
 
     p.deserialize(len);
     p.deserialize(ptr);
@@ -424,21 +413,23 @@ event_description ipv4_opt_timestamp::deserialize(packet &p, logger *log, bool d
     overflow = (byte & 0xF0) >> 4;
     flag = (byte & 0x0F);
 
-    while (len_parsed < len) {
-        if (flag == IPV4_OPT_FLAG_TS_ONLY) {
-            ipv4_opt_ts_data ts_data;
+    entry_len = (flag == IPV4_OPT_FLAG_TS_ONLY) ? 4 : 8;
 
-            p.deserialize(ts_data.ts);
-            ts_list.push_back(ts_data);
-            len_parsed += 4;
-        } else if (flag == IPV4_OPT_FLAG_TS_AND_ADDR) {
-            ipv4_opt_ts_data ts_data;
+    while (len_parsed + entry_len <= len) {
+        ipv4_opt_ts_data ts_data;
 
+        if (flag != IPV4_OPT_FLAG_TS_ONLY) {
             p.deserialize(ts_data.ipaddr);
-            p.deserialize(ts_data.ts);
-            ts_list.push_back(ts_data);
-            len_parsed += 8;
         }
+        p.deserialize(ts_data.ts);
+
+        //
+        // the option length is bounded by the header length, so the list
+        // can not overflow unless the length is bogus.
+        if (!ts_list.push_back(ts_data))
+            return event_description::Evt_IPv4_Opt_Len_Inval;
+
+        len_parsed += entry_len;
     }
 
     return event_description::Evt_Parse_Ok;
@@ -7,11 +7,11 @@
 #define __FW_PROTOCOLS_IPV4_H__
 
 #include <stdint.h>
-#include <vector>
 #include <memory>
 #include <logger.h>
 #include <packet.h>
 #include <protocols_types.h>
+#include <inline_options.h>
 #include <event_def.h>
 #include <logger.h>
 
@@ -26,6 +26,10 @@ namespace firewall {
 #define IPV4_RESERVED_ADDR_START 240
 #define IPV4_RESERVED_ADDR_END 255
 #define IPV4_BROADCAST_ADDR 0xFFFFFFFF
+#define IPV4_OPT_HDR_LEN 2
+//
+// (IPV4_HDR_LEN_MAX - IPV4_HDR_NO_OPTIONS - timestamp option header) / 4
+#define IPV4_OPT_TS_MAX_ENTRIES 9
 
 struct ipv6_hdr;
 
@@ -47,9 +51,20 @@ struct ipv4_opt_comm_sec {
     uint8_t tag_type;
     uint8_t sensitivity_level;
 
+    explicit ipv4_opt_comm_sec() :
+                                    copy_on_frag(0),
+                                    cls(0),
+                                    len(0),
+                                    doi(0),
+                                    tag_type(0),
+                                    sensitivity_level(0) { }
     explicit ipv4_opt_comm_sec(uint32_t copy_on_frag, uint32_t cls) :
                                     copy_on_frag(copy_on_frag),
-                                    cls(cls) { }
+                                    cls(cls),
+                                    len(0),
+                                    doi(0),
+                                    tag_type(0),
+                                    sensitivity_level(0) { }
     ~ipv4_opt_comm_sec() { }
     event_description deserialize(packet &p, logger *log, bool debug);
     void print(logger *log)
@@ -73,18 +88,29 @@ struct ipv4_opt_ts_data {
 struct ipv4_opt_timestamp {
 #define IPV4_OPT_FLAG_TS_ONLY 0
 #define IPV4_OPT_FLAG_TS_AND_ADDR 1
+#define IPV4_OPT_FLAG_TS_PRESPECIFIED 3
     uint32_t copy_on_frag:1;
     uint32_t cls:2;
     uint8_t len;
     uint8_t ptr;
     uint32_t overflow:4;
     uint32_t flag:4;
-    std::vector<ipv4_opt_ts_data> ts_list;
-
-    explicit ipv4_opt_timestamp() { }
+    inline_list<ipv4_opt_ts_data, IPV4_OPT_TS_MAX_ENTRIES> ts_list;
+
+    explicit ipv4_opt_timestamp() :
+                                    copy_on_frag(0),
+                                    cls(0),
+                                    len(0),
+                                    ptr(0),
+                                    overflow(0),
+                                    flag(0) { }
     explicit ipv4_opt_timestamp(uint32_t copy_on_frag, uint32_t cls) :
                                     copy_on_frag(copy_on_frag),
-                                    cls(cls) { }
+                                    cls(cls),
+                                    len(0),
+                                    ptr(0),
+                                    overflow(0),
+                                    flag(0) { }
     ~ipv4_opt_timestamp() { }
 
     event_description deserialize(packet &p, logger *log, bool debug);
@@ -113,9 +139,10 @@ struct ipv4_opt_router_alert {
     uint8_t len;
     uint16_t router_alert;
 
-    explicit ipv4_opt_router_alert() { }
+    explicit ipv4_opt_router_alert() :
+                    copy_on_fragment(0), cls(0), len(0), router_alert(0) { }
     explicit ipv4_opt_router_alert(uint32_t cof, uint32_t cls) :
-                    copy_on_fragment(cof), cls(cls) { }
+                    copy_on_fragment(cof), cls(cls), len(0), router_alert(0) { }
     ~ipv4_opt_router_alert() { }
 
     event_description deserialize(packet &p, logger *log, bool debug);
@@ -139,8 +166,12 @@ struct ipv4_opt_strict_source_route {
     uint8_t pointer;
     uint32_t dest_addr;
 
-    ipv4_opt_strict_source_route(uint32_t copy_on_frag, uint32_t cls) :
-                        copy_on_fragment(copy_on_frag), cls(cls) { }
+    explicit ipv4_opt_strict_source_route() :
+                        copy_on_fragment(0), cls(0),
+                        len(0), pointer(0), dest_addr(0) { }
+    explicit ipv4_opt_strict_source_route(uint32_t copy_on_frag, uint32_t cls) :
+                        copy_on_fragment(copy_on_frag), cls(cls),
+                        len(0), pointer(0), dest_addr(0) { }
     ~ipv4_opt_strict_source_route() { }
 
     event_description deserialize(packet &p, logger *log, bool debug);
@@ -158,7 +189,7 @@ struct ipv4_opt_strict_source_route {
     }
 
     private:
-        const int len_ = 6;
+        static constexpr int len_ = 6;
 };
 
 struct ipv4_opt_loose_source_route {
@@ -168,8 +199,12 @@ struct ipv4_opt_loose_source_route {
     uint8_t pointer;
     uint32_t dest_addr;
 
-    ipv4_opt_loose_source_route(uint32_t copy_on_frag, uint32_t cls) :
-                        copy_on_fragment(copy_on_frag), cls(cls) { }
+    explicit ipv4_opt_loose_source_route() :
+                        copy_on_fragment(0), cls(0),
+                        len(0), pointer(0), dest_addr(0) { }
+    explicit ipv4_opt_loose_source_route(uint32_t copy_on_frag, uint32_t cls) :
+                        copy_on_fragment(copy_on_frag), cls(cls),
+                        len(0), pointer(0), dest_addr(0) { }
     ~ipv4_opt_loose_source_route() { }
 
     event_description deserialize(packet &p, logger *log, bool debug);
@@ -189,22 +224,28 @@ struct ipv4_opt_loose_source_route {
 
 /**
  * @brief - parses list of ipv4 options.
+ *
+ * Each option is decoded into its own inline slot of the header.
 */
 struct ipv4_options {
-    std::shared_ptr<ipv4_opt_comm_sec> comm_sec;
-    std::shared_ptr<ipv4_opt_timestamp> ts;
-    std::shared_ptr<ipv4_opt_router_alert> ra;
-    std::shared_ptr<ipv4_opt_strict_source_route> ssr;
-    std::shared_ptr<ipv4_opt_loose_source_route> lsr;
-
-    explicit ipv4_options() :
-                    comm_sec(nullptr),
-                    ts(nullptr),
-                    ra(nullptr),
-                    ssr(nullptr),
-                    lsr(nullptr) { }
+    inline_opt<ipv4_opt_comm_sec> comm_sec;
+    inline_opt<ipv4_opt_timestamp> ts;
+    inline_opt<ipv4_opt_router_alert> ra;
+    inline_opt<ipv4_opt_strict_source_route> ssr;
+    inline_opt<ipv4_opt_loose_source_route> lsr;
+
+    explicit ipv4_options() { }
     ~ipv4_options() { }
 
+    inline void reset()
+    {
+        comm_sec.reset();
+        ts.reset();
+        ra.reset();
+        ssr.reset();
+        lsr.reset();
+    }
+
     event_description deserialize(packet &p, logger *log, uint32_t opt_len, bool debug);
     void print(logger *log)
     {
@@ -290,6 +331,18 @@ struct ipv4_hdr {
     */
     event_description deserialize(packet &p, logger *log, bool debug = false);
 
+    /**
+     * @brief - check the source and destination addresses.
+     *
+     * Shared by the full decode and the header views.
+     *
+     * @param [in] src - source address in host byte order
+     * @param [in] dst - destination address in host byte order
+     *
+     * @return Evt_Parse_Ok if the addresses are valid.
+    */
+    static event_description check_addrs(uint32_t src, uint32_t dst);
+
     /**
      * @brief - prints the ipv4 header
      *
@@ -372,8 +425,7 @@ struct ipv4_hdr {
         return is_directed_broadcat(src_addr);
     }
 
-    private:
-    inline bool is_multicast(uint32_t ip_addr)
+    static inline bool is_multicast(uint32_t ip_addr)
     {
         uint32_t byte = (ip_addr & 0xFF000000) >> 24;
 
@@ -383,7 +435,7 @@ struct ipv4_hdr {
         return false;
     }
 
-    inline bool is_reserved(uint32_t ip_addr)
+    static inline bool is_reserved(uint32_t ip_addr)
     {
         uint32_t byte = (ip_addr & 0xFF000000) >> 24;
 
@@ -393,18 +445,19 @@ struct ipv4_hdr {
         return false;
     }
 
-    inline bool is_broadcast(uint32_t ipaddr)
+    static inline bool is_broadcast(uint32_t ipaddr)
     {
         return ipaddr == 0xFFFFFFFF;
     }
 
-    inline bool is_loopback(uint32_t ipaddr)
+    static inline bool is_loopback(uint32_t ipaddr)
     {
         uint32_t byte = (ipaddr & 0xFF000000) >> 24;
 
         return (byte == 0x7F);
     }
 
+    private:
     //
     // sometimes this is not the only directed broadcast
     // address. It depends on the network mask / subnet mask.
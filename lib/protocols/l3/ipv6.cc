@@ -61,37 +61,28 @@ event_description ipv6_hdr::deserialize(packet &p, logger *log, bool debug)
     if (is_dst_zero())
         return event_description::Evt_IPv6_Dst_Is_Zero;
 
-    opts = std::make_shared<ipv6_opts>();
-    if (!opts)
-        return event_description::Evt_Unknown_Error;
+    opts.ah_hdr.reset();
+    opts.hh.reset();
 
     //
     // we cannot use switch statement here because,
     // we can only parse certain nh options.
     if (static_cast<IPv6_NH_Type>(nh) == IPv6_NH_Type::AH) {
-        opts->ah_hdr = std::make_shared<ipsec_ah_hdr>();
-        if (!opts->ah_hdr)
-            return event_description::Evt_Unknown_Error;
-
-        evt_desc = opts->ah_hdr->deserialize(p, log, debug);
+        evt_desc = opts.ah_hdr.emplace()->deserialize(p, log, debug);
         if (evt_desc != event_description::Evt_Parse_Ok)
             return evt_desc;
 
         //
         // set nh to parse in the caller as IPv6_Encap.
-        nh = opts->ah_hdr->nh;
+        nh = opts.ah_hdr->nh;
     } else if (static_cast<IPv6_NH_Type>(nh) == IPv6_NH_Type::Hop_By_Hop_Opt) {
-        opts->hh = std::make_shared<ipv6_hop_by_hop_hdr>();
-        if (!opts->hh)
-            return event_description::Evt_Out_Of_Memory;
-
-        evt_desc = opts->hh->deserialize(p, log, debug);
+        evt_desc = opts.hh.emplace()->deserialize(p, log, debug);
         if (evt_desc != event_description::Evt_Parse_Ok)
             return evt_desc;
 
         //
         // nh is further used to parse L3 tunnel or an L4 frame.
-        nh = opts->hh->nh;
+        nh = opts.hh->nh;
     }
 
     if (debug) {
@@ -106,37 +97,57 @@ event_description ipv6_hop_by_hop_hdr::deserialize(packet &p, logger *log, bool
     uint8_t type_val;
     uint8_t action;
     uint8_t may_change;
-    uint8_t len_val = 0;
+    uint8_t opt_len;
+    uint32_t val_off;
+    uint32_t len_val;
 
     p.deserialize(nh);
     p.deserialize(len);
 
+    //
+    // length is in 8 byte units, not counting the first 8 bytes
     len_val = ((len + 1) * 8) - 2;
 
-    while (p.remaining_len() < len_val) {
+    opt_area area(p, len_val);
+    if (!area.fits(p, len_val))
+        return event_description::Evt_IPv6_Payload_Truncated;
+
+    while (area.has_more(p)) {
         p.deserialize(type_val);
 
         action = (type_val & 0xC0) >> 6;
         may_change = !!(type_val & 0x20);
         type_val = (type_val & 0x1F);
 
+        if (type_val == static_cast<int>(IPv6_Opt::Pad1))
+            continue;
+
+        if (!area.fits(p, 1))
+            return event_description::Evt_IPv6_Payload_Truncated;
+
+        val_off = p.off;
+        opt_len = p.buf[p.off];
+        if (!area.fits(p, 1 + opt_len))
+            return event_description::Evt_IPv6_Payload_Truncated;
+
         switch (type_val) {
             case static_cast<int>(IPv6_Opt::Router_Alert): {
-                ra = std::make_shared<ipv6_opt_router_alert>();
-                if (!ra)
-                    return event_description::Evt_Out_Of_Memory;
-
-                ra->action = action;
-                ra->may_change = may_change;
-                p.deserialize(ra->len);
-                p.deserialize(ra->router_alert);
+                ipv6_opt_router_alert *r = ra.emplace();
+
+                r->action = action;
+                r->may_change = may_change;
+                p.deserialize(r->len);
+                p.deserialize(r->router_alert);
             } break;
             case static_cast<int>(IPv6_Opt::PadN): {
-                p.off ++;
             } break;
             default:
                 return event_description::Evt_Unknown_Error;
         }
+
+        //
+        // move to the next option
+        p.off = val_off + 1 + opt_len;
     }
 
     return event_description::Evt_Parse_Ok;
@@ -166,10 +177,8 @@ void ipv6_hdr::print(logger *log)
                  dst_addr[4], dst_addr[5], dst_addr[6], dst_addr[7],
                  dst_addr[8], dst_addr[9], dst_addr[10], dst_addr[11],
                  dst_addr[12], dst_addr[13], dst_addr[14], dst_addr[15]);
-    if (opts) {
-        if (opts->ah_hdr)
-            opts->ah_hdr->print(log);
-    }
+    if (opts.ah_hdr)
+        opts.ah_hdr->print(log);
     log->verbose("}\n");
 #endif
 }
@@ -6,11 +6,11 @@
 #ifndef __FW_PROTOCOLS_IPV6_H__
 #define __FW_PROTOCOLS_IPV6_H__
 
-#include <memory>
 #include <packet.h>
 #include <logger.h>
 #include <event_def.h>
 #include <ipsec_ah.h>
+#include <inline_options.h>
 
 namespace firewall {
 
@@ -25,6 +25,7 @@ enum class IPv6_NH_Type {
 };
 
 enum class IPv6_Opt {
+    Pad1 = 0x00,
     Router_Alert = 0x05,
     PadN = 0x01,
 };
@@ -48,7 +49,7 @@ struct ipv6_opt_router_alert {
 struct ipv6_hop_by_hop_hdr {
     uint8_t nh;
     uint8_t len;
-    std::shared_ptr<ipv6_opt_router_alert> ra;
+    inline_opt<ipv6_opt_router_alert> ra;
 
     event_description deserialize(packet &p, logger *log, bool debug);
     void print(logger *log)
@@ -67,11 +68,10 @@ struct ipv6_hop_by_hop_hdr {
 };
 
 struct ipv6_opts {
-    std::shared_ptr<ipv6_hop_by_hop_hdr> hh;
-    std::shared_ptr<ipsec_ah_hdr> ah_hdr;
+    inline_opt<ipv6_hop_by_hop_hdr> hh;
+    inline_opt<ipsec_ah_hdr> ah_hdr;
 
-    explicit ipv6_opts() :
-                hh(nullptr) { }
+    explicit ipv6_opts() { }
     ~ipv6_opts() { }
 
     event_description deserialize(packet &p, logger *log, bool debug);
@@ -97,7 +97,7 @@ struct ipv6_hdr {
     uint8_t src_addr[IPV6_ADDR_LEN];
     uint8_t dst_addr[IPV6_ADDR_LEN];
 
-    std::shared_ptr<ipv6_opts> opts;
+    ipv6_opts opts;
 
     int serialize(packet &p);
     event_description deserialize(packet &p, logger *log, bool debug = false);
@@ -109,7 +109,7 @@ struct ipv6_hdr {
     }
 
     private:
-        const int hdrlen_ = 40;
+        static constexpr int hdrlen_ = 40;
 
         inline bool is_zero_addr(uint8_t *addr)
         {
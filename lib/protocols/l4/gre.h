@@ -50,7 +50,7 @@ struct gre_hdr {
     }
 
     private:
-        const int min_hdr_len_ = 4;
+        static constexpr int min_hdr_len_ = 4;
 };
 
 }
@@ -5,6 +5,7 @@
 */
 #include <cstring>
 #include <icmp.h>
+#include <checksum.h>
 #include <tunables.h>
 
 namespace firewall {
@@ -57,20 +58,10 @@ int icmp_hdr::serialize(packet &p)
 
 int icmp_hdr::validate_checksum(const packet &p)
 {
-    uint32_t i = 0;
-    uint32_t csum = 0;
-    uint32_t carry = 0;
-
     //
     // ICMP checksum is calculated from the header till the
     // end of the packet.
-    for (i = start_off; i < end_off; i += 2) {
-        csum += ((p.buf[i + 1] << 8) | p.buf[i]);
-    }
-    carry = (csum & 0XFF0000) >> 16;
-    csum = csum & 0x00FFFF;
-
-    if ((csum + carry) == 0xFFFF) {
+    if (csum_fold(csum_partial(p.buf + start_off, end_off - start_off, 0)) == 0xFFFF) {
         return 0;
     }
 
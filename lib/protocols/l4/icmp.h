@@ -165,7 +165,7 @@ struct icmp_address_mask {
     void print(const std::string str, logger *log);
 
     private:
-        const int len_ = 8;
+        static constexpr int len_ = 8;
 };
 
 /**
@@ -234,7 +234,7 @@ struct icmp_hdr {
     int generate_checksum(const packet &p);
 
     private:
-        const int icmp_hdr_len_ = 4;
+        static constexpr int icmp_hdr_len_ = 4;
 };
 
 }
@@ -193,7 +193,7 @@ struct icmp6_mcast_record {
     }
 
     private:
-        const int len_ = 20;
+        static constexpr int len_ = 20;
 };
 
 struct icmp6_mcast_listener_report_msg_v2 {
@@ -217,7 +217,7 @@ struct icmp6_mcast_listener_report_msg_v2 {
     }
 
     private:
-        const int len_ = 20;
+        static constexpr int len_ = 20;
 };
 
 struct icmp6_echo_req {
@@ -56,7 +56,7 @@ event_description tcp_hdr::deserialize(packet &p, logger *log, bool debug)
 
     //
     // check for TCP invalid flag bits
-    evt_des = check_flags();
+    evt_des = check_flags(byte_1, flags);
     if (evt_des != event_description::Evt_Parse_Ok)
         return evt_des;
 
@@ -65,15 +65,12 @@ event_description tcp_hdr::deserialize(packet &p, logger *log, bool debug)
     p.deserialize(urg_ptr);
 
     // check for possible TCP options
+    opts.reset();
     if (hdr_len > tcp_hdr_len_no_off_) {
-        opts = std::make_shared<tcp_hdr_options>();
-        if (!opts)
-            return event_description::Evt_Out_Of_Memory;
-
-        evt_des = opts->deserialize(p,
-                                    hdr_len - tcp_hdr_len_no_off_,
-                                    log,
-                                    debug);
+        evt_des = opts.emplace()->deserialize(p,
+                                              hdr_len - tcp_hdr_len_no_off_,
+                                              log,
+                                              debug);
         if (evt_des != event_description::Evt_Parse_Ok) {
             return evt_des;
         }
@@ -144,33 +141,17 @@ void tcp_hdr::print(logger *log) const noexcept
 #endif
 }
 
-event_description tcp_hdr::check_flags()
+event_description tcp_hdr::check_flags(uint8_t byte_1, uint8_t flags)
 {
-    if (ecn &&
-        cwr &&
-        ecn_echo &&
-        urg &&
-        ack &&
-        psh &&
-        rst &&
-        syn &&
-        fin) {
+    if ((byte_1 & 0x01) && (flags == 0xFF)) {
         return event_description::Evt_Tcp_Flags_All_Set;
     }
-    if ((ecn == 0) &&
-        (cwr == 0) &&
-        (ecn_echo == 0) &&
-        (urg == 0) &&
-        (ack == 0) &&
-        (psh == 0) &&
-        (rst == 0) &&
-        (syn == 0) &&
-        (fin == 0)) {
+    if (!(byte_1 & 0x01) && (flags == 0)) {
         // NULL scan in progress
         return event_description::Evt_Tcp_Flags_None_Set;
     }
 
-    if ((syn == 1) && (fin == 1)) {
+    if ((flags & 0x03) == 0x03) {
         // Both SYN and FIN are set
         return event_description::Evt_Tcp_Flags_SYN_FIN_Set;
     }
@@ -183,11 +164,11 @@ event_description tcp_hdr_options::deserialize(packet &p,
                                                logger *log,
                                                bool debug)
 {
-    uint32_t len = p.off + rem_len;
+    opt_area area(p, rem_len);
 
     end_of_opt = false;
 
-    while (p.off < len) {
+    while (area.has_more(p)) {
         if (end_of_opt)
             break;
 
@@ -6,8 +6,9 @@
 #ifndef __FW_LIB_PROTOCOLS_L4_TCP_H__
 #define __FW_LIB_PROTOCOLS_L4_TCP_H__
 
-#include <memory>
+#include <vector>
 #include <packet.h>
+#include <inline_options.h>
 #include <event_def.h>
 #include <logger.h>
 
@@ -29,7 +30,7 @@ struct tcp_hdr_opt_mss {
     uint8_t hdr_len() { return len_; }
 
     private:
-        const uint8_t len_ = 4;
+        static constexpr uint8_t len_ = 4;
 };
 
 struct tcp_hdr_opt_sack_permitted {
@@ -43,7 +44,7 @@ struct tcp_hdr_opt_timestamp {
 
     bool len_in_range() { return len == len_; }
     private:
-        const int len_ = 10;
+        static constexpr int len_ = 10;
 };
 
 struct tcp_hdr_opt_win_scale {
@@ -57,7 +58,7 @@ struct tcp_hdr_opt_win_scale {
     */
     bool len_in_range() { return len == len_; }
     private:
-        const int len_ = 3;
+        static constexpr int len_ = 3;
 };
 
 struct tcp_hdr_options_flags {
@@ -132,11 +133,10 @@ struct tcp_hdr {
     uint16_t urg_ptr;
     std::vector<char> rst_reason;
 
-    // if options are set, this pointer is valid
-    std::shared_ptr<tcp_hdr_options> opts;
+    // if options are set, this slot is valid
+    inline_opt<tcp_hdr_options> opts;
 
-    explicit tcp_hdr() noexcept :
-            opts(nullptr) { }
+    explicit tcp_hdr() noexcept { }
     ~tcp_hdr() { }
 
     int serialize(packet &p);
@@ -147,7 +147,7 @@ struct tcp_hdr {
      * @return true if tcp has options.
      *         false if tcp does not have options.
     */
-    bool has_opts() const noexcept { return opts != nullptr; }
+    bool has_opts() const noexcept { return static_cast<bool>(opts); }
     /**
      * @brief - deserialize TCP header.
      *
@@ -166,9 +166,20 @@ struct tcp_hdr {
     */
     void print(logger *log) const noexcept;
 
+    /**
+     * @brief - check the TCP flags.
+     *
+     * Shared by the full decode and the header views.
+     *
+     * @param [in] byte_1 - data offset byte, the low bit is ECN
+     * @param [in] flags - flags byte
+     *
+     * @return Evt_Parse_Ok if the flags are valid.
+    */
+    static event_description check_flags(uint8_t byte_1, uint8_t flags);
+
     private:
-        event_description check_flags();
-        const int tcp_hdr_len_no_off_ = 20;
+        static constexpr int tcp_hdr_len_no_off_ = 20;
 };
 
 }
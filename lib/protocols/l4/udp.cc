@@ -60,56 +60,4 @@ void udp_hdr::print(logger *log)
 #endif
 }
 
-int udp_hdr::validate_checksum(packet &p,
-                               uint32_t src_ipaddr, uint32_t dst_ipaddr,
-                               uint16_t protocol)
-{
-    uint32_t checksum = 0;
-    uint32_t carry = 0;
-    uint32_t i = 0;
-    uint16_t *ptr;
-
-    ipv4_pseudo_hdr psh;
-
-    std::memset(&psh, 0, sizeof(psh));
-
-    psh.src_ipaddr = src_ipaddr;
-    psh.dst_ipaddr = dst_ipaddr;
-    psh.zero = 0;
-    psh.protocol = static_cast<uint8_t>(protocols_types::Protocol_Udp);
-    psh.len = htons(length);
-
-    ptr = psh.arr;
-
-    //src_ipaddr = ntohl(src_ipaddr);
-    //dst_ipaddr = ntohl(dst_ipaddr);
-    //protocol = ntohs(protocol);
-
-    checksum += ptr[0];
-    checksum += ptr[1];
-    checksum += ptr[2];
-    checksum += ptr[3];
-    checksum += ptr[4];
-    checksum += ptr[5];
-
-    uint32_t len = p.buf_len;
-
-    if (p.buf_len % 2 != 0) {
-        len = p.buf_len - 1;
-    }
-
-    for (i = start_off; i < len; i ++) {
-        checksum += (p.buf[i + 1] << 8) + p.buf[i];
-    }
-
-    if (p.buf_len % 2 != 0) {
-        checksum += (p.buf[len] << 8);
-    }
-
-    carry = (checksum & 0xFFFF0000) >> 16;
-    checksum = ((checksum & 0xFFFF) + carry);
-
-    return ~checksum;
-}
-
 }
@@ -12,15 +12,6 @@
 
 namespace firewall {
 
-union ipv4_pseudo_hdr {
-    uint32_t src_ipaddr;
-    uint32_t dst_ipaddr;
-    uint8_t zero;
-    uint8_t protocol;
-    uint16_t len;
-    uint16_t arr[6];
-};
-
 /**
  * @brief - Implements udp serialize and deserialize.
 */
@@ -42,9 +33,6 @@ struct udp_hdr {
      * @param [in] debug - debug flag.
     */
     event_description deserialize(packet &p, logger *log, bool debug = false);
-    int validate_checksum(packet &p,
-                          uint32_t src_ipaddr, uint32_t dst_ipaddr,
-                          uint16_t protocol);
 
     /**
      * @brief - print the udp packet.
@@ -56,7 +44,7 @@ struct udp_hdr {
     private:
         //
         // src_port (2) + dst_port (2) + len (2) + checksum (2)
-        const uint16_t udp_hdrlen_ = 8;
+        static constexpr uint16_t udp_hdrlen_ = 8;
 };
 
 }
@@ -89,8 +89,8 @@ struct vrrp_hdr {
     }
 
     private:
-        const int min_hdr_len_ = 1;
-        const int min_hdr_len_v2_ = 11;
+        static constexpr int min_hdr_len_ = 1;
+        static constexpr int min_hdr_len_v2_ = 11;
 };
 
 }
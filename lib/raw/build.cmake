@@ -3,7 +3,8 @@ project(firewall)
 cmake_minimum_required(VERSION 3.22)
 
 SET(LIB_SOURCES_RAW
-	./lib/raw/raw_socket.cc)
+	./lib/raw/raw_socket.cc
+	./lib/raw/xdp_socket.cc)
 
 include_directories(./lib/raw/)
 
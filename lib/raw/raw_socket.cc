@@ -13,11 +13,25 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <poll.h>
 #include <net/if.h>
 #include <netinet/ether.h>
 #include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <linux/errqueue.h>
 #include <raw_socket.h>
 
+//
+// older kernel headers, asm-generic values
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+#ifndef SO_BUSY_POLL_BUDGET
+#define SO_BUSY_POLL_BUDGET 70
+#endif
+
 #define ERR_ON_SYSCALL(__res, __match, __str) { \
     if (__res < __match) { \
         throw std::runtime_error(__str); \
@@ -27,7 +41,14 @@
 namespace firewall {
 
 raw_socket::raw_socket(const std::string devname, uint16_t ethertype):
-                                  dev_(devname)
+                                  dev_(devname),
+                                  ring_(nullptr),
+                                  ring_len_(0),
+                                  block_size_(0),
+                                  block_nr_(0),
+                                  cur_block_(0),
+                                  cur_frame_(nullptr),
+                                  frames_left_(0)
 {
     int ret;
 
@@ -89,10 +110,40 @@ raw_socket::raw_socket(const std::string devname, uint16_t ethertype):
 
     ret = bind(fd_, (struct sockaddr *)&lladdr, sizeof(lladdr));
     ERR_ON_SYSCALL(ret, 0, "failed to bind in");
+
+    //
+    // checksum offload status and the stripped vlan tag of each frame.
+    int aux = 1;
+
+    ret = setsockopt(fd_, SOL_PACKET, PACKET_AUXDATA, &aux, sizeof(aux));
+    ERR_ON_SYSCALL(ret, 0, "failed to PACKET_AUXDATA");
+}
+
+//
+// convert the TP_STATUS bits and vlan tag of the kernel to the rx info
+static inline void raw_set_rx_info(raw_rx_info &info,
+                                   uint32_t status,
+                                   uint16_t vlan_tci,
+                                   uint16_t vlan_tpid)
+{
+    info.csum_not_ready = !!(status & TP_STATUS_CSUMNOTREADY);
+    info.csum_valid = !!(status & TP_STATUS_CSUM_VALID);
+    info.vlan_valid = !!(status & TP_STATUS_VLAN_VALID);
+    info.vlan_tci = info.vlan_valid ? vlan_tci : 0;
+    info.vlan_tpid = 0;
+
+    if (info.vlan_valid) {
+        info.vlan_tpid = (status & TP_STATUS_VLAN_TPID_VALID) ? vlan_tpid : ETH_P_8021Q;
+    }
 }
 
 raw_socket::~raw_socket() 
 {   
+    if (ring_ != nullptr) {
+        munmap(ring_, ring_len_);
+        ring_ = nullptr;
+    }
+
     if (fd_ > 0) {
         int ret;
         struct ifreq req;
@@ -233,5 +284,326 @@ int raw_socket::recv_msg(uint8_t *mac, uint8_t *data, size_t data_size) noexcept
     return ret;
 }
 
+int raw_socket::recv_msg(uint8_t *data, size_t data_len, raw_rx_info &info) noexcept
+{
+    return recv_msg(data, data_len, nullptr, 0, info);
+}
+
+int raw_socket::recv_msg(uint8_t *data, size_t data_len,
+                         uint8_t *spill, size_t spill_len,
+                         raw_rx_info &info) noexcept
+{
+    union {
+        struct cmsghdr cmsg;
+        uint8_t buf[CMSG_SPACE(sizeof(struct tpacket_auxdata)) +
+                    CMSG_SPACE(sizeof(struct scm_timestamping))];
+    } ctrl;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov[2];
+    int ret;
+
+    iov[0].iov_base = data;
+    iov[0].iov_len = data_len;
+    iov[1].iov_base = spill;
+    iov[1].iov_len = spill_len;
+
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (spill != nullptr) ? 2 : 1;
+    msg.msg_control = ctrl.buf;
+    msg.msg_controllen = sizeof(ctrl.buf);
+
+    ret = recvmsg(fd_, &msg, 0);
+    if (ret < 0) {
+        return -1;
+    }
+
+    raw_set_rx_info(info, 0, 0, 0);
+    info.ts.tv_sec = 0;
+    info.ts.tv_nsec = 0;
+
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        struct tpacket_auxdata aux;
+
+        //
+        // ts[0] is the software and ts[2] the raw hardware timestamp,
+        // hardware one is preferred when the NIC stamped the frame.
+        if ((cmsg->cmsg_level == SOL_SOCKET) &&
+            (cmsg->cmsg_type == SCM_TIMESTAMPING) &&
+            (cmsg->cmsg_len >= CMSG_LEN(sizeof(struct scm_timestamping)))) {
+            struct scm_timestamping tss;
+
+            std::memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+            if (tss.ts[2].tv_sec || tss.ts[2].tv_nsec) {
+                info.ts = tss.ts[2];
+            } else {
+                info.ts = tss.ts[0];
+            }
+            continue;
+        }
+
+        if ((cmsg->cmsg_level != SOL_PACKET) ||
+            (cmsg->cmsg_type != PACKET_AUXDATA) ||
+            (cmsg->cmsg_len < CMSG_LEN(sizeof(aux)))) {
+            continue;
+        }
+
+        std::memcpy(&aux, CMSG_DATA(cmsg), sizeof(aux));
+        raw_set_rx_info(info, aux.tp_status, aux.tp_vlan_tci, aux.tp_vlan_tpid);
+    }
+
+    return ret;
+}
+
+int raw_socket::join_fanout(uint16_t group_id, Raw_Fanout_Mode mode) noexcept
+{
+    int fanout_type;
+    int fanout_arg;
+
+    switch (mode) {
+        case Raw_Fanout_Mode::Hash:
+            //
+            // defrag so that all fragments of a datagram hash to the same socket
+            fanout_type = PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG;
+        break;
+        case Raw_Fanout_Mode::Cpu:
+            fanout_type = PACKET_FANOUT_CPU;
+        break;
+        case Raw_Fanout_Mode::Rollover:
+            fanout_type = PACKET_FANOUT_ROLLOVER;
+        break;
+        default:
+            return -1;
+    }
+
+    fanout_arg = group_id | (fanout_type << 16);
+
+    return setsockopt(fd_, SOL_PACKET, PACKET_FANOUT, &fanout_arg, sizeof(fanout_arg));
+}
+
+int raw_socket::enable_timestamps(Raw_Timestamp_Source src) noexcept
+{
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    int ret;
+
+    if (src == Raw_Timestamp_Source::Hardware) {
+        struct hwtstamp_config hw_cfg;
+        struct ifreq req;
+        int ring_flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+
+        //
+        // ask the NIC to stamp every received frame
+        std::memset(&hw_cfg, 0, sizeof(hw_cfg));
+        hw_cfg.tx_type = HWTSTAMP_TX_OFF;
+        hw_cfg.rx_filter = HWTSTAMP_FILTER_ALL;
+
+        std::memset(&req, 0, sizeof(req));
+        strncpy(req.ifr_name, dev_.c_str(), sizeof(req.ifr_name) - 1);
+        req.ifr_data = (char *)&hw_cfg;
+
+        ret = ioctl(fd_, SIOCSHWTSTAMP, &req);
+        if (ret < 0) {
+            return -1;
+        }
+
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+
+        //
+        // rx ring frames carry the hardware timestamp in the frame header
+        ret = setsockopt(fd_, SOL_PACKET, PACKET_TIMESTAMP, &ring_flags, sizeof(ring_flags));
+        if (ret < 0) {
+            return -1;
+        }
+    }
+
+    return setsockopt(fd_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
 }
 
+//
+// preferred busy polling keeps the device irqs masked while the
+// application polls, so that the frames are not also taken by softirq.
+int socket_enable_busy_poll(int fd, uint32_t usecs, uint32_t budget) noexcept
+{
+    int val;
+    int ret;
+
+    val = usecs;
+    ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val));
+    if (ret < 0) {
+        return -1;
+    }
+
+    val = 1;
+    ret = setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &val, sizeof(val));
+    if (ret < 0) {
+        return -1;
+    }
+
+    if (budget > 0) {
+        val = budget;
+        ret = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &val, sizeof(val));
+        if (ret < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int raw_socket::enable_busy_poll(uint32_t usecs, uint32_t budget) noexcept
+{
+    return socket_enable_busy_poll(fd_, usecs, budget);
+}
+
+int raw_socket::setup_rx_ring(uint32_t block_size,
+                              uint32_t frame_count,
+                              uint32_t block_timeout_ms) noexcept
+{
+    struct tpacket_req3 req;
+    int version = TPACKET_V3;
+    long page_size = sysconf(_SC_PAGESIZE);
+    uint32_t frames_per_block;
+    int ret;
+
+    //
+    // block must hold at least one frame and be page aligned.
+    if ((block_size < RAW_SOCKET_RING_FRAME_SIZE) ||
+        (block_size % page_size != 0) ||
+        (frame_count == 0)) {
+        return -1;
+    }
+
+    ret = setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+    if (ret < 0) {
+        return -1;
+    }
+
+    frames_per_block = block_size / RAW_SOCKET_RING_FRAME_SIZE;
+
+    std::memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size;
+    req.tp_block_nr = (frame_count + frames_per_block - 1) / frames_per_block;
+    req.tp_frame_size = RAW_SOCKET_RING_FRAME_SIZE;
+    req.tp_frame_nr = req.tp_block_nr * frames_per_block;
+    req.tp_retire_blk_tov = block_timeout_ms;
+    req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+
+    ret = setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+    if (ret < 0) {
+        version = TPACKET_V1;
+        setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+        return -1;
+    }
+
+    ring_len_ = (size_t)req.tp_block_size * req.tp_block_nr;
+    ring_ = (uint8_t *)mmap(nullptr, ring_len_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_LOCKED | MAP_POPULATE, fd_, 0);
+    if (ring_ == MAP_FAILED) {
+        //
+        // MAP_LOCKED fails when RLIMIT_MEMLOCK is low, retry without it.
+        ring_ = (uint8_t *)mmap(nullptr, ring_len_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, fd_, 0);
+        if (ring_ == MAP_FAILED) {
+            ring_ = nullptr;
+            ring_len_ = 0;
+
+            //
+            // the ring is still registered and the kernel would keep
+            // filling it, so the socket could not fall back to recvfrom.
+            // Free it with an empty request and go back to TPACKET_V1.
+            std::memset(&req, 0, sizeof(req));
+            setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+            version = TPACKET_V1;
+            setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+            return -1;
+        }
+    }
+
+    block_size_ = req.tp_block_size;
+    block_nr_ = req.tp_block_nr;
+    cur_block_ = 0;
+    cur_frame_ = nullptr;
+    frames_left_ = 0;
+
+    return 0;
+}
+
+void raw_socket::release_block() noexcept
+{
+    struct tpacket_block_desc *desc;
+
+    desc = (struct tpacket_block_desc *)(ring_ + (size_t)cur_block_ * block_size_);
+
+    //
+    // hand over the block back to the kernel
+    __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+
+    cur_block_ = (cur_block_ + 1) % block_nr_;
+    cur_frame_ = nullptr;
+}
+
+int raw_socket::recv_ring(raw_frame &frame, int timeout_ms) noexcept
+{
+    struct tpacket_block_desc *desc;
+    struct tpacket3_hdr *hdr;
+
+    //
+    // current block is fully walked, give it back and move to the next one
+    if ((cur_frame_ != nullptr) && (frames_left_ == 0)) {
+        release_block();
+    }
+
+    if (cur_frame_ == nullptr) {
+        desc = (struct tpacket_block_desc *)(ring_ + (size_t)cur_block_ * block_size_);
+
+        //
+        // poll only if the kernel has not yet retired the block to us
+        if ((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+                                                TP_STATUS_USER) == 0) {
+            struct pollfd pfd;
+            int ret;
+
+            pfd.fd = fd_;
+            pfd.events = POLLIN | POLLERR;
+            pfd.revents = 0;
+
+            ret = poll(&pfd, 1, timeout_ms);
+            if (ret < 0) {
+                return (errno == EINTR) ? 0 : -1;
+            }
+
+            if ((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+                                                TP_STATUS_USER) == 0) {
+                return 0;
+            }
+        }
+
+        frames_left_ = desc->hdr.bh1.num_pkts;
+        cur_frame_ = (uint8_t *)desc + desc->hdr.bh1.offset_to_first_pkt;
+
+        //
+        // an empty block is retired on timeout
+        if (frames_left_ == 0) {
+            release_block();
+            return 0;
+        }
+    }
+
+    hdr = (struct tpacket3_hdr *)cur_frame_;
+
+    frame.data = cur_frame_ + hdr->tp_mac;
+    frame.len = hdr->tp_snaplen;
+    frame.orig_len = hdr->tp_len;
+    raw_set_rx_info(frame.info, hdr->tp_status,
+                    hdr->hv1.tp_vlan_tci, hdr->hv1.tp_vlan_tpid);
+    frame.info.ts.tv_sec = hdr->tp_sec;
+    frame.info.ts.tv_nsec = hdr->tp_nsec;
+
+    frames_left_ --;
+    cur_frame_ += hdr->tp_next_offset;
+
+    return frame.len;
+}
+
+}
@@ -9,9 +9,87 @@
 
 #include <cstdint>
 #include <string>
+#include <time.h>
 
 namespace firewall {
 
+//
+// nominal frame size used to size the TPACKET_V3 rx ring.
+//
+// TPACKET_V3 packs variable length frames into each block, this value is
+// only used to convert the configured frame count into number of blocks.
+#define RAW_SOCKET_RING_FRAME_SIZE 2048
+
+/**
+ * @brief - Defines PACKET_FANOUT load balancing modes.
+ */
+enum class Raw_Fanout_Mode {
+    // flow hash, all frames of a flow go to the same socket
+    Hash,
+    // frames are steered to the socket of the receiving cpu
+    Cpu,
+    // fill a socket until it backs up and then move to the next
+    Rollover,
+};
+
+/**
+ * @brief - Defines the source of the receive timestamps.
+ */
+enum class Raw_Timestamp_Source {
+    // kernel timestamp taken when the frame enters the stack
+    Software,
+    // NIC timestamp, falls back to the kernel timestamp if the frame has none
+    Hardware,
+};
+
+/**
+ * @brief - Defines receive metadata of a frame.
+ *
+ * Filled from PACKET_AUXDATA with recvfrom, or from the frame header
+ * with the rx ring.
+ */
+struct raw_rx_info {
+    // checksum is offloaded and not yet computed (TP_STATUS_CSUMNOTREADY)
+    bool csum_not_ready;
+    // checksum is verified by the NIC or the kernel (TP_STATUS_CSUM_VALID)
+    bool csum_valid;
+    // vlan tag is stripped into vlan_tci and vlan_tpid (TP_STATUS_VLAN_VALID)
+    bool vlan_valid;
+    uint16_t vlan_tci;
+    uint16_t vlan_tpid;
+    // receive timestamp (CLOCK_REALTIME), zero if the kernel gave none
+    struct timespec ts;
+};
+
+/**
+ * @brief - Defines a frame received over the rx ring.
+ *
+ * data points into the ring memory and is valid until the next call
+ * to recv_ring.
+ */
+struct raw_frame {
+    uint8_t *data;
+    // captured length
+    uint32_t len;
+    // length of the frame on the wire
+    uint32_t orig_len;
+    raw_rx_info info;
+};
+
+/**
+ * @brief - Set SO_BUSY_POLL, SO_PREFER_BUSY_POLL and SO_BUSY_POLL_BUDGET on a socket.
+ *
+ * Shared by the raw and AF_XDP sockets.
+ *
+ * @param [in] - fd Socket.
+ * @param [in] - usecs Time to busy poll.
+ * @param [in] - budget Frames processed per busy poll, 0 for the kernel default.
+ *
+ * @return 0 on success.
+ * @return -1 on failure.
+ */
+int socket_enable_busy_poll(int fd, uint32_t usecs, uint32_t budget) noexcept;
+
 /**
  * @brief - Implements raw socket
  */
@@ -35,6 +113,52 @@ class raw_socket {
          */
         int get_socket() const noexcept;
 
+        /**
+         * @brief - Get interface index of the bound device.
+         *
+         * @return interface index.
+         */
+        int get_ifindex() const noexcept { return ifindex_; }
+
+        /**
+         * @brief - Join a PACKET_FANOUT group.
+         *
+         * All sockets on the same device joining the same group id share
+         * the incoming frames according to the mode.
+         *
+         * @param [in] - group_id Fanout group id.
+         * @param [in] - mode Fanout mode.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int join_fanout(uint16_t group_id, Raw_Fanout_Mode mode) noexcept;
+
+        /**
+         * @brief - Enable receive timestamps.
+         *
+         * Timestamps are reported through recv_msg and recv_ring. For
+         * hardware timestamps the NIC is set to stamp every frame, the NIC
+         * clock must be synced to the system clock (phc2sys).
+         *
+         * @param [in] - src Timestamp source.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int enable_timestamps(Raw_Timestamp_Source src) noexcept;
+
+        /**
+         * @brief - Busy poll the device queue when the socket has no frames.
+         *
+         * @param [in] - usecs Time to busy poll in a blocking receive or poll.
+         * @param [in] - budget Frames processed per busy poll, 0 for the kernel default.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int enable_busy_poll(uint32_t usecs, uint32_t budget) noexcept;
+
         int send_msg(uint8_t *mac, uint16_t ethertype, uint8_t *data, size_t data_len) noexcept;
         /**
          * @brief - Send message via the raw socket.
@@ -60,11 +184,94 @@ class raw_socket {
          * @return -1 on failure.
          */
         int recv_msg(uint8_t *mac, uint8_t *data, size_t data_len) noexcept;
+
+        /**
+         * @brief - Receive message along with its receive metadata.
+         *
+         * @param [out] - data Receive buffer.
+         * @param [in] - data_len Length of received buffer.
+         * @param [out] - info Receive metadata from PACKET_AUXDATA and
+         *                     the receive timestamp.
+         *
+         * @return Length of received data on success.
+         * @return -1 on failure.
+         */
+        int recv_msg(uint8_t *data, size_t data_len, raw_rx_info &info) noexcept;
+
+        /**
+         * @brief - Receive message into two buffers along with its receive metadata.
+         *
+         * The frame fills data first, the rest of it goes into spill.
+         *
+         * @param [out] - data Receive buffer.
+         * @param [in] - data_len Length of received buffer.
+         * @param [out] - spill Buffer for the part of the frame that does not fit data.
+         * @param [in] - spill_len Length of the spill buffer.
+         * @param [out] - info Receive metadata from PACKET_AUXDATA and
+         *                     the receive timestamp.
+         *
+         * @return Length of received data on success.
+         * @return -1 on failure.
+         */
+        int recv_msg(uint8_t *data, size_t data_len,
+                     uint8_t *spill, size_t spill_len,
+                     raw_rx_info &info) noexcept;
+
+        /**
+         * @brief - Setup a TPACKET_V3 memory mapped rx ring.
+         *
+         * @param [in] - block_size Size of each block in bytes (multiple of page size).
+         * @param [in] - frame_count Number of frames the ring must hold.
+         * @param [in] - block_timeout_ms Time after which kernel retires a partially filled block.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int setup_rx_ring(uint32_t block_size,
+                          uint32_t frame_count,
+                          uint32_t block_timeout_ms) noexcept;
+
+        /**
+         * @brief - Receive next frame from the rx ring.
+         *
+         * The frames of a block are walked without any syscall, the socket
+         * is polled only when the kernel has not yet handed over the next block.
+         *
+         * @param [out] - frame Received frame.
+         * @param [in] - timeout_ms Poll timeout if no block is ready.
+         *
+         * @return Length of received frame on success.
+         * @return 0 on timeout.
+         * @return -1 on failure.
+         */
+        int recv_ring(raw_frame &frame, int timeout_ms) noexcept;
+
+        /**
+         * @brief - Check if rx ring is in use.
+         *
+         * @return true if rx ring is setup.
+         */
+        bool has_rx_ring() const noexcept { return ring_ != nullptr; }
+
     private:
+        void release_block() noexcept;
+
         int fd_;
         std::string dev_;
         int ifindex_;
         uint8_t devmac_[6];
+
+        //
+        // TPACKET_V3 rx ring
+        uint8_t *ring_;
+        size_t ring_len_;
+        uint32_t block_size_;
+        uint32_t block_nr_;
+        // current block being walked
+        uint32_t cur_block_;
+        // next frame in the current block and frames left in it
+        uint8_t *cur_frame_;
+        uint32_t frames_left_;
 };
 
 }
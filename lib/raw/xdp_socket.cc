@@ -0,0 +1,429 @@
+/**
+ * @brief - Implements AF_XDP socket.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#include <cstring>
+#include <stdexcept>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <xdp_socket.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+namespace firewall {
+
+static int sys_bpf(int cmd, union bpf_attr *attr)
+{
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+xdp_program::xdp_program(const std::string dev, uint32_t n_queues) :
+                            map_fd_(-1),
+                            prog_fd_(-1),
+                            link_fd_(-1),
+                            skb_mode_(false)
+{
+    union bpf_attr attr;
+    int ret;
+
+    ifindex_ = if_nametoindex(dev.c_str());
+    if (ifindex_ == 0) {
+        throw std::runtime_error("failed to get interface index");
+    }
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = n_queues;
+
+    map_fd_ = sys_bpf(BPF_MAP_CREATE, &attr);
+    if (map_fd_ < 0) {
+        throw std::runtime_error("failed to create xskmap");
+    }
+
+    ret = load_prog();
+    if (ret < 0) {
+        close(map_fd_);
+        throw std::runtime_error("failed to load xdp program");
+    }
+
+    //
+    // native mode first, generic mode works on any driver.
+    ret = attach(XDP_FLAGS_DRV_MODE);
+    if (ret < 0) {
+        ret = attach(XDP_FLAGS_SKB_MODE);
+        if (ret < 0) {
+            close(prog_fd_);
+            close(map_fd_);
+            throw std::runtime_error("failed to attach xdp program");
+        }
+        skb_mode_ = true;
+    }
+}
+
+xdp_program::~xdp_program()
+{
+    //
+    // closing the link detaches the program from the interface
+    if (link_fd_ >= 0) {
+        close(link_fd_);
+    }
+    if (prog_fd_ >= 0) {
+        close(prog_fd_);
+    }
+    if (map_fd_ >= 0) {
+        close(map_fd_);
+    }
+}
+
+int xdp_program::load_prog() noexcept
+{
+    //
+    // return bpf_redirect_map(&xskmap, ctx->rx_queue_index, XDP_PASS);
+    struct bpf_insn insns[] = {
+        { BPF_LDX | BPF_W | BPF_MEM, BPF_REG_2, BPF_REG_1,
+          offsetof(struct xdp_md, rx_queue_index), 0 },
+        { BPF_LD | BPF_DW | BPF_IMM, BPF_REG_1, BPF_PSEUDO_MAP_FD, 0, map_fd_ },
+        { 0, 0, 0, 0, 0 },
+        { BPF_ALU64 | BPF_MOV | BPF_K, BPF_REG_3, 0, 0, XDP_PASS },
+        { BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map },
+        { BPF_JMP | BPF_EXIT, 0, 0, 0, 0 },
+    };
+    const char license[] = "GPL";
+    union bpf_attr attr;
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uint64_t)(uintptr_t)insns;
+    attr.insn_cnt = sizeof(insns) / sizeof(insns[0]);
+    attr.license = (uint64_t)(uintptr_t)license;
+    attr.expected_attach_type = BPF_XDP;
+
+    prog_fd_ = sys_bpf(BPF_PROG_LOAD, &attr);
+
+    return prog_fd_ < 0 ? -1 : 0;
+}
+
+int xdp_program::attach(uint32_t xdp_flags) noexcept
+{
+    union bpf_attr attr;
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = prog_fd_;
+    attr.link_create.target_ifindex = ifindex_;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = xdp_flags;
+
+    link_fd_ = sys_bpf(BPF_LINK_CREATE, &attr);
+
+    return link_fd_ < 0 ? -1 : 0;
+}
+
+int xdp_program::add_socket(uint32_t queue_id, int xsk_fd) noexcept
+{
+    union bpf_attr attr;
+    uint32_t val = xsk_fd;
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = map_fd_;
+    attr.key = (uint64_t)(uintptr_t)&queue_id;
+    attr.value = (uint64_t)(uintptr_t)&val;
+    attr.flags = BPF_ANY;
+
+    return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0 ? -1 : 0;
+}
+
+static inline bool is_power_of_2(uint32_t val)
+{
+    return (val != 0) && ((val & (val - 1)) == 0);
+}
+
+xdp_socket::xdp_socket(const std::string dev,
+                       uint32_t queue_id,
+                       uint32_t frame_count,
+                       uint32_t frame_size,
+                       bool zero_copy) :
+                            fd_(-1),
+                            dev_(dev),
+                            queue_id_(queue_id),
+                            zero_copy_(false),
+                            umem_(nullptr),
+                            umem_len_(0),
+                            frame_size_(frame_size)
+{
+    struct xdp_mmap_offsets off;
+    struct xdp_umem_reg reg;
+    socklen_t optlen;
+    uint32_t idx;
+    int ret;
+
+    //
+    // ring sizes must be power of 2, frames must be power of 2 in aligned mode.
+    if (!is_power_of_2(frame_count) || !is_power_of_2(frame_size)) {
+        throw std::runtime_error("xdp frame count and size must be power of 2");
+    }
+
+    ifindex_ = if_nametoindex(dev.c_str());
+    if (ifindex_ == 0) {
+        throw std::runtime_error("failed to get interface index");
+    }
+
+    fd_ = socket(AF_XDP, SOCK_RAW, 0);
+    if (fd_ < 0) {
+        throw std::runtime_error("failed to socket");
+    }
+
+    umem_len_ = (size_t)frame_count * frame_size;
+    umem_ = (uint8_t *)mmap(nullptr, umem_len_, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (umem_ == MAP_FAILED) {
+        umem_ = nullptr;
+        cleanup();
+        throw std::runtime_error("failed to allocate umem");
+    }
+
+    std::memset(&reg, 0, sizeof(reg));
+    reg.addr = (uint64_t)(uintptr_t)umem_;
+    reg.len = umem_len_;
+    reg.chunk_size = frame_size;
+    reg.headroom = 0;
+
+    ret = setsockopt(fd_, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to XDP_UMEM_REG");
+    }
+
+    ret = setsockopt(fd_, SOL_XDP, XDP_UMEM_FILL_RING, &frame_count, sizeof(frame_count));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to XDP_UMEM_FILL_RING");
+    }
+
+    //
+    // completion ring is unused as nothing is transmitted, but the
+    // kernel requires one for the UMEM.
+    ret = setsockopt(fd_, SOL_XDP, XDP_UMEM_COMPLETION_RING, &frame_count, sizeof(frame_count));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to XDP_UMEM_COMPLETION_RING");
+    }
+
+    ret = setsockopt(fd_, SOL_XDP, XDP_RX_RING, &frame_count, sizeof(frame_count));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to XDP_RX_RING");
+    }
+
+    optlen = sizeof(off);
+    ret = getsockopt(fd_, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen);
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to XDP_MMAP_OFFSETS");
+    }
+
+    ret = map_ring(rx_, XDP_PGOFF_RX_RING,
+                   off.rx.producer, off.rx.consumer, off.rx.flags, off.rx.desc,
+                   frame_count, sizeof(struct xdp_desc));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to map rx ring");
+    }
+
+    ret = map_ring(fill_, XDP_UMEM_PGOFF_FILL_RING,
+                   off.fr.producer, off.fr.consumer, off.fr.flags, off.fr.desc,
+                   frame_count, sizeof(uint64_t));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to map fill ring");
+    }
+
+    ret = map_ring(comp_, XDP_UMEM_PGOFF_COMPLETION_RING,
+                   off.cr.producer, off.cr.consumer, off.cr.flags, off.cr.desc,
+                   frame_count, sizeof(uint64_t));
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to map completion ring");
+    }
+
+    //
+    // hand over all the frames to the kernel
+    for (idx = 0; idx < frame_count; idx ++) {
+        ((uint64_t *)fill_.desc)[idx] = (uint64_t)idx * frame_size;
+    }
+    __atomic_store_n(fill_.producer, frame_count, __ATOMIC_RELEASE);
+
+    //
+    // zero-copy needs driver support, fallback to copy mode.
+    ret = -1;
+    if (zero_copy) {
+        ret = bind_dev(XDP_ZEROCOPY | XDP_USE_NEED_WAKEUP);
+        if (ret == 0) {
+            zero_copy_ = true;
+        }
+    }
+    if (ret < 0) {
+        ret = bind_dev(XDP_COPY | XDP_USE_NEED_WAKEUP);
+    }
+    if (ret < 0) {
+        ret = bind_dev(XDP_COPY);
+    }
+    if (ret < 0) {
+        cleanup();
+        throw std::runtime_error("failed to bind xdp socket");
+    }
+}
+
+xdp_socket::~xdp_socket()
+{
+    cleanup();
+}
+
+void xdp_socket::cleanup() noexcept
+{
+    unmap_ring(rx_);
+    unmap_ring(fill_);
+    unmap_ring(comp_);
+
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+
+    if (umem_ != nullptr) {
+        munmap(umem_, umem_len_);
+        umem_ = nullptr;
+    }
+}
+
+int xdp_socket::map_ring(xdp_ring &ring, uint64_t pgoff,
+                         uint64_t producer_off, uint64_t consumer_off,
+                         uint64_t flags_off, uint64_t desc_off,
+                         uint32_t size, size_t desc_size) noexcept
+{
+    uint8_t *map;
+
+    ring.map_len = desc_off + size * desc_size;
+    map = (uint8_t *)mmap(nullptr, ring.map_len, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd_, pgoff);
+    if (map == MAP_FAILED) {
+        ring.map_len = 0;
+        return -1;
+    }
+
+    ring.map = map;
+    ring.producer = (uint32_t *)(map + producer_off);
+    ring.consumer = (uint32_t *)(map + consumer_off);
+    ring.flags = (uint32_t *)(map + flags_off);
+    ring.desc = map + desc_off;
+    ring.size = size;
+
+    return 0;
+}
+
+void xdp_socket::unmap_ring(xdp_ring &ring) noexcept
+{
+    if (ring.map != nullptr) {
+        munmap(ring.map, ring.map_len);
+        ring.map = nullptr;
+    }
+}
+
+int xdp_socket::bind_dev(uint16_t flags) noexcept
+{
+    struct sockaddr_xdp addr;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sxdp_family = AF_XDP;
+    addr.sxdp_flags = flags;
+    addr.sxdp_ifindex = ifindex_;
+    addr.sxdp_queue_id = queue_id_;
+
+    return bind(fd_, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+int xdp_socket::recv(xdp_frame *frames, uint32_t max_frames, int timeout_ms) noexcept
+{
+    uint32_t cons = *rx_.consumer;
+    uint32_t prod;
+    uint32_t n;
+    uint32_t i;
+
+    prod = __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE);
+    if (prod == cons) {
+        struct pollfd pfd;
+        int ret;
+
+        pfd.fd = fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        ret = poll(&pfd, 1, timeout_ms);
+        if (ret < 0) {
+            return (errno == EINTR) ? 0 : -1;
+        }
+
+        prod = __atomic_load_n(rx_.producer, __ATOMIC_ACQUIRE);
+        if (prod == cons) {
+            return 0;
+        }
+    }
+
+    n = prod - cons;
+    if (n > max_frames) {
+        n = max_frames;
+    }
+
+    for (i = 0; i < n; i ++) {
+        struct xdp_desc *desc;
+
+        desc = &((struct xdp_desc *)rx_.desc)[(cons + i) & (rx_.size - 1)];
+
+        frames[i].addr = desc->addr;
+        frames[i].data = umem_ + desc->addr;
+        frames[i].len = desc->len;
+    }
+
+    __atomic_store_n(rx_.consumer, cons + n, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+void xdp_socket::release(const xdp_frame *frames, uint32_t n_frames) noexcept
+{
+    uint32_t prod = *fill_.producer;
+    uint32_t i;
+
+    //
+    // fill ring is as large as the UMEM, there is always room for
+    // the frames that are returned.
+    for (i = 0; i < n_frames; i ++) {
+        ((uint64_t *)fill_.desc)[(prod + i) & (fill_.size - 1)] =
+                            frames[i].addr & ~((uint64_t)frame_size_ - 1);
+    }
+
+    __atomic_store_n(fill_.producer, prod + n_frames, __ATOMIC_RELEASE);
+
+    if (__atomic_load_n(fill_.flags, __ATOMIC_RELAXED) & XDP_RING_NEED_WAKEUP) {
+        recvfrom(fd_, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+    }
+}
+
+}
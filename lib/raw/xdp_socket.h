@@ -0,0 +1,214 @@
+/**
+ * @brief - Defines AF_XDP socket.
+ *
+ * @author - Devendra Naga.
+ * @copyright - 2023-present All rights reserved.
+ */
+#ifndef __FW_XDP_SOCKET_H__
+#define __FW_XDP_SOCKET_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <raw_socket.h>
+
+namespace firewall {
+
+//
+// maximum frames returned by one call to xdp_socket::recv
+#define XDP_SOCKET_RX_BATCH 64
+
+/**
+ * @brief - Defines a frame received over the AF_XDP socket.
+ *
+ * data points into the UMEM and is valid until the frame is released.
+ */
+struct xdp_frame {
+    uint8_t *data;
+    uint32_t len;
+    // UMEM address of the frame
+    uint64_t addr;
+};
+
+/**
+ * @brief - Implements the XDP program redirecting frames to AF_XDP sockets.
+ *
+ * The program redirects each frame to the socket registered at the index of
+ * its rx queue in an XSKMAP, frames of queues with no socket are passed to the
+ * kernel stack. One program is shared by all the sockets of an interface.
+ */
+class xdp_program {
+    public:
+        /**
+         * @brief - Load and attach the XDP program.
+         *
+         * Attaches in driver mode and falls back to generic (skb) mode
+         * on drivers without native XDP.
+         *
+         * @param [in] - dev Interface name.
+         * @param [in] - n_queues Number of rx queues that can have a socket.
+         *
+         * This constructor will throw exception.
+         */
+        explicit xdp_program(const std::string dev, uint32_t n_queues);
+        ~xdp_program();
+
+        /**
+         * @brief - Register a socket for an rx queue.
+         *
+         * @param [in] - queue_id Rx queue the socket is bound to.
+         * @param [in] - xsk_fd AF_XDP socket.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int add_socket(uint32_t queue_id, int xsk_fd) noexcept;
+
+        /**
+         * @brief - Check if the program is attached in generic (skb) mode.
+         *
+         * @return true if attached in skb mode.
+         */
+        bool is_skb_mode() const noexcept { return skb_mode_; }
+
+    private:
+        int load_prog() noexcept;
+        int attach(uint32_t xdp_flags) noexcept;
+
+        int map_fd_;
+        int prog_fd_;
+        int link_fd_;
+        int ifindex_;
+        bool skb_mode_;
+};
+
+/**
+ * @brief - Implements AF_XDP socket.
+ *
+ * Frames are received into the UMEM and handed over to the caller in place,
+ * the caller releases them back to the fill ring once done.
+ */
+class xdp_socket {
+    public:
+        /**
+         * @brief - Create AF_XDP socket object.
+         *
+         * Binds in zero-copy mode if requested and falls back to copy mode
+         * on drivers without zero-copy support (such as veth).
+         *
+         * @param [in] - dev Interface name.
+         * @param [in] - queue_id Rx queue to bind to.
+         * @param [in] - frame_count Number of UMEM frames (power of 2).
+         * @param [in] - frame_size Size of each UMEM frame (2048 or 4096).
+         * @param [in] - zero_copy Try zero-copy mode.
+         *
+         * This constructor will throw exception.
+         */
+        explicit xdp_socket(const std::string dev,
+                            uint32_t queue_id,
+                            uint32_t frame_count,
+                            uint32_t frame_size,
+                            bool zero_copy);
+        ~xdp_socket();
+
+        /**
+         * @brief - Get socket from the AF_XDP socket object.
+         *
+         * @return socket id.
+         */
+        int get_socket() const noexcept { return fd_; }
+
+        /**
+         * @brief - Check if the socket is bound in zero-copy mode.
+         *
+         * @return true if zero-copy.
+         */
+        bool is_zero_copy() const noexcept { return zero_copy_; }
+
+        /**
+         * @brief - Busy poll the device queue when the rx ring is empty.
+         *
+         * @param [in] - usecs Time to busy poll in poll.
+         * @param [in] - budget Frames processed per busy poll, 0 for the kernel default.
+         *
+         * @return 0 on success.
+         * @return -1 on failure.
+         */
+        int enable_busy_poll(uint32_t usecs, uint32_t budget) noexcept
+        {
+            return socket_enable_busy_poll(fd_, usecs, budget);
+        }
+
+        /**
+         * @brief - Receive frames from the rx ring.
+         *
+         * @param [out] - frames Received frames.
+         * @param [in] - max_frames Size of frames.
+         * @param [in] - timeout_ms Poll timeout if the rx ring is empty.
+         *
+         * @return Number of frames received.
+         * @return 0 on timeout.
+         * @return -1 on failure.
+         */
+        int recv(xdp_frame *frames, uint32_t max_frames, int timeout_ms) noexcept;
+
+        /**
+         * @brief - Release received frames back to the fill ring.
+         *
+         * @param [in] - frames Frames returned by recv.
+         * @param [in] - n_frames Number of frames.
+         */
+        void release(const xdp_frame *frames, uint32_t n_frames) noexcept;
+
+    private:
+        /**
+         * @brief - Defines a producer / consumer ring shared with the kernel.
+         */
+        struct xdp_ring {
+            uint32_t *producer;
+            uint32_t *consumer;
+            uint32_t *flags;
+            void *desc;
+            uint32_t size;
+            void *map;
+            size_t map_len;
+
+            explicit xdp_ring() :
+                        producer(nullptr),
+                        consumer(nullptr),
+                        flags(nullptr),
+                        desc(nullptr),
+                        size(0),
+                        map(nullptr),
+                        map_len(0)
+            { }
+        };
+
+        int map_ring(xdp_ring &ring, uint64_t pgoff,
+                     uint64_t producer_off, uint64_t consumer_off,
+                     uint64_t flags_off, uint64_t desc_off,
+                     uint32_t size, size_t desc_size) noexcept;
+        void unmap_ring(xdp_ring &ring) noexcept;
+        int bind_dev(uint16_t flags) noexcept;
+        void cleanup() noexcept;
+
+        int fd_;
+        std::string dev_;
+        int ifindex_;
+        uint32_t queue_id_;
+        bool zero_copy_;
+
+        //
+        // UMEM area
+        uint8_t *umem_;
+        size_t umem_len_;
+        uint32_t frame_size_;
+
+        xdp_ring rx_;
+        xdp_ring fill_;
+        xdp_ring comp_;
+};
+
+}
+
+#endif
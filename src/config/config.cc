@@ -11,10 +11,45 @@
 */
 #include <fstream>
 #include "jsoncpp/json/json.h"
+#include <cpu_affinity.h>
 #include <config.h>
 
 namespace firewall {
 
+static fw_error_type parse_wait_mode(const Json::Value &val, Wait_Mode &mode)
+{
+    auto wait_mode = val.asString();
+
+    if (wait_mode == "sleep") {
+        mode = Wait_Mode::Sleep;
+    } else if (wait_mode == "adaptive") {
+        mode = Wait_Mode::Adaptive;
+    } else if (wait_mode == "spin") {
+        mode = Wait_Mode::Spin;
+    } else {
+        return fw_error_type::eConfig_Error;
+    }
+
+    return fw_error_type::eNo_Error;
+}
+
+static fw_error_type parse_drop_policy(const Json::Value &val, Queue_Drop_Policy &policy)
+{
+    auto drop_policy = val.asString();
+
+    if (drop_policy == "drop_tail") {
+        policy = Queue_Drop_Policy::Drop_Tail;
+    } else if (drop_policy == "drop_head") {
+        policy = Queue_Drop_Policy::Drop_Head;
+    } else if (drop_policy == "priority") {
+        policy = Queue_Drop_Policy::Priority;
+    } else {
+        return fw_error_type::eConfig_Error;
+    }
+
+    return fw_error_type::eNo_Error;
+}
+
 fw_error_type firewall_config::parse(const std::string config_file)
 {
     Json::Value root;
@@ -31,11 +66,260 @@ fw_error_type firewall_config::parse(const std::string config_file)
         ifinfo.rule_file = it["rule_file"].asString();
         ifinfo.log_pcaps = it["log_pcaps"].asBool();
 
+        //
+        // rx ring is optional, fallback to recvfrom if not configured.
+        if (it.isMember("rx_ring")) {
+            ifinfo.rx_ring.enable = it["rx_ring"]["enable"].asBool();
+            ifinfo.rx_ring.block_size = it["rx_ring"]["block_size"].asUInt();
+            ifinfo.rx_ring.frame_count = it["rx_ring"]["frame_count"].asUInt();
+            ifinfo.rx_ring.block_timeout_ms = it["rx_ring"]["block_timeout_ms"].asUInt();
+        }
+
+        //
+        // workers are optional, default to one worker per interface.
+        if (it.isMember("workers")) {
+            ifinfo.n_workers = it["workers"].asUInt();
+            if (ifinfo.n_workers == 0) {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("fanout_mode")) {
+            auto fanout_mode = it["fanout_mode"].asString();
+            if (fanout_mode == "hash") {
+                ifinfo.fanout_mode = Raw_Fanout_Mode::Hash;
+            } else if (fanout_mode == "cpu") {
+                ifinfo.fanout_mode = Raw_Fanout_Mode::Cpu;
+            } else if (fanout_mode == "rollover") {
+                ifinfo.fanout_mode = Raw_Fanout_Mode::Rollover;
+            } else {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("rx_timestamp")) {
+            auto rx_timestamp = it["rx_timestamp"].asString();
+            if (rx_timestamp == "software") {
+                ifinfo.rx_timestamp = Raw_Timestamp_Source::Software;
+            } else if (rx_timestamp == "hardware") {
+                ifinfo.rx_timestamp = Raw_Timestamp_Source::Hardware;
+            } else {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("capture_backend")) {
+            auto backend = it["capture_backend"].asString();
+            if (backend == "raw") {
+                ifinfo.backend = Capture_Backend_Type::Raw;
+            } else if (backend == "af_xdp") {
+                ifinfo.backend = Capture_Backend_Type::Xdp;
+            } else {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("af_xdp")) {
+            ifinfo.af_xdp.frame_count = it["af_xdp"]["frame_count"].asUInt();
+            ifinfo.af_xdp.frame_size = it["af_xdp"]["frame_size"].asUInt();
+            ifinfo.af_xdp.zero_copy = it["af_xdp"]["zero_copy"].asBool();
+        }
+
+        if (it.isMember("packet_pool")) {
+            auto &pool = it["packet_pool"];
+
+            ifinfo.pkt_pool.hugepages = pool["hugepages"].asBool();
+            if (pool.isMember("size_classes")) {
+                auto &classes = pool["size_classes"];
+
+                if (!classes.isArray() || (classes.size() == 0) ||
+                    (classes.size() > PACKET_POOL_MAX_CLASSES)) {
+                    return fw_error_type::eConfig_Error;
+                }
+
+                ifinfo.pkt_pool.size_classes.clear();
+                for (auto &cls : classes) {
+                    packet_pool_size_class size_class;
+
+                    size_class.buf_size = cls["buf_size"].asUInt();
+                    size_class.count = cls["count"].asUInt();
+
+                    //
+                    // classes must be in increasing buffer size
+                    if ((size_class.buf_size == 0) || (size_class.count == 0) ||
+                        (!ifinfo.pkt_pool.size_classes.empty() &&
+                         (size_class.buf_size <= ifinfo.pkt_pool.size_classes.back().buf_size))) {
+                        return fw_error_type::eConfig_Error;
+                    }
+
+                    ifinfo.pkt_pool.size_classes.push_back(size_class);
+                }
+            }
+        }
+
+        if (it.isMember("decode_mode")) {
+            auto decode_mode = it["decode_mode"].asString();
+            if (decode_mode == "full") {
+                ifinfo.decode_mode = Parser_Decode_Mode::Full;
+            } else if (decode_mode == "zero_copy") {
+                ifinfo.decode_mode = Parser_Decode_Mode::Zero_Copy;
+            } else {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("dissect_depth")) {
+            auto dissect_depth = it["dissect_depth"].asString();
+            if (dissect_depth == "full") {
+                ifinfo.dissect_depth = Parser_Dissect_Depth::Full;
+            } else if (dissect_depth == "rules") {
+                ifinfo.dissect_depth = Parser_Dissect_Depth::Rules;
+            } else {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("batch_size")) {
+            ifinfo.batch_size = it["batch_size"].asUInt();
+            if ((ifinfo.batch_size != 0) &&
+                ((ifinfo.batch_size < PARSER_BATCH_MIN) ||
+                 (ifinfo.batch_size > PARSER_BATCH_MAX))) {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        if (it.isMember("cpu_affinity")) {
+            auto &affinity = it["cpu_affinity"];
+
+            if ((cpu_list_parse(affinity["rx_cpus"].asString(),
+                                ifinfo.affinity.rx_cpus) < 0) ||
+                (cpu_list_parse(affinity["filter_cpus"].asString(),
+                                ifinfo.affinity.filter_cpus) < 0) ||
+                (cpu_list_parse(affinity["pcap_cpus"].asString(),
+                                ifinfo.affinity.pcap_cpus) < 0)) {
+                return fw_error_type::eConfig_Error;
+            }
+
+            if (affinity.isMember("numa_local")) {
+                ifinfo.affinity.numa_local = affinity["numa_local"].asBool();
+            }
+        }
+
+        if (it.isMember("busy_poll")) {
+            auto &busy_poll = it["busy_poll"];
+
+            if (parse_wait_mode(busy_poll["wait_mode"],
+                                ifinfo.busy_poll.wait_mode) != fw_error_type::eNo_Error) {
+                return fw_error_type::eConfig_Error;
+            }
+
+            ifinfo.busy_poll.spin_us = busy_poll["spin_us"].asUInt();
+            ifinfo.busy_poll.socket_busy_poll_us = busy_poll["socket_busy_poll_us"].asUInt();
+            ifinfo.busy_poll.socket_busy_poll_budget = busy_poll["socket_busy_poll_budget"].asUInt();
+        }
+
+        if (it.isMember("rx_queue")) {
+            auto &rx_queue = it["rx_queue"];
+
+            if (parse_drop_policy(rx_queue["drop_policy"],
+                                  ifinfo.rx_queue.drop_policy) != fw_error_type::eNo_Error) {
+                return fw_error_type::eConfig_Error;
+            }
+
+            if (rx_queue.isMember("priority_reserve")) {
+                ifinfo.rx_queue.priority_reserve = rx_queue["priority_reserve"].asUInt();
+
+                //
+                // bulk frames must still get some of the queue
+                if (ifinfo.rx_queue.priority_reserve >= ifinfo.pkt_pool.count()) {
+                    return fw_error_type::eConfig_Error;
+                }
+            }
+        }
+
+        if (it.isMember("sampling")) {
+            auto &sampling = it["sampling"];
+
+            ifinfo.sampling.enable = sampling["enable"].asBool();
+            ifinfo.sampling.high_watermark_pct = sampling["high_watermark_pct"].asUInt();
+            ifinfo.sampling.low_watermark_pct = sampling["low_watermark_pct"].asUInt();
+            ifinfo.sampling.max_rate = sampling["max_rate"].asUInt();
+
+            if ((ifinfo.sampling.high_watermark_pct > 100) ||
+                (ifinfo.sampling.low_watermark_pct >= ifinfo.sampling.high_watermark_pct)) {
+                return fw_error_type::eConfig_Error;
+            }
+
+            //
+            // rate is a power of 2, flows are picked by the top bits of the hash
+            if ((ifinfo.sampling.max_rate < 2) ||
+                (ifinfo.sampling.max_rate > (1U << 16)) ||
+                (ifinfo.sampling.max_rate & (ifinfo.sampling.max_rate - 1))) {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+
+        //
+        // AF_XDP filters in the rx thread, it has no rx queue, sampling
+        // or batch of the filter thread.
+        if ((ifinfo.backend == Capture_Backend_Type::Xdp) &&
+            ((ifinfo.rx_queue.drop_policy != Queue_Drop_Policy::Drop_Tail) ||
+             ifinfo.sampling.enable ||
+             (ifinfo.batch_size != 0))) {
+            return fw_error_type::eConfig_Error;
+        }
+
         intf_list.emplace_back(ifinfo);
     }
 
+    if (root.isMember("parser_pool")) {
+        parser_pool.enable = root["parser_pool"]["enable"].asBool();
+        parser_pool.n_workers = root["parser_pool"]["workers"].asUInt();
+
+        //
+        // bucket owner is kept in 8 bits
+        if ((parser_pool.n_workers == 0) || (parser_pool.n_workers > 256)) {
+            return fw_error_type::eConfig_Error;
+        }
+
+        if (root["parser_pool"].isMember("wait_mode")) {
+            if (parse_wait_mode(root["parser_pool"]["wait_mode"],
+                                parser_pool.wait_mode) != fw_error_type::eNo_Error) {
+                return fw_error_type::eConfig_Error;
+            }
+
+            parser_pool.spin_us = root["parser_pool"]["spin_us"].asUInt();
+        }
+
+        //
+        // AF_XDP interfaces do not feed the parser pool
+        for (auto &it : intf_list) {
+            if (parser_pool.enable && (it.backend == Capture_Backend_Type::Xdp)) {
+                return fw_error_type::eConfig_Error;
+            }
+        }
+    }
+
+    if (root.isMember("cpu_affinity")) {
+        auto &cpu_affinity = root["cpu_affinity"];
+
+        if ((cpu_list_parse(cpu_affinity["housekeeping_cpus"].asString(),
+                            affinity.housekeeping_cpus) < 0) ||
+            (cpu_list_parse(cpu_affinity["parser_pool_cpus"].asString(),
+                            affinity.parser_pool_cpus) < 0)) {
+            return fw_error_type::eConfig_Error;
+        }
+    }
+
     tunables_config_filename = root["tunables_config"].asString();
 
+    if (root.isMember("ip_blacklist")) {
+        blacklist_filename = root["ip_blacklist"].asString();
+    }
+    if (root.isMember("network_map")) {
+        network_map_filename = root["network_map"].asString();
+    }
+
     //
     // Debugging configuration
     debug.log_to_console = root["debugging"]["log_to_console"].asBool();
@@ -59,6 +343,23 @@ fw_error_type firewall_config::parse(const std::string config_file)
     evt_config.encryption_key = root["events"]["encryption_key"].asString();
     evt_config.log_to_console = root["events"]["log_to_console"].asBool();
 
+    if (root["events"].isMember("queue_size")) {
+        evt_config.queue_size = root["events"]["queue_size"].asUInt();
+        if (evt_config.queue_size == 0) {
+            return fw_error_type::eConfig_Error;
+        }
+    }
+
+    //
+    // events are not classified, only drop tail and drop head apply
+    if (root["events"].isMember("queue_drop_policy")) {
+        if ((parse_drop_policy(root["events"]["queue_drop_policy"],
+                               evt_config.queue_drop_policy) != fw_error_type::eNo_Error) ||
+            (evt_config.queue_drop_policy == Queue_Drop_Policy::Priority)) {
+            return fw_error_type::eConfig_Error;
+        }
+    }
+
     auto enc_alg = root["events"]["encryption_algorithm"].asString();
     if (enc_alg == "aes_gcm_128_with_sha256") {
         evt_config.enc_alg = event_encryption_algorithm::AES_GCM_128_W_SHA256;
@@ -10,13 +10,234 @@
 #include <string>
 #include <vector>
 #include <common.h>
+#include <raw_socket.h>
+#include <packet_pool.h>
+#include <wait_strategy.h>
 
 namespace firewall {
 
+/**
+ * @brief - memory mapped (TPACKET_V3) rx ring configuration.
+ */
+struct firewall_rx_ring_config {
+    bool enable;
+    uint32_t block_size;
+    uint32_t frame_count;
+    uint32_t block_timeout_ms;
+
+    explicit firewall_rx_ring_config() :
+                    enable(false),
+                    block_size(0),
+                    frame_count(0),
+                    block_timeout_ms(0)
+    { }
+};
+
+/**
+ * @brief - capture backend of an interface.
+ *
+ * Xdp redirects every frame of the rx queues bound to a worker to nIDS,
+ * those frames no longer reach the host stack. Use it on a mirror or tap
+ * port and not on an interface the host talks on. The frames are filtered
+ * in the rx thread, so parser_pool, rx_queue, sampling and batch_size do
+ * not apply: the config is rejected if they are set on an Xdp interface.
+ */
+enum class Capture_Backend_Type {
+    Raw,
+    Xdp,
+};
+
+/**
+ * @brief - AF_XDP capture configuration.
+ */
+struct firewall_af_xdp_config {
+    uint32_t frame_count;
+    uint32_t frame_size;
+    bool zero_copy;
+
+    explicit firewall_af_xdp_config() :
+                    frame_count(4096),
+                    frame_size(2048),
+                    zero_copy(true)
+    { }
+};
+
+/**
+ * @brief - how the parser decodes the L2 to L4 headers.
+ */
+enum class Parser_Decode_Mode {
+    // copy every header field, run all the protocol checks
+    Full,
+    // record the layer offsets only, fields are read on demand
+    Zero_Copy,
+};
+
+//
+// packets moved together through the stages of the parser in batch mode
+#define PARSER_BATCH_MIN 32
+#define PARSER_BATCH_MAX 256
+
+/**
+ * @brief - how deep the parser dissects each packet.
+ */
+enum class Parser_Dissect_Depth {
+    // dissect every layer, including the application protocols
+    Full,
+    // stop at the last layer read by the loaded rules and auto signatures.
+    // Unless a rule reads the application layer, the payload of the known
+    // ports is not parsed and the DHCP, NTP, TFTP, TLS, DoIP, MQTT and
+    // SOME/IP header and option errors are not reported. Unknown ports
+    // and the known exploit ports are still denied.
+    Rules,
+};
+
+/**
+ * @brief - packet pool configuration of each worker.
+ */
+struct firewall_packet_pool_config {
+    // buffer size classes, small frames, jumbo frames and GRO / TSO frames
+    std::vector<packet_pool_size_class> size_classes;
+    bool hugepages;
+
+    explicit firewall_packet_pool_config() :
+                    size_classes({{2048, 4096}, {9216, 256}, {65536, 32}}),
+                    hugepages(false)
+    { }
+
+    // number of packets of all the classes
+    uint32_t count() const
+    {
+        uint32_t n = 0;
+
+        for (auto &it : size_classes) {
+            n += it.count;
+        }
+
+        return n;
+    }
+};
+
+/**
+ * @brief - cpu placement of the threads of an interface.
+ *
+ * Capture worker i runs on the i-th cpu of a list, modulo the list size.
+ * An empty list leaves the threads on the cpus of the NIC numa node when
+ * numa_local is set, on any cpu otherwise.
+ */
+struct firewall_intf_affinity_config {
+    std::vector<uint32_t> rx_cpus;
+    std::vector<uint32_t> filter_cpus;
+    // pcap writer thread, the housekeeping cpus if empty
+    std::vector<uint32_t> pcap_cpus;
+    // packet pools and unpinned threads on the numa node of the NIC
+    bool numa_local;
+
+    explicit firewall_intf_affinity_config() :
+                    numa_local(true)
+    { }
+};
+
+/**
+ * @brief - what is dropped when a bounded queue is full.
+*/
+enum class Queue_Drop_Policy {
+    // drop the new item
+    Drop_Tail,
+    // drop the oldest items, fresh traffic is kept
+    Drop_Head,
+    // bulk frames leave reserved packets to the priority frames
+    Priority,
+};
+
+/**
+ * @brief - overload policy of the rx queue of a capture worker.
+ */
+struct firewall_rx_queue_config {
+    Queue_Drop_Policy drop_policy;
+    // pool packets kept for priority frames, with the priority policy
+    uint32_t priority_reserve;
+
+    explicit firewall_rx_queue_config() :
+                    drop_policy(Queue_Drop_Policy::Drop_Tail),
+                    priority_reserve(512)
+    { }
+};
+
+/**
+ * @brief - wait strategy of the idle threads and socket busy polling.
+ *
+ * The filter thread, and the rx thread of the rx ring and AF_XDP, spin
+ * up to spin_us before going to sleep.
+ */
+struct firewall_busy_poll_config {
+    Wait_Mode wait_mode;
+    uint32_t spin_us;
+    // SO_BUSY_POLL of the capture socket, 0 to disable
+    uint32_t socket_busy_poll_us;
+    uint32_t socket_busy_poll_budget;
+
+    explicit firewall_busy_poll_config() :
+                    wait_mode(Wait_Mode::Sleep),
+                    spin_us(0),
+                    socket_busy_poll_us(0),
+                    socket_busy_poll_budget(0)
+    { }
+};
+
+/**
+ * @brief - sampling of the flows under sustained overload.
+ *
+ * The rx path checks the use of the packet pool every few frames. The
+ * sampling rate doubles while it is at or over the high watermark and
+ * halves once it is at or under the low watermark.
+ */
+struct firewall_sampling_config {
+    bool enable;
+    // percent of the packet pool in use
+    uint32_t high_watermark_pct;
+    uint32_t low_watermark_pct;
+    // 1 in max_rate flows at most, power of 2
+    uint32_t max_rate;
+
+    explicit firewall_sampling_config() :
+                    enable(false),
+                    high_watermark_pct(75),
+                    low_watermark_pct(25),
+                    max_rate(64)
+    { }
+};
+
 struct firewall_intf_info {
     std::string intf_name;
     std::string rule_file;
     bool log_pcaps;
+    firewall_rx_ring_config rx_ring;
+    // number of capture workers, each with its own socket and threads
+    uint32_t n_workers;
+    Raw_Fanout_Mode fanout_mode;
+    Raw_Timestamp_Source rx_timestamp;
+    Capture_Backend_Type backend;
+    firewall_af_xdp_config af_xdp;
+    firewall_packet_pool_config pkt_pool;
+    Parser_Decode_Mode decode_mode;
+    Parser_Dissect_Depth dissect_depth;
+    // packets the filter thread parses together, 0 for one at a time
+    uint32_t batch_size;
+    firewall_intf_affinity_config affinity;
+    firewall_busy_poll_config busy_poll;
+    firewall_rx_queue_config rx_queue;
+    firewall_sampling_config sampling;
+
+    explicit firewall_intf_info() :
+                    log_pcaps(false),
+                    n_workers(1),
+                    fanout_mode(Raw_Fanout_Mode::Hash),
+                    rx_timestamp(Raw_Timestamp_Source::Software),
+                    backend(Capture_Backend_Type::Raw),
+                    decode_mode(Parser_Decode_Mode::Full),
+                    dissect_depth(Parser_Dissect_Depth::Full),
+                    batch_size(0)
+    { }
 };
 
 enum class event_file_format {
@@ -79,6 +300,15 @@ struct firewall_event_info_config {
     firewall_event_upload_mqtt mqtt;
     firewall_event_udp_config udp_config;
     firewall_event_local_unix_config local_unix_config;
+    //
+    // events waiting for the storage thread, drop tail or drop head
+    uint32_t queue_size;
+    Queue_Drop_Policy queue_drop_policy;
+
+    explicit firewall_event_info_config() :
+                    queue_size(16384),
+                    queue_drop_policy(Queue_Drop_Policy::Drop_Tail)
+    { }
 };
 
 struct firewall_debugging {
@@ -88,12 +318,50 @@ struct firewall_debugging {
     bool log_to_syslog;
 };
 
+/**
+ * @brief - shared pool of parser workers.
+ *
+ * When enabled, the frames of every raw socket interface are parsed by the
+ * pool workers instead of a filter thread per capture worker.
+*/
+struct firewall_parser_pool_config {
+    bool enable;
+    uint32_t n_workers;
+    Wait_Mode wait_mode;
+    uint32_t spin_us;
+
+    explicit firewall_parser_pool_config() :
+                    enable(false),
+                    n_workers(2),
+                    wait_mode(Wait_Mode::Sleep),
+                    spin_us(0)
+    { }
+};
+
+/**
+ * @brief - cpu placement of the threads not tied to an interface.
+*/
+struct firewall_affinity_config {
+    //
+    // event storage, icmp list manager, fwctl server and pcap writers
+    std::vector<uint32_t> housekeeping_cpus;
+    //
+    // parser pool worker i runs on the i-th cpu, modulo the list size
+    std::vector<uint32_t> parser_pool_cpus;
+};
+
 /**
  * @brief - parses the json configuration of firewall service
 */
 struct firewall_config {
     std::vector<firewall_intf_info> intf_list;
+    firewall_parser_pool_config parser_pool;
+    firewall_affinity_config affinity;
     std::string tunables_config_filename;
+    //
+    // ip blacklist and network map files, empty if not used
+    std::string blacklist_filename;
+    std::string network_map_filename;
     firewall_debugging debug;
     firewall_event_info_config evt_config;
 
@@ -5,6 +5,7 @@
 */
 #include <core.h>
 #include <packet_stats.h>
+#include <nw_ioctl.h>
 
 namespace firewall {
 
@@ -64,6 +65,45 @@ fw_error_type fw_core::init(int argc, char **argv)
 
     log_->info("Init filters ok\n");
 
+    //
+    // create the stats entries before any interface starts its workers,
+    // workers only update the existing entries.
+    for (auto it : conf->intf_list) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Startup_Time,
+                                                     it.intf_name);
+    }
+
+    //
+    // the rules are shared by all the interfaces, load every rules file
+    // and compile them once before the first parser is created, the
+    // workers then only read them.
+    for (auto &it : conf->intf_list) {
+        ret = rule_config::instance()->parse(it.rule_file);
+        if (ret != fw_error_type::eNo_Error) {
+            log_->error("failed to parse rules file %s\n", it.rule_file.c_str());
+            return ret;
+        }
+
+        log_->info("parse rules file %s for ifname %s ok\n",
+                   it.rule_file.c_str(), it.intf_name.c_str());
+    }
+    rule_config::instance()->build();
+
+    //
+    // AF_XDP workers filter the frames in the UMEM, only the raw socket
+    // workers feed the parser pool.
+    if (conf->parser_pool.enable) {
+        uint32_t n_sources = 0;
+
+        for (auto &it : conf->intf_list) {
+            if (it.backend != Capture_Backend_Type::Xdp) {
+                n_sources += it.n_workers;
+            }
+        }
+
+        parser_pool_ = std::make_shared<parser_pool>(conf->parser_pool, n_sources, log_);
+    }
+
     for (auto it : conf->intf_list) {
         std::shared_ptr<firewall_intf> intf;
 
@@ -78,7 +118,7 @@ fw_error_type fw_core::init(int argc, char **argv)
 
         //
         // initialize interface
-        ret = intf->init(it.intf_name, it.rule_file, it.log_pcaps);
+        ret = intf->init(it, parser_pool_.get());
         if (ret != fw_error_type::eNo_Error) {
             log_->error("failed to init interface on %s\n", it.intf_name.c_str());
             return ret;
@@ -87,6 +127,10 @@ fw_error_type fw_core::init(int argc, char **argv)
         intf_list_.push_back(intf);
     }
 
+    if (parser_pool_) {
+        parser_pool_->start(conf->affinity.parser_pool_cpus);
+    }
+
     evt_mgr_ = event_mgr::instance();
     ret = evt_mgr_->init(log_);
     if (ret != fw_error_type::eNo_Error) {
@@ -102,10 +146,7 @@ fw_error_type fw_core::init(int argc, char **argv)
     return fw_error_type::eNo_Error;
 }
 
-firewall_intf::firewall_intf(logger *log) : log_(log)
-{
-    rule_data_ = rule_config::instance();
-}
+firewall_intf::firewall_intf(logger *log) : log_(log) { }
 
 firewall_intf::~firewall_intf() { }
 
@@ -131,112 +172,584 @@ void firewall_intf::init_pcap_writer()
     // create pcap writer thread
     pcap_wr_thr_id_ = std::make_shared<std::thread>(
                             &firewall_intf::write_pcap, this);
+
+    if (cpu_affinity_set(pcap_wr_thr_id_->native_handle(), pcap_cpus_) < 0) {
+        log_->error("failed to pin pcap writer thread on %s\n", ifname_.c_str());
+    }
+
     pcap_wr_thr_id_->detach();
 
     log_->info("create pcap writer thread ok\n");
 }
 
 //
-// write pcap logs waking up every second
+// write pcap logs of all workers waking up every second
 void firewall_intf::write_pcap()
 {
     while (1) {
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        {
-            packet pkt;
 
-            std::unique_lock<std::mutex> lock(pcap_log_lock_);
+        for (auto &it : workers_) {
+            it->write_pcap(pcap_w_.get());
+        }
+    }
+}
+
+fw_error_type firewall_intf::init(const firewall_intf_info &intf_info,
+                                  parser_pool *pp)
+{
+    const std::string &ifname = intf_info.intf_name;
+    uint16_t fanout_group;
+    int numa_node = -1;
+    fw_error_type ret;
 
-            while (pcap_log_q_.size() > 0) {
-                pkt = pcap_log_q_.front();
+    ifname_ = ifname;
+    log_pcap_ = intf_info.log_pcaps;
 
-                pcap_w_->write_packet(pkt.buf, pkt.buf_len);
+    pcap_cpus_ = intf_info.affinity.pcap_cpus;
+    if (pcap_cpus_.empty()) {
+        pcap_cpus_ = firewall_config::instance()->affinity.housekeeping_cpus;
+    }
 
-                pcap_log_q_.pop();
-            }
+    //
+    // virtual devices and single node systems have no numa node.
+    if (intf_info.affinity.numa_local) {
+        numa_node = cpu_affinity_intf_numa_node(ifname);
+        if (numa_node >= 0) {
+            log_->info("%s is on numa node %d\n", ifname.c_str(), numa_node);
+        }
+    }
+
+    //
+    // fanout group id must be unique per device in the namespace,
+    // derive it from the pid and the interface name.
+    fanout_group = (getpid() + std::hash<std::string>{}(ifname)) & 0xffff;
+
+    //
+    // worker i of an AF_XDP interface is bound to rx queue i.
+    if (intf_info.backend == Capture_Backend_Type::Xdp) {
+        xdp_prog_ = std::make_shared<xdp_program>(ifname, intf_info.n_workers);
+
+        log_->info("attach xdp program on %s in %s mode ok\n",
+                   ifname.c_str(), xdp_prog_->is_skb_mode() ? "skb" : "driver");
+
+        //
+        // the frames of the bound queues no longer reach the host stack,
+        // an interface the host talks on loses its traffic.
+        if (nw_ioctl_has_ip_addr(ifname.c_str()) == 1) {
+            log_->warn("%s has an ip address, the af_xdp capture takes its "
+                       "traffic away from the host\n", ifname.c_str());
+        }
+    }
+
+    for (uint32_t i = 0; i < intf_info.n_workers; i ++) {
+        std::shared_ptr<firewall_intf_worker> worker;
+
+        worker = std::make_shared<firewall_intf_worker>(this, i, intf_info.pkt_pool,
+                                                        numa_node, log_);
+        if (!worker) {
+            return fw_error_type::eOut_Of_Memory;
         }
+
+        ret = worker->init(intf_info, fanout_group, xdp_prog_.get(), pp);
+        if (ret != fw_error_type::eNo_Error) {
+            log_->error("failed to init worker %u on %s\n", i, ifname.c_str());
+            return ret;
+        }
+
+        workers_.push_back(worker);
     }
+
+    log_->info("create %u workers on %s ok\n", intf_info.n_workers, ifname.c_str());
+
+    //
+    // if log pcap is enabled, initialize pcap writer
+    // once all the workers are created.
+    if (log_pcap_) {
+        init_pcap_writer();
+    }
+
+    return fw_error_type::eNo_Error;
 }
 
-fw_error_type firewall_intf::init(const std::string ifname,
-                                  const std::string rule_file,
-                                  bool log_pcap)
+firewall_intf_worker::firewall_intf_worker(firewall_intf *intf,
+                                           uint32_t worker_id,
+                                           const firewall_packet_pool_config &pool_cfg,
+                                           int numa_node,
+                                           logger *log) :
+                                           intf_(intf),
+                                           worker_id_(worker_id),
+                                           numa_node_(numa_node),
+                                           pkt_q_(pool_cfg.count()),
+                                           pcap_q_(pool_cfg.count()),
+                                           head_drop_req_(0),
+                                           parser_pool_(nullptr),
+                                           pool_src_id_(0),
+                                           log_pcap_(false),
+                                           batch_size_(0),
+                                           filt_sleeping_(false),
+                                           log_(log)
 {
-    fw_error_type ret;
+    rule_data_ = rule_config::instance();
+
+    //
+    // pool pages are faulted in by the constructor, place them on the
+    // node of the NIC that DMAs into them.
+    if (numa_node_ >= 0) {
+        if ((numa_prefer_node(numa_node_) < 0) ||
+            (cpu_affinity_numa_cpus(numa_node_, numa_cpus_) < 0)) {
+            log_->error("failed to use numa node %d\n", numa_node_);
+        }
+    }
+
+    pool_ = std::make_shared<packet_pool>(pool_cfg.size_classes, pool_cfg.hugepages);
+
+    if (numa_node_ >= 0) {
+        numa_prefer_node(-1);
+    }
+}
+
+//
+// worker i takes the i-th cpu of the list, else the cpus of the NIC node.
+std::vector<uint32_t> firewall_intf_worker::worker_cpus(const std::vector<uint32_t> &cpus) const
+{
+    if (cpus.empty()) {
+        return numa_cpus_;
+    }
+
+    return {cpus[worker_id_ % cpus.size()]};
+}
+
+//
+// threads are pinned right after they are created, before they are detached.
+void firewall_intf_worker::pin_thread(std::thread &thr,
+                                      const std::vector<uint32_t> &cpus,
+                                      const char *role)
+{
+    if (cpus.empty()) {
+        return;
+    }
+
+    if (cpu_affinity_set(thr.native_handle(), cpus) < 0) {
+        log_->error("failed to pin %s thread of worker %u on %s\n",
+                    role, worker_id_, ifname_.c_str());
+    }
+}
+
+firewall_intf_worker::~firewall_intf_worker() { }
+
+fw_error_type firewall_intf_worker::init_xdp(const firewall_intf_info &intf_info,
+                                             xdp_program *xdp_prog)
+{
+    int rc;
+
+    xdp_ = std::make_shared<xdp_socket>(ifname_, worker_id_,
+                                        intf_info.af_xdp.frame_count,
+                                        intf_info.af_xdp.frame_size,
+                                        intf_info.af_xdp.zero_copy);
+
+    if ((intf_info.busy_poll.socket_busy_poll_us > 0) &&
+        (xdp_->enable_busy_poll(intf_info.busy_poll.socket_busy_poll_us,
+                                intf_info.busy_poll.socket_busy_poll_budget) < 0)) {
+        log_->error("failed to enable busy poll on %s queue %u\n",
+                    ifname_.c_str(), worker_id_);
+    }
+
+    rc = xdp_prog->add_socket(worker_id_, xdp_->get_socket());
+    if (rc < 0) {
+        log_->error("failed to add xdp socket of queue %u on %s\n",
+                    worker_id_, ifname_.c_str());
+        return fw_error_type::eInvalid;
+    }
+
+    log_->info("create xdp socket on %s queue %u in %s mode ok\n",
+               ifname_.c_str(), worker_id_,
+               xdp_->is_zero_copy() ? "zero-copy" : "copy");
+
+    pkt_perf_ = perf_ctx_.new_perf("pkt_perf");
+
+    //
+    // no filter thread, the rx thread filters the frames in the UMEM.
+    rx_thr_id_ = std::make_shared<std::thread>(&firewall_intf_worker::rx_xdp_thread, this);
+    pin_thread(*rx_thr_id_, worker_cpus(intf_info.affinity.rx_cpus), "rx");
+    rx_thr_id_->detach();
+
+    return fw_error_type::eNo_Error;
+}
+
+fw_error_type firewall_intf_worker::init(const firewall_intf_info &intf_info,
+                                         uint16_t fanout_group,
+                                         xdp_program *xdp_prog,
+                                         parser_pool *pp)
+{
+    const std::string &ifname = intf_info.intf_name;
+    bool use_rx_ring = false;
+    int rc;
 
     ifname_ = ifname;
-    log_pcap_ = log_pcap;
+    log_pcap_ = intf_info.log_pcaps;
+    rx_queue_cfg_ = intf_info.rx_queue;
+    sampler_.init(ifname_, intf_info.sampling, pool_->count());
 
-    // Parse rules file
-    ret = rule_data_->parse(rule_file);
-    if (ret != fw_error_type::eNo_Error) {
-        log_->error("failed to parse rules file %s\n", rule_file.c_str());
-        return ret;
+    parser_ = std::make_shared<parser>(ifname_, rule_data_, log_);
+    if (!parser_) {
+        return fw_error_type::eOut_Of_Memory;
     }
 
-    log_->info("parse rules file %s for ifname %s ok\n",
-                            rule_file.c_str(),
-                            ifname.c_str());
+    parser_->set_decode_mode(intf_info.decode_mode);
+    parser_->set_dissect_depth(intf_info.dissect_depth);
+
+    batch_size_ = intf_info.batch_size;
+    batch_.resize(batch_size_);
+    batch_pkts_.resize(batch_size_);
+    batch_rets_.resize(batch_size_);
+
+    filt_wait_ = wait_strategy(intf_info.busy_poll.wait_mode, intf_info.busy_poll.spin_us);
+    rx_wait_ = wait_strategy(intf_info.busy_poll.wait_mode, intf_info.busy_poll.spin_us);
+
+    log_->info("create packet pool of %u packets on %s worker %u%s\n",
+               pool_->count(), ifname.c_str(), worker_id_,
+               pool_->is_hugepage_backed() ? " on hugepages" : "");
+
+    if (intf_info.backend == Capture_Backend_Type::Xdp) {
+        return init_xdp(intf_info, xdp_prog);
+    }
 
     // Create raw socket
     raw_ = std::make_shared<raw_socket>(ifname, 0);
 
-    log_->info("create raw on %s ok\n", ifname.c_str());
+    log_->info("create raw on %s worker %u ok\n", ifname.c_str(), worker_id_);
+
+    //
+    // hardware timestamps need the NIC support, fallback to the kernel ones.
+    rc = raw_->enable_timestamps(intf_info.rx_timestamp);
+    if ((rc < 0) && (intf_info.rx_timestamp == Raw_Timestamp_Source::Hardware)) {
+        log_->error("failed to enable hardware timestamps on %s, using software\n",
+                    ifname.c_str());
+        rc = raw_->enable_timestamps(Raw_Timestamp_Source::Software);
+    }
+    if (rc < 0) {
+        log_->error("failed to enable rx timestamps on %s\n", ifname.c_str());
+    }
+
+    if ((intf_info.busy_poll.socket_busy_poll_us > 0) &&
+        (raw_->enable_busy_poll(intf_info.busy_poll.socket_busy_poll_us,
+                                intf_info.busy_poll.socket_busy_poll_budget) < 0)) {
+        log_->error("failed to enable busy poll on %s\n", ifname.c_str());
+    }
+
+    //
+    // setup the memory mapped rx ring, fallback to recvfrom on failure.
+    if (intf_info.rx_ring.enable) {
+        rc = raw_->setup_rx_ring(intf_info.rx_ring.block_size,
+                                 intf_info.rx_ring.frame_count,
+                                 intf_info.rx_ring.block_timeout_ms);
+        if (rc < 0) {
+            log_->error("failed to setup rx ring on %s, using recvfrom\n",
+                        ifname.c_str());
+        } else {
+            log_->info("setup rx ring on %s ok\n", ifname.c_str());
+            use_rx_ring = true;
+        }
+    }
+
+    //
+    // single worker receives all the frames, no need of fanout.
+    if (intf_info.n_workers > 1) {
+        rc = raw_->join_fanout(fanout_group, intf_info.fanout_mode);
+        if (rc < 0) {
+            log_->error("failed to join fanout group %u on %s\n",
+                        fanout_group, ifname.c_str());
+            return fw_error_type::eInvalid;
+        }
+    }
+
+    pkt_perf_ = perf_ctx_.new_perf("pkt_perf");
+
+    //
+    // register before the rx thread starts dispatching
+    if (pp) {
+        parser_pool_ = pp;
+        pool_src_id_ = pp->add_source(intf_info);
+    }
 
     // Create receive thread
-    rx_thr_id_ = std::make_shared<std::thread>(&firewall_intf::rx_thread, this);
+    if (use_rx_ring) {
+        rx_thr_id_ = std::make_shared<std::thread>(&firewall_intf_worker::rx_ring_thread, this);
+    } else {
+        rx_thr_id_ = std::make_shared<std::thread>(&firewall_intf_worker::rx_thread, this);
+    }
+    pin_thread(*rx_thr_id_, worker_cpus(intf_info.affinity.rx_cpus), "rx");
     rx_thr_id_->detach();
 
-    // Create filter thread
-    filt_thr_id_ = std::make_shared<std::thread>(&firewall_intf::filter_thread, this);
-    filt_thr_id_->detach();
+    // Create filter thread, AF_XDP workers filter in the rx thread
+    if (!parser_pool_ && !xdp_) {
+        filt_thr_id_ = std::make_shared<std::thread>(&firewall_intf_worker::filter_thread, this);
+        pin_thread(*filt_thr_id_, worker_cpus(intf_info.affinity.filter_cpus), "filter");
+        filt_thr_id_->detach();
+    }
 
     log_->info("create rx thread ok\n");
 
-    pkt_perf_ = perf_ctx_.new_perf("pkt_perf");
+    return fw_error_type::eNo_Error;
+}
 
-    //
-    // if log pcap is enabled, initialize pcap writer
-    if (log_pcap_) {
-        init_pcap_writer();
+//
+// carry the receive metadata of the kernel in the packet
+static inline void set_packet_rx_info(packet &pkt, const raw_rx_info &info)
+{
+    pkt.rx_flags = 0;
+
+    if (info.csum_not_ready)
+        pkt.set_rx_flag(Packet_Rx_Flag::Csum_Not_Ready);
+
+    if (info.csum_valid)
+        pkt.set_rx_flag(Packet_Rx_Flag::Csum_Valid);
+
+    if (info.vlan_valid) {
+        pkt.set_rx_flag(Packet_Rx_Flag::Vlan);
+        pkt.vlan_tci = info.vlan_tci;
+        pkt.vlan_tpid = info.vlan_tpid;
     }
 
     //
-    // set the startup time of the each interface thread
-    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Startup_Time,
-                                                 ifname);
+    // kernel gave no timestamp, the receive time is the next best.
+    if (info.ts.tv_sec || info.ts.tv_nsec) {
+        pkt.rx_ts = info.ts;
+    } else {
+        timestamp_wall(&pkt.rx_ts);
+    }
+}
 
-    return fw_error_type::eNo_Error;
+void firewall_intf_worker::rx_thread()
+{
+    std::vector<uint8_t> spill(pool_->max_buf_size());
+    packet_ref pkt;
+    raw_rx_info info;
+    int ret;
+
+    while (1) {
+        pkt = pool_->alloc();
+
+        //
+        // pool is exhausted, still receive the frame to drain the socket
+        // and drop it.
+        if (!pkt) {
+            ret = raw_->recv_msg(spill.data(), spill.size(), info);
+            if (ret < 0) {
+                return;
+            }
+
+            pool_exhausted();
+            continue;
+        }
+
+        //
+        // frame lands in the small packet, a jumbo or GRO frame spills over
+        // and is moved to a packet of a larger class. The frame is cut at the
+        // buffer size of the largest class.
+        ret = raw_->recv_msg(pkt->buf, pkt->buf_size,
+                             spill.data(), spill.size() - pkt->buf_size,
+                             info);
+        if (ret < 0) {
+            return;
+        }
+
+        if (static_cast<uint32_t>(ret) > pkt->buf_size) {
+            packet_ref large = pool_->alloc(ret);
+
+            if (!large) {
+                pool_exhausted();
+                continue;
+            }
+
+            std::memcpy(large->buf, pkt->buf, pkt->buf_size);
+            std::memcpy(large->buf + pkt->buf_size, spill.data(), ret - pkt->buf_size);
+            pkt = std::move(large);
+        }
+
+        pkt->buf_len = ret;
+        set_packet_rx_info(*pkt, info);
+
+        queue_packet(std::move(pkt));
+    }
 }
 
-void firewall_intf::rx_thread()
+//
+// receive frames from the memory mapped rx ring, frames are
+// copied into the packet before the block is released back to the kernel.
+void firewall_intf_worker::rx_ring_thread()
 {
-    packet pkt;
-    uint8_t mac[6];
+    packet_ref pkt;
+    raw_frame frame;
     int ret;
 
     while (1) {
-        // receive the frame
-        ret = raw_->recv_msg(mac, pkt.buf, sizeof(pkt.buf));
+        if (rx_wait_.mode() == Wait_Mode::Sleep) {
+            ret = raw_->recv_ring(frame, 1000);
+        } else {
+            //
+            // spin on the ring before blocking in poll
+            ret = raw_->recv_ring(frame, 0);
+            if ((ret == 0) &&
+                !rx_wait_.spin([&] { ret = raw_->recv_ring(frame, 0); return ret != 0; })) {
+                ret = raw_->recv_ring(frame, 1000);
+            }
+        }
+
         if (ret < 0) {
             return;
         }
 
-        pkt.buf_len = ret;
+        //
+        // block timed out with no frames
+        if (ret == 0) {
+            continue;
+        }
+
+        //
+        // frames over the largest class are cut to its buffer size
+        pkt = pool_->alloc(std::min<uint32_t>(frame.len, pool_->max_buf_size()));
+        if (!pkt) {
+            pool_exhausted();
+            continue;
+        }
 
-        // increment rx frame count
-        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx,ifname_);
+        pkt->buf_len = std::min<uint32_t>(frame.len, pkt->buf_size);
+        std::memcpy(pkt->buf, frame.data, pkt->buf_len);
+        set_packet_rx_info(*pkt, frame.info);
 
-        {
-            // queue the frame
-            std::unique_lock<std::mutex> lock(rx_thr_lock_);
-            rx_thr_cond_.notify_one();
-            pkt_q_.push(pkt);
+        queue_packet(std::move(pkt));
+    }
+}
+
+//
+// receive frames from the AF_XDP socket and filter them in place,
+// frames are returned to the fill ring after the whole batch is filtered.
+void firewall_intf_worker::rx_xdp_thread()
+{
+    xdp_frame frames[XDP_SOCKET_RX_BATCH];
+    struct timespec rx_ts;
+    int ret;
+    int i;
+
+    while (1) {
+        if (rx_wait_.mode() == Wait_Mode::Sleep) {
+            ret = xdp_->recv(frames, XDP_SOCKET_RX_BATCH, 1000);
+        } else {
+            //
+            // spin on the rx ring before blocking in poll
+            ret = xdp_->recv(frames, XDP_SOCKET_RX_BATCH, 0);
+            if ((ret == 0) &&
+                !rx_wait_.spin([&] {
+                    ret = xdp_->recv(frames, XDP_SOCKET_RX_BATCH, 0);
+                    return ret != 0;
+                })) {
+                ret = xdp_->recv(frames, XDP_SOCKET_RX_BATCH, 1000);
+            }
+        }
+
+        if (ret < 0) {
+            return;
         }
 
-        if (log_pcap_) {
-            pcap_log_q_.push(pkt);
+        //
+        // AF_XDP has no receive timestamp, one for the whole batch.
+        timestamp_wall(&rx_ts);
+
+        for (i = 0; i < ret; i ++) {
+            packet pkt(frames[i].data, frames[i].len);
+
+            pkt.rx_ts = rx_ts;
+
+            // increment rx frame count
+            firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx, ifname_);
+
+            //
+            // UMEM frame goes back to the kernel, copy it for the pcap writer.
+            if (log_pcap_) {
+                packet_ref pcap_pkt = pool_->alloc(std::min<uint32_t>(pkt.buf_len,
+                                                                      pool_->max_buf_size()));
+
+                if (pcap_pkt) {
+                    pcap_pkt->buf_len = std::min<uint32_t>(pkt.buf_len, pcap_pkt->buf_size);
+                    std::memcpy(pcap_pkt->buf, pkt.buf, pcap_pkt->buf_len);
+                    pcap_pkt->rx_ts = pkt.rx_ts;
+                    log_pcap(pcap_pkt);
+                } else {
+                    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Pool_Drop, ifname_);
+                }
+            }
+
+            run_filter(pkt);
         }
+
+        xdp_->release(frames, ret);
+    }
+}
+
+//
+// pcap writer shares the packet with the filter thread, the packet goes
+// back to the pool once both are done with it.
+void firewall_intf_worker::log_pcap(const packet_ref &pkt)
+{
+    if (log_pcap_ && !pcap_q_.push(pkt)) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Pcap_Queue_Full, ifname_);
+    }
+}
+
+void firewall_intf_worker::write_pcap(pcap_writer *pcap_w)
+{
+    packet_ref pkt;
+
+    while (pcap_q_.pop(pkt)) {
+        pcap_w->write_packet(pkt->buf, pkt->buf_len, pkt->rx_ts);
+    }
+}
+
+void firewall_intf_worker::queue_packet(packet_ref &&pkt)
+{
+    // increment rx frame count
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx,ifname_);
+
+    //
+    // flows left out by sampling and bulk frames are dropped before
+    // they hold a packet in the pcap queue.
+    if (!sampler_.sample(*pool_, *pkt)) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Sampled_Out, ifname_);
+        return;
+    }
+
+    if (!rx_queue_admit(rx_queue_cfg_, *pool_, *pkt)) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx_Bulk_Drop, ifname_);
+        return;
+    }
+
+    //
+    // log before queueing, the filter thread owns the packet once queued.
+    log_pcap(pkt);
+
+    if (parser_pool_) {
+        if (!parser_pool_->dispatch(pool_src_id_, std::move(pkt))) {
+            firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx_Queue_Full, ifname_);
+            request_head_drop();
+        }
+        return;
+    }
+
+    if (!pkt_q_.push(std::move(pkt))) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx_Queue_Full, ifname_);
+        request_head_drop();
+        return;
+    }
+
+    //
+    // pairs with the fence in filter_thread, either the filter thread sees
+    // the packet or we see that it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (filt_sleeping_.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(rx_thr_lock_);
+        rx_thr_cond_.notify_one();
     }
 }
 
@@ -246,43 +759,146 @@ void firewall_intf::rx_thread()
  * This is written indepdently out of the queue retrieve logic to increase
  * the flexibility of queue retrieval design.
 */
-void firewall_intf::run_filter(packet &pkt)
+void firewall_intf_worker::run_filter(packet &pkt)
 {
-    std::shared_ptr<parser> p;
     int ret;
 
-    p = std::make_shared<parser>(ifname_, rule_data_, log_);
-    if (!p)
-        return;
-
     pkt_perf_->start();
 
     log_->verbose("filter packet with size %d\n", pkt.buf_len);
 
-    ret = p->run(pkt);
+    //
+    // clear the layers of the previous packet
+    parser_->reset();
+
+    ret = parser_->run(pkt);
     if (ret != 0) {
         firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny, ifname_);
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny_Est, ifname_,
+                                                     pkt.sample_rate);
     }
 
     pkt_perf_->stop(true);
 }
 
-void firewall_intf::filter_thread()
+//
+// take what is queued, up to the batch size, and move it through each
+// stage of the parser together.
+void firewall_intf_worker::run_filter_batch(packet_ref &&first)
 {
+    uint32_t n_pkts = 1;
+    uint32_t i;
+
+    batch_[0] = std::move(first);
+    while ((n_pkts < batch_size_) && pkt_q_.pop(batch_[n_pkts])) {
+        n_pkts ++;
+    }
+
+    for (i = 0; i < n_pkts; i ++) {
+        batch_pkts_[i] = batch_[i].get();
+        log_->verbose("filter packet with size %d\n", batch_pkts_[i]->buf_len);
+    }
+
+    //
+    // perf is taken over the batch
+    pkt_perf_->start();
+
+    parser_->run_batch(batch_pkts_.data(), n_pkts, batch_rets_.data());
+
+    pkt_perf_->stop(true);
+
+    for (i = 0; i < n_pkts; i ++) {
+        if (batch_rets_[i] != 0) {
+            firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny, ifname_);
+            firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny_Est, ifname_,
+                                                         batch_pkts_[i]->sample_rate);
+        }
+
+        //
+        // back to the pool, unless the pcap writer still holds it
+        batch_[i].reset();
+    }
+}
+
+//
+// no free packet for a received frame, called by the rx thread
+void firewall_intf_worker::pool_exhausted()
+{
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Pool_Drop, ifname_);
+    request_head_drop();
+    sampler_.tick(*pool_);
+}
+
+//
+// queue or pool is full, with the drop head policy the consumer drops
+// the oldest packets to make room.
+void firewall_intf_worker::request_head_drop()
+{
+    uint32_t n_drops = rx_queue_head_drops(rx_queue_cfg_, pool_->count());
+
+    if (n_drops == 0) {
+        return;
+    }
+
+    if (parser_pool_) {
+        parser_pool_->request_head_drop(pool_src_id_, n_drops);
+    } else {
+        head_drop_req_.store(n_drops, std::memory_order_relaxed);
+    }
+}
+
+//
+// drop the oldest packets the rx thread asked for
+void firewall_intf_worker::drop_head()
+{
+    uint32_t n_drops = head_drop_req_.exchange(0, std::memory_order_relaxed);
+    packet_ref pkt;
+
+    while ((n_drops > 0) && pkt_q_.pop(pkt)) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx_Head_Drop, ifname_);
+        n_drops --;
+    }
+}
+
+void firewall_intf_worker::filter_thread()
+{
+    packet_ref pkt;
+
     while (1) {
-        packet pkt;
+        if (head_drop_req_.load(std::memory_order_relaxed)) {
+            drop_head();
+        }
 
-        // retrieve one packet from the queue
-        {
-            std::unique_lock<std::mutex> lock(rx_thr_lock_);
-            rx_thr_cond_.wait(lock);
-            while (pkt_q_.size() > 0) {
-                pkt = pkt_q_.front();
+        if (!pkt_q_.pop(pkt)) {
+            struct timespec sleep_start;
 
-                run_filter(pkt);
-                pkt_q_.pop();
+            //
+            // spin on the queue before paying for a wakeup
+            if (filt_wait_.spin([this] { return !pkt_q_.empty(); })) {
+                continue;
             }
+
+            std::unique_lock<std::mutex> lock(rx_thr_lock_);
+
+            clock_gettime(CLOCK_MONOTONIC, &sleep_start);
+            filt_sleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            rx_thr_cond_.wait(lock, [this] { return !pkt_q_.empty(); });
+            filt_sleeping_.store(false, std::memory_order_relaxed);
+            filt_wait_.slept(wait_strategy::elapsed_ns(sleep_start));
+            continue;
+        }
+
+        if (batch_size_ > 0) {
+            run_filter_batch(std::move(pkt));
+            continue;
         }
+
+        run_filter(*pkt);
+
+        //
+        // back to the pool, unless the pcap writer still holds it
+        pkt.reset();
     }
 }
 
@@ -7,18 +7,24 @@
 #define __FW_CORE_H__
 
 #include <stdint.h>
+#include <algorithm>
 #include <getopt.h>
 #include <unistd.h>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <queue>
+#include <spsc_ring.h>
 #include <memory>
+#include <functional>
 #include <config.h>
 #include <logger.h>
 #include <raw_socket.h>
+#include <xdp_socket.h>
 #include <packet.h>
+#include <packet_pool.h>
 #include <rule_parser.h>
 #include <packet_stats.h>
 #include <parser.h>
@@ -27,50 +33,120 @@
 #include <filter.h>
 #include <pcap_intf.h>
 #include <fw_ctl_serv.h>
+#include <parser_pool.h>
+#include <rx_queue_policy.h>
+#include <rx_sampler.h>
+#include <lang_hints.h>
+#include <cpu_affinity.h>
+#include <wait_strategy.h>
 
 namespace firewall {
 
+class firewall_intf;
+
 /**
- * @brief - Interface info
+ * @brief - Implements a capture worker of an interface.
+ *
+ * Each worker has its own raw socket, packet pool, receive thread, filter thread and queue.
+ * When an interface has more than one worker, the sockets are joined in a
+ * PACKET_FANOUT group so that the kernel spreads the frames across them.
+ *
+ * With the parser pool, a raw socket worker has no filter thread and sends
+ * its frames to the pool instead.
 */
-class firewall_intf {
+class firewall_intf_worker {
     public:
-        explicit firewall_intf(logger *log);
-        ~firewall_intf();
+        explicit firewall_intf_worker(firewall_intf *intf,
+                                      uint32_t worker_id,
+                                      const firewall_packet_pool_config &pool_cfg,
+                                      int numa_node,
+                                      logger *log); THROWS
+        ~firewall_intf_worker();
 
-        // Initialize interface
-        fw_error_type init(const std::string ifname,
-                           const std::string rule_file,
-                           bool log_pcap);
+        // Initialize worker
+        fw_error_type init(const firewall_intf_info &intf_info,
+                           uint16_t fanout_group,
+                           xdp_program *xdp_prog,
+                           parser_pool *pp);
+
+        //
+        // write the packets queued for pcap logging, called by the pcap writer thread
+        void write_pcap(pcap_writer *pcap_w);
 
     private:
+        fw_error_type init_xdp(const firewall_intf_info &intf_info,
+                               xdp_program *xdp_prog);
         void rx_thread();
+        void rx_ring_thread();
+        void rx_xdp_thread();
+        void log_pcap(const packet_ref &pkt);
+        void queue_packet(packet_ref &&pkt);
         void filter_thread();
+        void pool_exhausted();
+        void request_head_drop();
+        void drop_head();
         void run_filter(packet &pkt);
-        void init_pcap_writer();
-        void write_pcap();
+        void run_filter_batch(packet_ref &&first);
+        std::vector<uint32_t> worker_cpus(const std::vector<uint32_t> &cpus) const;
+        void pin_thread(std::thread &thr, const std::vector<uint32_t> &cpus,
+                        const char *role);
 
         //
-        // receive thread for each interface
+        // owning interface
+        firewall_intf *intf_;
+        uint32_t worker_id_;
+        //
+        // numa node of the NIC and its cpus, -1 and empty if unknown
+        int numa_node_;
+        std::vector<uint32_t> numa_cpus_;
+        //
+        // receive thread of this worker
         std::shared_ptr<std::thread> rx_thr_id_;
         std::condition_variable rx_thr_cond_;
         //
-        // filter thread id for each interface
+        // filter thread of this worker
         std::shared_ptr<std::thread> filt_thr_id_;
 
-        //
-        // PCAP writer thread for each interface
-        std::shared_ptr<std::thread> pcap_wr_thr_id_;
-        std::mutex pcap_log_lock_;
-        std::queue<packet> pcap_log_q_;
-
         //
         // raw socket interface
         std::shared_ptr<raw_socket> raw_;
         //
-        // list of packet queues
-        std::queue<packet> pkt_q_;
+        // AF_XDP socket, frames are filtered in place in the rx thread
+        std::shared_ptr<xdp_socket> xdp_;
+        //
+        // preallocated packets, shared by the rx thread, filter thread
+        // and the pcap writer without copies.
+        std::shared_ptr<packet_pool> pool_;
+        // received packets, rx thread to filter thread
+        spsc_ring<packet_ref> pkt_q_;
+        // received packets, rx thread to pcap writer thread
+        spsc_ring<packet_ref> pcap_q_;
+        firewall_rx_queue_config rx_queue_cfg_;
+        rx_sampler sampler_;
+        //
+        // oldest packets the filter thread drops, set by the rx thread
+        // when the queue overflows with the drop head policy.
+        std::atomic<uint32_t> head_drop_req_;
+        //
+        // shared parser pool, frames are parsed there if set
+        parser_pool *parser_pool_;
+        uint32_t pool_src_id_;
+        bool log_pcap_;
+        //
+        // packets the filter thread parses together, 0 for one at a time
+        uint32_t batch_size_;
+        std::vector<packet_ref> batch_;
+        std::vector<packet *> batch_pkts_;
+        std::vector<int> batch_rets_;
+        //
+        // lock and condition are used only when the filter thread sleeps
         std::mutex rx_thr_lock_;
+        std::atomic<bool> filt_sleeping_;
+        //
+        // spin before sleeping, filter thread on the queue and the
+        // rx thread on the rx ring or AF_XDP ring.
+        wait_strategy filt_wait_;
+        wait_strategy rx_wait_;
         //
         // logger pointer
         logger *log_;
@@ -80,9 +156,47 @@ class firewall_intf {
         //
         // interface name
         std::string ifname_;
-        bool log_pcap_;
+        //
+        // parser context reused for every packet of this worker
+        std::shared_ptr<parser> parser_;
         perf perf_ctx_;
         std::shared_ptr<perf_item> pkt_perf_;
+};
+
+/**
+ * @brief - Interface info
+*/
+class firewall_intf {
+    public:
+        explicit firewall_intf(logger *log);
+        ~firewall_intf();
+
+        // Initialize interface
+        fw_error_type init(const firewall_intf_info &intf_info,
+                           parser_pool *pp);
+
+    private:
+        void init_pcap_writer();
+        void write_pcap();
+
+        //
+        // PCAP writer thread for each interface
+        std::shared_ptr<std::thread> pcap_wr_thr_id_;
+
+        //
+        // XDP program shared by the AF_XDP sockets of this interface
+        std::shared_ptr<xdp_program> xdp_prog_;
+        //
+        // capture workers of this interface
+        std::vector<std::shared_ptr<firewall_intf_worker>> workers_;
+        //
+        // logger pointer
+        logger *log_;
+        //
+        // interface name
+        std::string ifname_;
+        bool log_pcap_;
+        std::vector<uint32_t> pcap_cpus_;
         std::shared_ptr<pcap_writer> pcap_w_;
 };
 
@@ -99,6 +213,9 @@ class fw_core {
     private:
         // List of firewall interface context
         std::vector<std::shared_ptr<firewall_intf>> intf_list_;
+        //
+        // parser workers shared by all the raw socket interfaces
+        std::shared_ptr<parser_pool> parser_pool_;
         event_mgr *evt_mgr_;
         logger *log_;
         std::shared_ptr<fwctl_server> fwctl_serv_;
@@ -29,6 +29,22 @@ struct fwctl_stats {
     uint64_t n_rx;
     uint64_t n_allowed;
     uint64_t n_deny;
+    //
+    // drops by reason
+    uint64_t n_pool_drops;
+    uint64_t n_rx_queue_full;
+    uint64_t n_rx_head_drops;
+    uint64_t n_rx_bulk_drops;
+    uint64_t n_pcap_queue_full;
+    uint64_t n_event_queue_full;
+    //
+    // sampling under overload
+    uint64_t n_sampled_out;
+    uint64_t n_deny_est;
+    uint32_t sample_rate;
+    //
+    // frames taken by the fast path of the parser
+    uint64_t n_fast_path;
 } __attribute__ ((__packed__));
 
 struct fwctl_msg {
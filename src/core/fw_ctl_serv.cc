@@ -4,6 +4,8 @@
  * @copyright - 2023-present. Devendra Naga. All rights reserved.
 */
 #include <packet_stats.h>
+#include <config.h>
+#include <cpu_affinity.h>
 #include <fw_ctl_serv.h>
 
 namespace firewall {
@@ -30,6 +32,12 @@ fwctl_server::fwctl_server(logger *log)
     }
 
     rx_thr_ = std::make_unique<std::thread>(&fwctl_server::fwctl_rx_pkt, this);
+
+    if (cpu_affinity_set(rx_thr_->native_handle(),
+                         firewall_config::instance()->affinity.housekeeping_cpus) < 0) {
+        log_->error("fwctl: failed to pin rx thread\n");
+    }
+
     rx_thr_->detach();
 }
 
@@ -90,6 +98,16 @@ void fwctl_server::fwctl_write_stats(struct sockaddr_un *sender,
         ctl_stats->n_rx = it.second.n_rx;
         ctl_stats->n_allowed = it.second.n_allowed;
         ctl_stats->n_deny = it.second.n_deny;
+        ctl_stats->n_pool_drops = it.second.n_pool_drops;
+        ctl_stats->n_rx_queue_full = it.second.n_rx_queue_full;
+        ctl_stats->n_rx_head_drops = it.second.n_rx_head_drops;
+        ctl_stats->n_rx_bulk_drops = it.second.n_rx_bulk_drops;
+        ctl_stats->n_pcap_queue_full = it.second.n_pcap_queue_full;
+        ctl_stats->n_event_queue_full = it.second.n_event_queue_full;
+        ctl_stats->n_sampled_out = it.second.n_sampled_out;
+        ctl_stats->n_deny_est = it.second.n_deny_est;
+        ctl_stats->sample_rate = it.second.sample_rate;
+        ctl_stats->n_fast_path = it.second.n_fast_path;
 
         off += sizeof(fwctl_stats);
     }
@@ -0,0 +1,197 @@
+/**
+ * @brief - Implements the exact match table of the ethernet and vlan rules.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_L2_RULE_TABLE_H__
+#define __FW_L2_RULE_TABLE_H__
+
+#include <stdint.h>
+#include <vector>
+
+namespace firewall {
+
+/**
+ * @brief - fields of an l2 key, the fields not in the mask are wildcards.
+*/
+enum class L2_Key_Field : uint8_t {
+    Src_Mac = 0x01,
+    Dst_Mac = 0x02,
+    Ethertype = 0x04,
+    Vid = 0x08,
+};
+
+//
+// number of fields in L2_Key_Field
+#define L2_KEY_FIELD_COUNT 4
+
+/**
+ * @brief - l2 header fields of a rule or a frame, the wildcard fields are 0.
+*/
+struct l2_key {
+    uint64_t src_mac;
+    uint64_t dst_mac;
+    uint16_t ethertype;
+    uint16_t vid;
+    uint8_t mask;
+
+    explicit l2_key() :
+                src_mac(0),
+                dst_mac(0),
+                ethertype(0),
+                vid(0),
+                mask(0) { }
+    ~l2_key() { }
+
+    static inline uint64_t mac(const uint8_t *m)
+    {
+        return (static_cast<uint64_t>(m[0]) << 40) |
+               (static_cast<uint64_t>(m[1]) << 32) |
+               (static_cast<uint64_t>(m[2]) << 24) |
+               (static_cast<uint64_t>(m[3]) << 16) |
+               (static_cast<uint64_t>(m[4]) << 8) |
+               static_cast<uint64_t>(m[5]);
+    }
+
+    inline bool operator==(const l2_key &k) const
+    {
+        return (src_mac == k.src_mac) && (dst_mac == k.dst_mac) &&
+               (ethertype == k.ethertype) && (vid == k.vid) && (mask == k.mask);
+    }
+
+    inline uint64_t hash() const
+    {
+        uint64_t h;
+
+        //
+        // multiply and fold, the macs of one vendor differ only in the
+        // low bytes and must still spread over the table.
+        h = src_mac * 0x9E3779B97F4A7C15ULL;
+        h ^= (dst_mac + ((uint64_t)ethertype << 48)) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= ((uint64_t)vid << 8 | mask) * 0x165667B19E3779F9ULL;
+
+        return h ^ (h >> 29);
+    }
+};
+
+/**
+ * @brief - open addressing hash table from an l2 key to the rules filed
+ *          under it.
+ *
+ * Built once when the rules are loaded and read only afterwards, so it is
+ * shared by all the parsers without locks. Linear probing over a table at
+ * most half full, a lookup is one or two cache lines.
+*/
+class l2_rule_table {
+    public:
+        explicit l2_rule_table() : mask_(0) { }
+        ~l2_rule_table() { }
+
+        void clear()
+        {
+            slots_.clear();
+            lists_.clear();
+            mask_ = 0;
+        }
+
+        bool empty() const { return lists_.empty(); }
+
+        /**
+         * @brief - file a rule under a key.
+         *
+         * @param [in] k - key of the rule
+         * @param [in] rule_pos - position of the rule in the rule list
+        */
+        void add(const l2_key &k, uint32_t rule_pos)
+        {
+            slot *s;
+
+            if ((lists_.size() + 1) * 2 > slots_.size()) {
+                grow();
+            }
+
+            s = probe(k);
+            if (s->list == L2_RULE_TABLE_FREE) {
+                s->key = k;
+                s->list = lists_.size();
+                lists_.emplace_back();
+            }
+
+            lists_[s->list].push_back(rule_pos);
+        }
+
+        /**
+         * @brief - get the rules filed under a key.
+         *
+         * @param [in] k - key of the frame
+         *
+         * @return rules in the order they were added, nullptr if none.
+        */
+        inline const std::vector<uint32_t> *find(const l2_key &k) const
+        {
+            uint64_t i;
+
+            if (slots_.empty()) {
+                return nullptr;
+            }
+
+            for (i = k.hash() & mask_; ; i = (i + 1) & mask_) {
+                const slot &s = slots_[i];
+
+                if (s.list == L2_RULE_TABLE_FREE) {
+                    return nullptr;
+                }
+                if (s.key == k) {
+                    return &lists_[s.list];
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t L2_RULE_TABLE_FREE = UINT32_MAX;
+
+        struct slot {
+            l2_key key;
+            uint32_t list;
+
+            explicit slot() : list(L2_RULE_TABLE_FREE) { }
+            ~slot() { }
+        };
+
+        slot *probe(const l2_key &k)
+        {
+            uint64_t i;
+
+            for (i = k.hash() & mask_; ; i = (i + 1) & mask_) {
+                slot &s = slots_[i];
+
+                if ((s.list == L2_RULE_TABLE_FREE) || (s.key == k)) {
+                    return &s;
+                }
+            }
+        }
+
+        void grow()
+        {
+            std::vector<slot> old;
+            uint64_t size = slots_.empty() ? 16 : slots_.size() * 2;
+
+            old.swap(slots_);
+            slots_.resize(size);
+            mask_ = size - 1;
+
+            for (auto &it : old) {
+                if (it.list != L2_RULE_TABLE_FREE) {
+                    *probe(it.key) = it;
+                }
+            }
+        }
+
+        std::vector<slot> slots_;
+        std::vector<std::vector<uint32_t>> lists_;
+        uint64_t mask_;
+};
+
+}
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @brief - Implements flow affine pool of parser workers.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#include <stdexcept>
+#include <flow_hash.h>
+#include <rule_parser.h>
+#include <packet_stats.h>
+#include <parser_pool.h>
+
+namespace firewall {
+
+#define PARSER_POOL_OWNER_SHIFT 24
+#define PARSER_POOL_INFLIGHT_MASK ((1U << PARSER_POOL_OWNER_SHIFT) - 1)
+
+//
+// idle worker wakes up this often to look for buckets to steal
+#define PARSER_POOL_IDLE_WAIT_MS 10
+
+parser_pool::parser_pool(const firewall_parser_pool_config &cfg,
+                         uint32_t max_sources, logger *log) :
+                            max_sources_(max_sources),
+                            log_(log)
+{
+    uint32_t n_workers = cfg.n_workers;
+    uint32_t i;
+
+    for (i = 0; i < n_workers; i ++) {
+        std::shared_ptr<pool_worker> w = std::make_shared<pool_worker>();
+
+        w->wait = wait_strategy(cfg.wait_mode, cfg.spin_us);
+
+        //
+        // queues are never reallocated, sources dispatch while
+        // the later ones are added.
+        w->in.reserve(max_sources);
+        w->parsers.reserve(max_sources);
+        w->head_drop_req.reset(new std::atomic<uint32_t>[max_sources]);
+        for (uint32_t j = 0; j < max_sources; j ++) {
+            w->head_drop_req[j].store(0, std::memory_order_relaxed);
+        }
+        workers_.push_back(w);
+    }
+
+    //
+    // buckets are spread evenly to start with
+    for (i = 0; i < PARSER_POOL_BUCKETS; i ++) {
+        bucket_state_[i].store((i % n_workers) << PARSER_POOL_OWNER_SHIFT,
+                               std::memory_order_relaxed);
+        bucket_hits_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+parser_pool::~parser_pool() { }
+
+uint32_t parser_pool::pool_worker::backlog() const
+{
+    uint32_t count = 0;
+
+    for (auto &it : in) {
+        count += it->count();
+    }
+
+    return count;
+}
+
+bool parser_pool::pool_worker::empty() const
+{
+    for (auto &it : in) {
+        if (!it->empty()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t parser_pool::add_source(const firewall_intf_info &intf_info)
+{
+    pool_source src;
+
+    if (sources_.size() == max_sources_) {
+        throw std::runtime_error("too many parser pool sources");
+    }
+
+    src.ifname = intf_info.intf_name;
+
+    //
+    // a worker may own every bucket, so each queue holds all the
+    // packets of the capture worker.
+    for (auto &it : workers_) {
+        std::shared_ptr<parser> p;
+
+        p = std::make_shared<parser>(intf_info.intf_name, rule_config::instance(), log_);
+        p->set_decode_mode(intf_info.decode_mode);
+        p->set_dissect_depth(intf_info.dissect_depth);
+
+        it->in.push_back(std::make_shared<spsc_ring<pool_item>>(intf_info.pkt_pool.count()));
+        it->parsers.push_back(p);
+    }
+
+    sources_.push_back(src);
+
+    return sources_.size() - 1;
+}
+
+void parser_pool::start(const std::vector<uint32_t> &cpus)
+{
+    uint32_t i;
+
+    for (i = 0; i < workers_.size(); i ++) {
+        workers_[i]->pkt_perf = workers_[i]->perf_ctx.new_perf("pkt_perf");
+        workers_[i]->thr_id = std::make_shared<std::thread>(&parser_pool::worker_thread, this, i);
+
+        if (!cpus.empty() &&
+            (cpu_affinity_set(workers_[i]->thr_id->native_handle(),
+                              {cpus[i % cpus.size()]}) < 0)) {
+            log_->error("failed to pin parser pool worker %u to cpu %u\n",
+                        i, cpus[i % cpus.size()]);
+        }
+
+        workers_[i]->thr_id->detach();
+    }
+
+    log_->info("create parser pool of %u workers for %zu sources ok\n",
+               workers_.size(), sources_.size());
+}
+
+//
+// the in flight count is taken before the owner is read, in a single
+// atomic. A steal needs the count to be zero, so the owner can not change
+// until the frame is parsed.
+bool parser_pool::dispatch(uint32_t src_id, packet_ref &&pkt)
+{
+    uint32_t bucket;
+    uint32_t state;
+    pool_worker *w;
+
+    bucket = flow_hash(pkt->buf, pkt->buf_len) & (PARSER_POOL_BUCKETS - 1);
+
+    state = bucket_state_[bucket].fetch_add(1, std::memory_order_acquire);
+    bucket_hits_[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    w = workers_[state >> PARSER_POOL_OWNER_SHIFT].get();
+
+    if (!w->in[src_id]->push(pool_item{std::move(pkt), bucket})) {
+        bucket_state_[bucket].fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    //
+    // pairs with the fence in worker_thread, either the worker sees
+    // the packet or we see that it sleeps.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (w->sleeping.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(w->lock);
+        w->cond.notify_one();
+    }
+
+    return true;
+}
+
+//
+// take the busiest quiescent bucket of the worker with the largest backlog.
+bool parser_pool::steal(uint32_t id)
+{
+    uint32_t victim = id;
+    uint32_t max_backlog = PARSER_POOL_STEAL_BACKLOG - 1;
+    uint32_t best = PARSER_POOL_BUCKETS;
+    uint32_t best_hits = 0;
+    uint32_t i;
+
+    for (i = 0; i < workers_.size(); i ++) {
+        uint32_t backlog;
+
+        if (i == id) {
+            continue;
+        }
+
+        backlog = workers_[i]->backlog();
+        if (backlog > max_backlog) {
+            max_backlog = backlog;
+            victim = i;
+        }
+    }
+
+    if (victim == id) {
+        return false;
+    }
+
+    for (i = 0; i < PARSER_POOL_BUCKETS; i ++) {
+        uint32_t state = bucket_state_[i].load(std::memory_order_relaxed);
+        uint32_t hits;
+
+        if ((state >> PARSER_POOL_OWNER_SHIFT) != victim) {
+            continue;
+        }
+
+        hits = bucket_hits_[i].load(std::memory_order_relaxed);
+        bucket_hits_[i].store(hits >> 1, std::memory_order_relaxed);
+
+        if (((state & PARSER_POOL_INFLIGHT_MASK) == 0) && (hits > best_hits)) {
+            best_hits = hits;
+            best = i;
+        }
+    }
+
+    if (best == PARSER_POOL_BUCKETS) {
+        return false;
+    }
+
+    //
+    // fails if a frame of the bucket got queued meanwhile
+    uint32_t expected = victim << PARSER_POOL_OWNER_SHIFT;
+
+    return bucket_state_[best].compare_exchange_strong(expected,
+                                                       id << PARSER_POOL_OWNER_SHIFT,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_relaxed);
+}
+
+//
+// the frames of a source are spread over the workers, each drops
+// from the head of its own queue.
+void parser_pool::request_head_drop(uint32_t src_id, uint32_t n_drops)
+{
+    for (auto &it : workers_) {
+        it->head_drop_req[src_id].store(n_drops, std::memory_order_relaxed);
+    }
+}
+
+//
+// drop the oldest frames of a source, the rx thread asked for
+void parser_pool::drop_head(pool_worker *w, uint32_t src_id)
+{
+    uint32_t n_drops = w->head_drop_req[src_id].exchange(0, std::memory_order_relaxed);
+    pool_item item;
+
+    while ((n_drops > 0) && w->in[src_id]->pop(item)) {
+        item.pkt.reset();
+        bucket_state_[item.bucket].fetch_sub(1, std::memory_order_release);
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Rx_Head_Drop,
+                                                     sources_[src_id].ifname);
+        n_drops --;
+    }
+}
+
+void parser_pool::worker_thread(uint32_t id)
+{
+    pool_worker *w = workers_[id].get();
+    struct timespec sleep_start;
+    uint32_t spins = 0;
+    pool_item items[PARSER_POOL_BATCH];
+    packet *pkts[PARSER_POOL_BATCH];
+    int rets[PARSER_POOL_BATCH];
+    uint32_t n;
+    uint32_t i;
+    uint32_t j;
+
+    while (1) {
+        n = 0;
+
+        for (i = 0; i < w->in.size(); i ++) {
+            uint32_t batch = 0;
+
+            if (w->head_drop_req[i].load(std::memory_order_relaxed)) {
+                drop_head(w, i);
+            }
+
+            while ((batch < PARSER_POOL_BATCH) && w->in[i]->pop(items[batch])) {
+                pkts[batch] = items[batch].pkt.get();
+                log_->verbose("filter packet with size %d\n", pkts[batch]->buf_len);
+                batch ++;
+            }
+
+            if (batch == 0) {
+                continue;
+            }
+
+            //
+            // the frames of a source go through the stages of its parser
+            // together, perf is taken over the batch.
+            w->pkt_perf->start();
+
+            w->parsers[i]->run_batch(pkts, batch, rets);
+
+            w->pkt_perf->stop(true);
+
+            for (j = 0; j < batch; j ++) {
+                if (rets[j] != 0) {
+                    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny,
+                                                                 sources_[i].ifname);
+                    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Deny_Est,
+                                                                 sources_[i].ifname,
+                                                                 pkts[j]->sample_rate);
+                }
+
+                //
+                // back to the pool, unless the pcap writer still holds it
+                items[j].pkt.reset();
+
+                //
+                // done with the frame, the bucket may move from now on.
+                bucket_state_[items[j].bucket].fetch_sub(1, std::memory_order_release);
+            }
+
+            n += batch;
+        }
+
+        if (n > 0) {
+            continue;
+        }
+
+        steal(id);
+
+        //
+        // spin on the queues before paying for a wakeup, still stealing
+        // from the busy workers.
+        if (w->wait.spin([this, w, id, &spins] {
+                return !w->empty() ||
+                       (((++ spins % PARSER_POOL_STEAL_SPINS) == 0) && steal(id));
+            })) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(w->lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &sleep_start);
+        w->sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        w->cond.wait_for(lock, std::chrono::milliseconds(PARSER_POOL_IDLE_WAIT_MS),
+                         [w] { return !w->empty(); });
+        w->sleeping.store(false, std::memory_order_relaxed);
+
+        //
+        // a timed out wait is not a short sleep
+        if (!w->empty()) {
+            w->wait.slept(wait_strategy::elapsed_ns(sleep_start));
+        }
+    }
+}
+
+}
@@ -0,0 +1,165 @@
+/**
+ * @brief - Implements flow affine pool of parser workers.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_PARSER_POOL_H__
+#define __FW_PARSER_POOL_H__
+
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <spsc_ring.h>
+#include <config.h>
+#include <logger.h>
+#include <packet_pool.h>
+#include <parser.h>
+#include <perf.h>
+#include <lang_hints.h>
+#include <cpu_affinity.h>
+
+namespace firewall {
+
+//
+// flows are hashed into buckets, a bucket is owned by one worker at a time
+#define PARSER_POOL_BUCKETS 1024
+//
+// queued frames of a worker before an idle worker steals its buckets
+#define PARSER_POOL_STEAL_BACKLOG 64
+//
+// frames taken from one source before moving on to the next
+#define PARSER_POOL_BATCH 32
+//
+// spinning worker looks for buckets to steal this often
+#define PARSER_POOL_STEAL_SPINS 1024
+
+/**
+ * @brief - Implements a shared pool of parser workers.
+ *
+ * The capture workers of all interfaces are the sources of the pool, each
+ * frame is sent to the worker owning the bucket of its symmetric flow hash.
+ * The frames of a flow are thus parsed in order by one worker, whichever
+ * interface or capture worker received them, and the number of parser
+ * workers does not depend on the number of interfaces.
+ *
+ * An idle worker steals a whole bucket from the most loaded worker. A bucket
+ * moves only when none of its frames are queued or being parsed, so the
+ * order of a flow is kept across the move.
+*/
+class parser_pool {
+    public:
+        /**
+         * @brief - create pool.
+         *
+         * @param [in] cfg - number of parser workers and their wait strategy
+         * @param [in] max_sources - number of capture workers feeding the pool
+         * @param [in] log - logger
+        */
+        explicit parser_pool(const firewall_parser_pool_config &cfg,
+                             uint32_t max_sources, logger *log); THROWS
+        ~parser_pool();
+
+        /**
+         * @brief - register a capture worker as a source of frames.
+         *
+         * Called before start. The capture workers of the sources added
+         * so far may already dispatch frames.
+         *
+         * @param [in] intf_info - interface of the capture worker
+         *
+         * @return source id passed to dispatch.
+        */
+        uint32_t add_source(const firewall_intf_info &intf_info); THROWS
+
+        /**
+         * @brief - start the workers once all the sources are added.
+         *
+         * @param [in] cpus - worker i runs on the i-th cpu, any cpu if empty
+        */
+        void start(const std::vector<uint32_t> &cpus);
+
+        /**
+         * @brief - queue a frame to the worker owning its flow.
+         *
+         * Called only by the capture worker of the source.
+         *
+         * @param [in] src_id - source id
+         * @param [in] pkt - received frame
+         *
+         * @return true if queued, false if the queue of the worker is full.
+        */
+        bool dispatch(uint32_t src_id, packet_ref &&pkt);
+
+        /**
+         * @brief - drop the oldest queued frames of a source.
+         *
+         * Called by the capture worker of the source when it overflows
+         * with the drop head policy, the pool workers do the drop.
+         *
+         * @param [in] src_id - source id
+         * @param [in] n_drops - frames each worker drops
+        */
+        void request_head_drop(uint32_t src_id, uint32_t n_drops);
+
+        uint32_t n_workers() const { return workers_.size(); }
+
+    private:
+        struct pool_item {
+            packet_ref pkt;
+            uint32_t bucket;
+        };
+
+        struct pool_source {
+            std::string ifname;
+        };
+
+        struct pool_worker {
+            //
+            // one queue per source keeps every queue single producer
+            std::vector<std::shared_ptr<spsc_ring<pool_item>>> in;
+            //
+            // parser context of each source, the interface name is
+            // part of the parser.
+            std::vector<std::shared_ptr<parser>> parsers;
+            //
+            // oldest frames to drop from the queue of each source
+            std::unique_ptr<std::atomic<uint32_t>[]> head_drop_req;
+            std::shared_ptr<std::thread> thr_id;
+            //
+            // lock and condition are used only when the worker sleeps
+            std::mutex lock;
+            std::condition_variable cond;
+            std::atomic<bool> sleeping;
+            wait_strategy wait;
+            perf perf_ctx;
+            std::shared_ptr<perf_item> pkt_perf;
+
+            pool_worker() : sleeping(false) { }
+            uint32_t backlog() const;
+            bool empty() const;
+        };
+
+        void worker_thread(uint32_t id);
+        void drop_head(pool_worker *w, uint32_t src_id);
+        bool steal(uint32_t id);
+
+        std::vector<std::shared_ptr<pool_worker>> workers_;
+        std::vector<pool_source> sources_;
+        uint32_t max_sources_;
+        //
+        // owner worker in the high byte, frames of the bucket queued or
+        // being parsed in the low 24 bits.
+        std::atomic<uint32_t> bucket_state_[PARSER_POOL_BUCKETS];
+        //
+        // frames dispatched to the bucket, decays on every steal
+        std::atomic<uint32_t> bucket_hits_[PARSER_POOL_BUCKETS];
+        logger *log_;
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @brief - implements the compiled rule lookup of the rule filters.
+ *
+ * @copyright - 2023-present. All rights reserved. Devendra Naga.
+*/
+#include <algorithm>
+#include <rule_parser.h>
+#include <rule_engine.h>
+
+namespace firewall {
+
+void rule_engine::build(const std::vector<rule_config_item> &rules)
+{
+    uint32_t i;
+
+    l2_.clear();
+    l2_fields_ = 0;
+    icmp_.clear();
+    port_interval_.clear();
+    interval_rules_.clear();
+    port_lists_.clear();
+    port_list_pos_.clear();
+
+    //
+    // positions are added in increasing order, so each list stays sorted
+    for (i = 0; i < rules.size(); i ++) {
+        const rule_config_item &r = rules[i];
+
+        if (r.sig_mask.port_list_sig.port_list) {
+            //
+            // the rules are sorted by priority, those of a level are next
+            // to each other
+            if (port_lists_.empty() || (port_lists_.back().priority != r.priority)) {
+                port_lists_.emplace_back();
+                port_lists_.back().pos = i;
+                port_lists_.back().priority = r.priority;
+                port_list_pos_.push_back(i);
+            }
+
+            port_list_level &level = port_lists_.back();
+            port_map &ports = (r.type == rule_type::Deny) ? level.deny_ports : level.allow_ports;
+
+            for (auto port : r.port_rule.port_list) {
+                ports.add(port);
+            }
+        }
+
+        if (r.sig_mask.eth_sig.from_src) {
+            l2_key k;
+
+            k.src_mac = l2_key::mac(r.eth_rule.from_src);
+            k.mask = static_cast<uint8_t>(L2_Key_Field::Src_Mac);
+            l2_.add(k, i);
+            l2_fields_ |= k.mask;
+        }
+        if (r.sig_mask.eth_sig.to_dst) {
+            l2_key k;
+
+            k.dst_mac = l2_key::mac(r.eth_rule.to_dst);
+            k.mask = static_cast<uint8_t>(L2_Key_Field::Dst_Mac);
+            l2_.add(k, i);
+            l2_fields_ |= k.mask;
+        }
+        if (r.sig_mask.eth_sig.ethertype) {
+            l2_key k;
+
+            k.ethertype = r.eth_rule.ethertype;
+            k.mask = static_cast<uint8_t>(L2_Key_Field::Ethertype);
+            l2_.add(k, i);
+            l2_fields_ |= k.mask;
+        }
+        if (r.sig_mask.vlan_sig.vid) {
+            l2_key k;
+
+            k.vid = r.vlan_rule.vid;
+            k.mask = static_cast<uint8_t>(L2_Key_Field::Vid);
+            l2_.add(k, i);
+            l2_fields_ |= k.mask;
+        }
+        if (r.sig_mask.icmp_sig.icmp_non_zero_payload)
+            icmp_.push_back(i);
+    }
+
+    build_port_ranges(rules);
+}
+
+static bool is_range_rule(const rule_config_item &r)
+{
+    return r.sig_mask.port_list_sig.port_range &&
+           (r.port_rule.port_range_min <= r.port_rule.port_range_max) &&
+           (r.port_rule.port_range_min <= UINT16_MAX);
+}
+
+void rule_engine::build_port_ranges(const std::vector<rule_config_item> &rules)
+{
+    std::vector<uint32_t> ends;
+    uint32_t interval;
+    uint32_t port;
+    uint32_t max;
+    uint32_t i;
+
+    for (auto &r : rules) {
+        if (is_range_rule(r)) {
+            ends.push_back(r.port_rule.port_range_min);
+            ends.push_back(std::min<uint32_t>(r.port_rule.port_range_max, UINT16_MAX) + 1);
+        }
+    }
+
+    if (ends.empty()) {
+        return;
+    }
+
+    //
+    // each interval starts at an end of a range and runs up to the next
+    ends.push_back(0);
+    ends.push_back(UINT16_MAX + 1);
+    std::sort(ends.begin(), ends.end());
+    ends.erase(std::unique(ends.begin(), ends.end()), ends.end());
+
+    port_interval_.resize(UINT16_MAX + 1);
+    interval_rules_.resize(ends.size() - 1);
+    for (interval = 0; interval + 1 < ends.size(); interval ++) {
+        for (port = ends[interval]; port < ends[interval + 1]; port ++) {
+            port_interval_[port] = interval;
+        }
+    }
+
+    //
+    // positions are added in increasing order, so each list stays sorted
+    for (i = 0; i < rules.size(); i ++) {
+        const rule_config_item &r = rules[i];
+
+        if (!is_range_rule(r)) {
+            continue;
+        }
+
+        max = std::min<uint32_t>(r.port_rule.port_range_max, UINT16_MAX);
+        for (interval = port_interval_[r.port_rule.port_range_min];
+             (interval < interval_rules_.size()) && (ends[interval] <= max);
+             interval ++) {
+            interval_rules_[interval].push_back(i);
+        }
+    }
+}
+
+void rule_engine::lookup(const rule_lookup_fields &f, rule_candidates &c) const
+{
+    c.n_lists = 0;
+
+    if (l2_fields_ & static_cast<uint8_t>(L2_Key_Field::Src_Mac)) {
+        l2_key k;
+
+        k.src_mac = l2_key::mac(f.src_mac);
+        lookup_l2(k, L2_Key_Field::Src_Mac, c);
+    }
+
+    if (l2_fields_ & static_cast<uint8_t>(L2_Key_Field::Dst_Mac)) {
+        l2_key k;
+
+        k.dst_mac = l2_key::mac(f.dst_mac);
+        lookup_l2(k, L2_Key_Field::Dst_Mac, c);
+    }
+
+    if (l2_fields_ & static_cast<uint8_t>(L2_Key_Field::Ethertype)) {
+        l2_key k;
+
+        k.ethertype = f.ethertype;
+        lookup_l2(k, L2_Key_Field::Ethertype, c);
+    }
+
+    if (f.has_vlan && (l2_fields_ & static_cast<uint8_t>(L2_Key_Field::Vid))) {
+        l2_key k;
+
+        k.vid = f.vid;
+        lookup_l2(k, L2_Key_Field::Vid, c);
+    }
+
+    if (f.has_icmp)
+        c.add(icmp_);
+
+    if (f.has_port && !port_interval_.empty()) {
+        uint32_t src = port_interval_[f.src_port];
+        uint32_t dst = port_interval_[f.dst_port];
+
+        c.add(interval_rules_[src]);
+        if (dst != src)
+            c.add(interval_rules_[dst]);
+    }
+
+    //
+    // a packet without ports is not matched by the port lists
+    if (f.has_port)
+        c.add(port_list_pos_);
+}
+
+}
@@ -0,0 +1,238 @@
+/**
+ * @brief - Implements the compiled rule lookup of the rule filters.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_RULE_ENGINE_H__
+#define __FW_RULE_ENGINE_H__
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <l2_rule_table.h>
+
+namespace firewall {
+
+struct rule_config_item;
+
+/**
+ * @brief - rules that may apply to a packet, in the order they run.
+ *
+ * Holds up to one sorted list of rule positions per key of the packet,
+ * next() merges them on the fly so no list is copied.
+*/
+struct rule_candidates {
+    //
+    // rule_engine::lookup adds one list per L2_Key_Field, one for icmp,
+    // one each for the src and dst port intervals and one for the port
+    // lists
+    static constexpr uint32_t max_lists = L2_KEY_FIELD_COUNT + 1 + 2 + 1;
+
+    explicit rule_candidates() : n_lists(0) { }
+    ~rule_candidates() { }
+
+    inline void add(const std::vector<uint32_t> &list)
+    {
+        //
+        // max_lists covers every list of a lookup, the check only keeps a
+        // new key in the lookup from writing past the arrays
+        if (!list.empty() && (n_lists < max_lists)) {
+            pos[n_lists] = list.data();
+            end[n_lists] = list.data() + list.size();
+            n_lists ++;
+        }
+    }
+
+    /**
+     * @brief - get the next rule, a rule found under several keys is
+     *          returned once.
+     *
+     * @param [out] rule_pos - position of the rule in the rule list
+     *
+     * @return true if a rule is returned, false if no rules are left.
+    */
+    inline bool next(uint32_t &rule_pos)
+    {
+        uint32_t min = UINT32_MAX;
+        uint32_t i;
+
+        for (i = 0; i < n_lists; i ++) {
+            if ((pos[i] != end[i]) && (*pos[i] < min)) {
+                min = *pos[i];
+            }
+        }
+
+        if (min == UINT32_MAX) {
+            return false;
+        }
+
+        for (i = 0; i < n_lists; i ++) {
+            if ((pos[i] != end[i]) && (*pos[i] == min)) {
+                pos[i] ++;
+            }
+        }
+
+        rule_pos = min;
+        return true;
+    }
+
+    const uint32_t *pos[max_lists];
+    const uint32_t *end[max_lists];
+    uint32_t n_lists;
+};
+
+//
+// one bit per port
+#define PORT_MAP_WORDS (65536 / 64)
+
+/**
+ * @brief - set of ports as a 65536 bit map, empty until a port is added.
+*/
+struct port_map {
+    explicit port_map() { }
+    ~port_map() { }
+
+    void add(uint16_t port)
+    {
+        if (bits.empty())
+            bits.assign(PORT_MAP_WORDS, 0);
+
+        bits[port / 64] |= 1ULL << (port % 64);
+    }
+
+    void clear() { bits.clear(); }
+    bool empty() const { return bits.empty(); }
+
+    inline bool has(uint16_t port) const
+    {
+        return !!(bits[port / 64] & (1ULL << (port % 64)));
+    }
+
+    std::vector<uint64_t> bits;
+};
+
+/**
+ * @brief - port lists of the rules of one priority, merged.
+*/
+struct port_list_level {
+    // position of the first port list rule of the level, the lists run
+    // at this position of the rule walk
+    uint32_t pos;
+    uint32_t priority;
+    // ports of the allow and event rules
+    port_map allow_ports;
+    // ports of the deny rules
+    port_map deny_ports;
+
+    explicit port_list_level() : pos(0), priority(0) { }
+    ~port_list_level() { }
+};
+
+/**
+ * @brief - fields of a packet that the rules are looked up with.
+*/
+struct rule_lookup_fields {
+    const uint8_t *src_mac;
+    const uint8_t *dst_mac;
+    uint16_t ethertype;
+    bool has_vlan;
+    // valid if has_vlan
+    uint16_t vid;
+    bool has_icmp;
+    // tcp or udp
+    bool has_port;
+    // valid if has_port
+    uint16_t src_port;
+    uint16_t dst_port;
+};
+
+/**
+ * @brief - rule list compiled into lookup tables at load time.
+ *
+ * Each rule is filed under the fields its filters compare: source mac,
+ * destination mac, ethertype and vlan id for the ethernet filter, and the
+ * icmp protocol for the icmp filter. The ethernet filter matches a rule on
+ * any one of its fields, so a rule is filed once per field, with the other
+ * fields wildcarded, and a frame looks up one key per field in use.
+ *
+ * Port ranges are cut into elementary intervals at their ends, each
+ * interval lists the range rules that cover it and every port maps to its
+ * interval, so the src and dst ports take one load each. The port lists
+ * of the rules of one priority are merged into one map of the allow rules
+ * and one of the deny rules. Each level is filed under the position of
+ * its first port list rule, for every packet with ports, so the lists
+ * run in the order of their priority with one bit test per port.
+ * A packet looks up its own fields and runs only the rules found, the
+ * cost follows the number of rules that can match and not the size of
+ * the rule list. Rules that no filter reads are not filed.
+ *
+ * The lists hold the positions of the rules in the rule list, which is
+ * sorted by priority, so a smaller position runs first.
+*/
+class rule_engine {
+    public:
+        explicit rule_engine() : l2_fields_(0) { }
+        ~rule_engine() { }
+
+        /**
+         * @brief - compile the rules.
+         *
+         * @param [in] rules - rules sorted by priority
+        */
+        void build(const std::vector<rule_config_item> &rules);
+
+        /**
+         * @brief - find the rules that may apply to a packet.
+         *
+         * @param [in] f - fields of the packet
+         * @param [out] c - rules to run
+        */
+        void lookup(const rule_lookup_fields &f, rule_candidates &c) const;
+
+        /**
+         * @brief - get the port lists that run at a position of the walk.
+         *
+         * @param [in] pos - position of the rule in the rule list
+         *
+         * @return port lists of the level, nullptr if no level starts there.
+        */
+        const port_list_level *get_port_lists(uint32_t pos) const
+        {
+            auto it = std::lower_bound(port_list_pos_.begin(), port_list_pos_.end(), pos);
+
+            if ((it == port_list_pos_.end()) || (*it != pos))
+                return nullptr;
+
+            return &port_lists_[it - port_list_pos_.begin()];
+        }
+
+    private:
+        void build_port_ranges(const std::vector<rule_config_item> &rules);
+
+        void lookup_l2(l2_key &k, L2_Key_Field f, rule_candidates &c) const
+        {
+            const std::vector<uint32_t> *list;
+
+            k.mask = static_cast<uint8_t>(f);
+            list = l2_.find(k);
+            if (list)
+                c.add(*list);
+        }
+
+        l2_rule_table l2_;
+        // L2_Key_Field of the keys in the table
+        uint8_t l2_fields_;
+        std::vector<uint32_t> icmp_;
+        // interval of each port, empty if there are no range rules
+        std::vector<uint32_t> port_interval_;
+        // range rules covering each interval
+        std::vector<std::vector<uint32_t>> interval_rules_;
+        // port lists per priority, in the order of the walk
+        std::vector<port_list_level> port_lists_;
+        // position of each level in port_lists_
+        std::vector<uint32_t> port_list_pos_;
+};
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 */
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <jsoncpp/json/json.h>
 #include <rule_parser.h>
 
@@ -293,6 +294,7 @@ void rule_config_item::print()
     log->verbose("\t rule_name: %s\n", rule_name.c_str());
     log->verbose("\t rule_id: %d\n", rule_id);
     log->verbose("\t type: %d\n", type);
+    log->verbose("\t priority: %u\n", priority);
 
     eth_rule.print(log);
     vlan_rule.print(log);
@@ -313,6 +315,9 @@ fw_error_type rule_config::parse_rule(Json::Value &rule_cfg_data)
 
     rule.rule_name = rule_cfg_data["rule_name"].asString();
     rule.rule_id = rule_cfg_data["rule_id"].asUInt();
+    if (rule_cfg_data.isMember("priority")) {
+        rule.priority = rule_cfg_data["priority"].asUInt();
+    }
 
     auto rule_type = rule_cfg_data["rule_type"].asString();
     if (rule_type == "allow") {
@@ -340,6 +345,39 @@ fw_error_type rule_config::parse_rule(Json::Value &rule_cfg_data)
     return fw_error_type::eNo_Error;
 }
 
+uint32_t rule_config_item::get_layers() const
+{
+    uint32_t layers = 0;
+
+    if (sig_mask.eth_sig.from_src || sig_mask.eth_sig.to_dst ||
+        sig_mask.eth_sig.ethertype ||
+        sig_mask.vlan_sig.vlan_pri || sig_mask.vlan_sig.vid) {
+        layers |= static_cast<uint32_t>(Rule_Layer::L2);
+    }
+
+    if (sig_mask.ipv4_sig.ipv4_check_options ||
+        sig_mask.ipv4_sig.ipv4_protocol ||
+        sig_mask.protocol_list_sig.protocol_list) {
+        layers |= static_cast<uint32_t>(Rule_Layer::L3);
+    }
+
+    if (sig_mask.icmp_sig.icmp_non_zero_payload ||
+        sig_mask.port_list_sig.port_list ||
+        sig_mask.port_list_sig.port_range) {
+        layers |= static_cast<uint32_t>(Rule_Layer::L4);
+    }
+
+    //
+    // udp port rules select the application parser of the port
+    if (sig_mask.udp_sig.port ||
+        sig_mask.someip_sig.service_id || sig_mask.someip_sig.method_id) {
+        layers |= static_cast<uint32_t>(Rule_Layer::L4) |
+                  static_cast<uint32_t>(Rule_Layer::App);
+    }
+
+    return layers;
+}
+
 fw_error_type rule_config::parse(const std::string rules_file)
 {
     Json::Value root;
@@ -354,6 +392,20 @@ fw_error_type rule_config::parse(const std::string rules_file)
     return fw_error_type::eNo_Error;
 }
 
+void rule_config::build()
+{
+    required_layers_ = 0;
+    for (auto &it : rules_cfg_) {
+        required_layers_ |= it.get_layers();
+    }
+
+    std::stable_sort(rules_cfg_.begin(), rules_cfg_.end(),
+                     [](const rule_config_item &a, const rule_config_item &b) {
+                         return a.priority < b.priority;
+                     });
+    engine_.build(rules_cfg_);
+}
+
 void signature_id_bitmask::print(logger *log)
 {
 #if defined(FW_ENABLE_DEBUG)
@@ -11,6 +11,7 @@
 #include <logger.h>
 #include <common.h>
 #include <protocols_types.h>
+#include <rule_engine.h>
 
 namespace firewall {
 
@@ -241,6 +242,16 @@ struct signature_id_bitmask {
     void print(logger *log);
 };
 
+/**
+ * @brief - protocol layers that are read by the rules.
+*/
+enum class Rule_Layer : uint32_t {
+    L2 = 0x01,
+    L3 = 0x02,
+    L4 = 0x04,
+    App = 0x08,
+};
+
 /**
  * @brief - defines an enclosed rule configuration structure holds
  *          information about each rule item.
@@ -249,6 +260,8 @@ struct rule_config_item {
     std::string rule_name;
     uint32_t rule_id;
     rule_type type;
+    // rules run in increasing priority, then in the order of the file
+    uint32_t priority;
     eth_rule_config eth_rule;
     vlan_rule_config vlan_rule;
     ipv4_rule_config ipv4_rule;
@@ -258,12 +271,19 @@ struct rule_config_item {
     port_rule_config port_rule;
     protocol_rule_config protocol_rule;
     signature_id_bitmask sig_mask;
-    signature_id_bitmask sig_detected;
+
+    /**
+     * @brief - get the layers that this rule reads.
+     *
+     * @return bitmask of Rule_Layer.
+    */
+    uint32_t get_layers() const;
 
     explicit rule_config_item() :
                 rule_name(""),
                 rule_id(0),
-                type(rule_type::Deny)
+                type(rule_type::Deny),
+                priority(0)
     {
         sig_mask.init();
     }
@@ -295,12 +315,38 @@ struct rule_config {
     const rule_config &&operator=(const rule_config &&) = delete;
 
     /**
-     * @brief - parse rules.
+     * @brief - parse rules, the rules are added to the loaded ones.
     */
     fw_error_type parse(const std::string rules_file);
 
+    /**
+     * @brief - sort the loaded rules by priority and compile them.
+     *
+     * Called once all the rules files are parsed and before any parser
+     * is created, the rules are read only afterwards.
+    */
+    void build();
+
+    /**
+     * @brief - get the layers read by all the loaded rules.
+     *
+     * Computed by build().
+     *
+     * @return bitmask of Rule_Layer.
+    */
+    uint32_t get_required_layers() const { return required_layers_; }
+
+    /**
+     * @brief - get the rules compiled into lookup tables.
+     *
+     * Built by build(), along with the order of rules_cfg_.
+    */
+    const rule_engine &get_engine() const { return engine_; }
+
     private:
-        explicit rule_config() { }
+        explicit rule_config() : required_layers_(0) { }
+        uint32_t required_layers_;
+        rule_engine engine_;
         fw_error_type parse_rule(Json::Value &it);
         void parse_eth_rule(Json::Value &it, rule_config_item &item);
         void parse_vlan_rule(Json::Value &it, rule_config_item &item);
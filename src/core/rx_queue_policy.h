@@ -0,0 +1,74 @@
+/**
+ * @brief - Implements overload policy of the rx queues.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_RX_QUEUE_POLICY_H__
+#define __FW_RX_QUEUE_POLICY_H__
+
+#include <stdint.h>
+#include <config.h>
+#include <packet_pool.h>
+#include <frame_class.h>
+
+namespace firewall {
+
+//
+// part of the queue dropped from the head once it overflows
+#define RX_QUEUE_HEAD_DROP_DIV 8
+
+/**
+ * @brief - check if a frame may be queued, called by the rx thread.
+ *
+ * The queues hold packets of the pool and are as large as the pool, so
+ * the pool runs out first and its use is the queue depth. With the
+ * priority policy, bulk frames are refused once only the reserved packets
+ * are left, the frame is classified only then.
+ *
+ * @param [in] cfg - rx queue policy of the interface
+ * @param [in] pool - packet pool of the frame
+ * @param [in] pkt - received frame
+ *
+ * @return true if the frame may be queued, false if it is dropped as bulk.
+*/
+static inline bool rx_queue_admit(const firewall_rx_queue_config &cfg,
+                                  const packet_pool &pool,
+                                  const packet &pkt)
+{
+    if (cfg.drop_policy != Queue_Drop_Policy::Priority) {
+        return true;
+    }
+
+    if (pool.in_use() + cfg.priority_reserve < pool.count()) {
+        return true;
+    }
+
+    return frame_is_priority(pkt.buf, pkt.buf_len);
+}
+
+/**
+ * @brief - oldest frames the consumer drops after the queue overflowed.
+ *
+ * Only the consumer may pop, so the producer drops the frame that found
+ * the queue or the pool full and asks the consumer to drop from the head.
+ * The frames after it find room, fresh traffic is kept over the stale
+ * backlog.
+ *
+ * @param [in] cfg - rx queue policy of the interface
+ * @param [in] capacity - packets the queue holds
+ *
+ * @return frames to drop, 0 if the policy is not drop head.
+*/
+static inline uint32_t rx_queue_head_drops(const firewall_rx_queue_config &cfg,
+                                           uint32_t capacity)
+{
+    if (cfg.drop_policy != Queue_Drop_Policy::Drop_Head) {
+        return 0;
+    }
+
+    return (capacity / RX_QUEUE_HEAD_DROP_DIV) ? capacity / RX_QUEUE_HEAD_DROP_DIV : 1;
+}
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @brief - Implements flow sampling of the rx path under overload.
+ *
+ * @copyright - 2023-present All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_RX_SAMPLER_H__
+#define __FW_RX_SAMPLER_H__
+
+#include <stdint.h>
+#include <string>
+#include <config.h>
+#include <packet_pool.h>
+#include <flow_hash.h>
+#include <packet_stats.h>
+
+namespace firewall {
+
+//
+// pool use is checked once every these many frames
+#define RX_SAMPLER_CHECK_FRAMES 256
+
+/**
+ * @brief - inspects 1 in N flows while the packet pool stays backed up.
+ *
+ * A flow is kept if the top log2(N) bits of its hash are zero, so both
+ * directions of a flow are kept or left out together and a kept flow
+ * stays kept as the rate changes. The low bits of the hash pick the
+ * parser pool bucket and are not used. Used only by the rx thread.
+*/
+class rx_sampler {
+    public:
+        explicit rx_sampler() :
+                        enable_(false),
+                        high_(0),
+                        low_(0),
+                        max_shift_(0),
+                        shift_(0),
+                        n_frames_(0)
+        { }
+
+        void init(const std::string &ifname,
+                  const firewall_sampling_config &cfg,
+                  uint32_t pool_count)
+        {
+            ifname_ = ifname;
+            enable_ = cfg.enable;
+            high_ = (uint64_t)pool_count * cfg.high_watermark_pct / 100;
+            low_ = (uint64_t)pool_count * cfg.low_watermark_pct / 100;
+            max_shift_ = __builtin_ctz(cfg.max_rate);
+        }
+
+        /**
+         * @brief - check if a received frame is inspected.
+         *
+         * @param [in] pool - packet pool of the frame
+         * @param [inout] pkt - received frame, gets the current rate
+         *
+         * @return true if inspected, false if the flow is left out.
+        */
+        inline bool sample(const packet_pool &pool, packet &pkt)
+        {
+            if (!enable_) {
+                return true;
+            }
+
+            tick(pool);
+
+            if (shift_ == 0) {
+                return true;
+            }
+
+            pkt.sample_rate = 1U << shift_;
+
+            return (flow_hash(pkt.buf, pkt.buf_len) >> (32 - shift_)) == 0;
+        }
+
+        /**
+         * @brief - count a frame dropped before it could be sampled.
+         *
+         * Once the pool is exhausted no frame reaches sample(), the
+         * drops keep the rate moving.
+         *
+         * @param [in] pool - packet pool of the interface
+        */
+        inline void tick(const packet_pool &pool)
+        {
+            if (enable_ && ((++ n_frames_ % RX_SAMPLER_CHECK_FRAMES) == 0)) {
+                adjust(pool.in_use());
+            }
+        }
+
+    private:
+        void adjust(uint32_t in_use)
+        {
+            uint32_t shift = shift_;
+
+            if ((in_use >= high_) && (shift_ < max_shift_)) {
+                shift ++;
+            } else if ((in_use <= low_) && (shift_ > 0)) {
+                shift --;
+            }
+
+            if (shift != shift_) {
+                shift_ = shift;
+                firewall_pkt_stats::instance()->set_sample_rate(ifname_, 1U << shift_);
+            }
+        }
+
+        std::string ifname_;
+        bool enable_;
+        // watermarks in packets of the pool
+        uint32_t high_;
+        uint32_t low_;
+        uint32_t max_shift_;
+        // current rate is 1 << shift_
+        uint32_t shift_;
+        uint32_t n_frames_;
+};
+
+}
+
+#endif
@@ -8,6 +8,7 @@
 
 #include <cstring>
 #include <stdint.h>
+#include <time.h>
 #include <event_def.h>
 
 namespace firewall {
@@ -34,6 +35,10 @@ struct event {
     uint32_t src_port;
     uint32_t dst_port;
     uint32_t pkt_len;
+    // receive timestamp of the packet (CLOCK_REALTIME)
+    struct timespec ts;
+    // 1 in sample_rate flows was inspected when the event was seen
+    uint32_t sample_rate;
 
     explicit event() : evt_type(event_type::Evt_Deny),
                        evt_details(event_description::Evt_Unknown_Error),
@@ -45,7 +50,9 @@ struct event {
                        protocol(0),
                        src_port(0),
                        dst_port(0),
-                       pkt_len(0)
+                       pkt_len(0),
+                       ts(),
+                       sample_rate(1)
     {
         std::memset(src_mac, 0, sizeof(src_mac));
         std::memset(dst_mac, 0, sizeof(dst_mac));
@@ -66,6 +66,7 @@ enum class rule_ids : uint32_t {
     Rule_Id_IPv4_Strict_Source_Route_Len_Truncated,
     Rule_Id_IPv4_Invalid_Total_Len,
     Rule_Id_IPv4_Total_Len_Smaller_Than_Hdr_Len,
+    Rule_Id_IPv4_Opt_Len_Inval,
 
     //
     // IPv6 Rule Ids
@@ -81,6 +82,7 @@ enum class rule_ids : uint32_t {
     Rule_Id_Icmp6_Icmp6_Type_Unsupported = 601,
     Rule_Id_Icmp6_Mcast_Listener_Inval_Rec_Len,
     Rule_Id_Icmp6_Echo_Req_Hdr_Len_Too_Short,
+    Rule_Id_Icmp6_Chksum_Invalid,
 
     //
     // TCP Rule Ids
@@ -98,6 +100,7 @@ enum class rule_ids : uint32_t {
     Rule_Id_Tcp_Src_Port_Zero,
     Rule_Id_Tcp_Dst_Port_Zero,
     Rule_Id_Tcp_Opt_MSS_Len_Inval,
+    Rule_Id_Tcp_Chksum_Invalid,
 
     //
     // UDP Rule Ids
@@ -142,6 +145,8 @@ enum class rule_ids : uint32_t {
     Rule_Id_DHCP_Opt_Ipaddr_Lease_Time_Len_Inval,
     Rule_Id_DHCP_Opt_Server_Id_Len_Inval,
     Rule_Id_DHCP_Hdr_Len_Too_Short,
+    Rule_Id_DHCP_Opt_Len_Inval,
+    Rule_Id_DHCP_Opt_List_Overflow,
 
     //
     // TLS Rule Ids
@@ -195,6 +200,12 @@ enum class rule_ids : uint32_t {
     Rule_Id_VRRP_Invalid_Hdr_Len = 2401,
     Rule_Id_VRRP_Invalid_V2_Hdr_Len = 2402,
 
+    //
+    // IP list Rule Ids
+    Rule_Id_IP_Src_Blacklisted = 2501,
+    Rule_Id_IP_Dst_Blacklisted = 2502,
+    Rule_Id_IP_Not_In_Network_Map = 2503,
+
     //
     // Known Malware / Virus / Explit Rule Ids
     Rule_Id_Known_Exploit_Win32_Blaster = 10001,
@@ -257,6 +268,7 @@ enum class event_description : uint32_t {
     Evt_IPv4_Strict_Source_Route_Len_Truncated,
     Evt_IPv4_Invalid_Total_Len,
     Evt_IPv4_Total_Len_Smaller_Than_Hdr_Len,
+    Evt_IPv4_Opt_Len_Inval,
 
     //
     // IPv6 events
@@ -272,6 +284,7 @@ enum class event_description : uint32_t {
     Evt_Icmp6_Icmp6_Type_Unsupported = 601,
     Evt_Icmp6_Mcast_Listener_Inval_Rec_Len,
     Evt_Icmp6_Echo_Req_Hdr_Len_Too_Short,
+    Evt_Icmp6_Chksum_Invalid,
 
     //
     // TCP events
@@ -289,6 +302,7 @@ enum class event_description : uint32_t {
     Evt_Tcp_Src_Port_Zero,
     Evt_Tcp_Dst_Port_Zero,
     Evt_Tcp_Opt_MSS_Len_Inval,
+    Evt_Tcp_Chksum_Invalid,
 
     //
     // UDP events
@@ -335,6 +349,8 @@ enum class event_description : uint32_t {
     Evt_DHCP_Opt_Ipaddr_Lease_Time_Len_Inval,
     Evt_DHCP_Opt_Server_Id_Len_Inval,
     Evt_DHCP_Hdr_Len_Too_Short,
+    Evt_DHCP_Opt_Len_Inval,
+    Evt_DHCP_Opt_List_Overflow,
 
     //
     // TLS events
@@ -391,6 +407,12 @@ enum class event_description : uint32_t {
     Evt_VRRP_Invalid_Hdr_Len = 2401,
     Evt_VRRP_Invalid_V2_Hdr_Len = 2402,
 
+    //
+    // IP list events
+    Evt_IP_Src_Blacklisted = 2501,
+    Evt_IP_Dst_Blacklisted = 2502,
+    Evt_IP_Not_In_Network_Map = 2503,
+
     //
     // Known virus / exploit / worm / malware events
     Evt_Known_Exploit_Win32_Blaster = 10000,
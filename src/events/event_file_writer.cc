@@ -84,6 +84,9 @@ fw_error_type event_file_writer::write(const event &evt)
     msg->evt_desc = evt.evt_details;
     msg->rule_id = evt.rule_id;
     msg->ethertype = evt.ethertype;
+    msg->ts_sec = evt.ts.tv_sec;
+    msg->ts_nsec = evt.ts.tv_nsec;
+    msg->sample_rate = evt.sample_rate;
 
     total_len += sizeof(event_msg);
 
@@ -146,6 +149,11 @@ fw_error_type event_file_writer::write_json(const event &evt)
                     "\t\"event_description\": %d,\n", static_cast<uint32_t>(evt.evt_details));
     len += snprintf(buf + len, sizeof(buf) - len,
                     "\t\"rule_id\": %d,\n", static_cast<uint32_t>(evt.rule_id));
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    "\t\"timestamp\": \"%ld.%09ld\",\n",
+                    static_cast<long>(evt.ts.tv_sec), static_cast<long>(evt.ts.tv_nsec));
+    len += snprintf(buf + len, sizeof(buf) - len,
+                    "\t\"sample_rate\": %u,\n", evt.sample_rate);
     src_mac_to_str(evt.src_mac, mac_str);
     len += snprintf(buf + len, sizeof(buf) - len,
                     "\t\"src_mac\": \"%s\",\n", mac_str);
@@ -4,6 +4,8 @@
  * @copyright - 2023-present All rights reserved. Devendra Naga.
 */
 #include <syslog.h>
+#include <cpu_affinity.h>
+#include <packet_stats.h>
 #include <event_mgr.h>
 
 namespace firewall {
@@ -232,6 +234,12 @@ const static struct {
         rule_ids::Rule_Id_IPv4_Total_Len_Smaller_Than_Hdr_Len,
         "IPv4 total length is smaller than header length"
     },
+    {
+        event_description::Evt_IPv4_Opt_Len_Inval,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_IPv4_Opt_Len_Inval,
+        "IPv4 options: option length is invalid or exceeds header length"
+    },
 
     //
     // IPsec rules
@@ -375,6 +383,12 @@ const static struct {
         rule_ids::Rule_Id_Tcp_Opt_MSS_Len_Inval,
         "TCP MSS Length is invalid"
     },
+    {
+        event_description::Evt_Tcp_Chksum_Invalid,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_Tcp_Chksum_Invalid,
+        "TCP checksum is invalid"
+    },
 
     //
     // UDP rules
@@ -587,6 +601,20 @@ const static struct {
         rule_ids::Rule_Id_DHCP_Hdr_Len_Too_Short,
         "DHCP default header length (no options) is too small"
     },
+    {
+        event_description::Evt_DHCP_Opt_Len_Inval,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_DHCP_Opt_Len_Inval,
+        "DHCP options: option length exceeds the packet"
+    },
+    {
+        event_description::Evt_DHCP_Opt_List_Overflow,
+        //
+        // the option is valid but has more entries than we keep
+        Event_Confidence::Medium,
+        rule_ids::Rule_Id_DHCP_Opt_List_Overflow,
+        "DHCP options: too many entries in an option list"
+    },
 
     //
     // ICMP6 rules
@@ -608,6 +636,12 @@ const static struct {
         rule_ids::Rule_Id_Icmp6_Echo_Req_Hdr_Len_Too_Short,
         "ICMP6 echo request header length is too short"
     },
+    {
+        event_description::Evt_Icmp6_Chksum_Invalid,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_Icmp6_Chksum_Invalid,
+        "ICMP6 checksum is invalid"
+    },
 
     //
     // DoIP rules
@@ -700,6 +734,27 @@ const static struct {
         "VRRP Invalid V2 Header Length",
     },
 
+    //
+    // Rules matched by the IP lists
+    {
+        event_description::Evt_IP_Src_Blacklisted,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_IP_Src_Blacklisted,
+        "Source IP address is blacklisted",
+    },
+    {
+        event_description::Evt_IP_Dst_Blacklisted,
+        Event_Confidence::Full,
+        rule_ids::Rule_Id_IP_Dst_Blacklisted,
+        "Destination IP address is blacklisted",
+    },
+    {
+        event_description::Evt_IP_Not_In_Network_Map,
+        Event_Confidence::High,
+        rule_ids::Rule_Id_IP_Not_In_Network_Map,
+        "Neither IP address is in the network map",
+    },
+
     //
     // Rules matched by the Exploit filter
     {
@@ -762,19 +817,15 @@ void event_mgr::create_l4_evt(event &evt,
 {
     int protocol = -1;
 
-    if (pkt.protocols_avail.has_ipv4())
-        protocol = pkt.ipv4_h.protocol;
-    else if (pkt.protocols_avail.has_ipv6())
-        protocol = pkt.ipv6_h.nh;
+    if (pkt.protocols_avail.has_ipv4() ||
+        pkt.protocols_avail.has_ipv6())
+        protocol = pkt.get_ip_protocol();
 
     switch (static_cast<protocols_types>(protocol)) {
-        case protocols_types::Protocol_Tcp: {
-            evt.src_port = pkt.tcp_h.src_port;
-            evt.dst_port = pkt.tcp_h.dst_port;
-        } break;
+        case protocols_types::Protocol_Tcp:
         case protocols_types::Protocol_Udp: {
-            evt.src_port = pkt.udp_h.src_port;
-            evt.dst_port = pkt.udp_h.dst_port;
+            evt.src_port = static_cast<uint16_t>(pkt.get_src_port());
+            evt.dst_port = static_cast<uint16_t>(pkt.get_dst_port());
         } break;
         default:
             return;
@@ -794,27 +845,26 @@ void event_mgr::create_evt(event &evt,
     evt.evt_details = evt_details;
     evt.rule_id = rule_id;
 
-    std::memcpy(evt.src_mac, pkt.eh.src_mac, sizeof(pkt.eh.src_mac));
-    std::memcpy(evt.dst_mac, pkt.eh.dst_mac, sizeof(pkt.eh.dst_mac));
+    std::memcpy(evt.src_mac, pkt.get_src_mac(), FW_MACADDR_LEN);
+    std::memcpy(evt.dst_mac, pkt.get_dst_mac(), FW_MACADDR_LEN);
 
     //
     // if vlan header is present, get ethertype from vlan header
-    evt.ethertype = pkt.eh.ethertype;
-    if (pkt.protocols_avail.has_vlan()) {
-        evt.ethertype = pkt.vh.ethertype;
-    }
+    evt.ethertype = pkt.get_l3_ethertype();
 
     switch (evt.ethertype) {
         case static_cast<uint16_t>(Ether_Type::Ether_Type_IPv4):
-            evt.protocol = pkt.ipv4_h.protocol;
-            evt.ttl = pkt.ipv4_h.ttl;
-            evt.src_addr = pkt.ipv4_h.src_addr;
-            evt.dst_addr = pkt.ipv4_h.dst_addr;
+            evt.protocol = pkt.get_ip_protocol();
+            evt.ttl = pkt.get_ttl();
+            evt.src_addr = pkt.get_ipv4_src_addr();
+            evt.dst_addr = pkt.get_ipv4_dst_addr();
 
             create_l4_evt(evt, pkt);
         break;
     }
     evt.pkt_len = pkt.pkt_len;
+    evt.ts = pkt.rx_ts;
+    evt.sample_rate = pkt.sample_rate;
 }
 
 fw_error_type event_mgr::init(logger *log)
@@ -828,6 +878,12 @@ fw_error_type event_mgr::init(logger *log)
     // create storage thread
     storage_thr_id_ = std::make_shared<std::thread>(
                         &event_mgr::storage_thread, this);
+
+    if (cpu_affinity_set(storage_thr_id_->native_handle(),
+                         fw_conf->affinity.housekeeping_cpus) < 0) {
+        log_->error("evt_mgr::init: failed to pin storage thread\n");
+    }
+
     storage_thr_id_->detach();
 
     log_->info("evt_mgr::init: create storage thread ok\n");
@@ -855,10 +911,22 @@ fw_error_type event_mgr::init(logger *log)
     return fw_error_type::eNo_Error;
 }
 
-void event_mgr::store(event &evt)
+void event_mgr::store(event &evt, const std::string &ifname)
 {
+    firewall_config *conf = firewall_config::instance();
+
     {
         std::unique_lock<std::mutex> lock(storage_thr_lock_);
+
+        //
+        // storage thread fell behind, keep the queue bounded.
+        if (event_list_.size() >= conf->evt_config.queue_size) {
+            firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Event_Queue_Full, ifname);
+            if (conf->evt_config.queue_drop_policy != Queue_Drop_Policy::Drop_Head) {
+                return;
+            }
+            event_list_.pop();
+        }
         event_list_.push(evt);
     }
 }
@@ -897,7 +965,7 @@ void event_mgr::store(event_type evt_type,
     event evt;
 
     create_evt(evt, get_matching_rule(evt_desc), evt_type, evt_desc, pkt);
-    store(evt);
+    store(evt, pkt.get_ifname());
 }
 
 void event_mgr::store(event_type evt_type,
@@ -908,7 +976,7 @@ void event_mgr::store(event_type evt_type,
     event evt;
 
     create_evt(evt, rule_id, evt_type, evt_desc, pkt);
-    store(evt);
+    store(evt, pkt.get_ifname());
 }
 
 /**
@@ -986,7 +1054,9 @@ void event_mgr::make_evt_string(event &evt, std::string &fmt)
     int len = 0;
 
     len += snprintf(msg + len, sizeof(msg) - len,
-                    "[%s], Rule_Id: %u, Event_Desc: [%s](%u)  from ",
+                    "[%ld.%06ld] [%s], Rule_Id: %u, Event_Desc: [%s](%u)  from ",
+                    static_cast<long>(evt.ts.tv_sec),
+                    static_cast<long>(evt.ts.tv_nsec / 1000),
                     evt_type_str(evt.evt_type).c_str(),
                     evt.rule_id,
                     get_matching_event_desc_str(evt.evt_details).c_str(),
@@ -1021,6 +1091,12 @@ void event_mgr::make_evt_string(event &evt, std::string &fmt)
         break;
     }
 
+    if (evt.sample_rate > 1) {
+        len += snprintf(msg + len, sizeof(msg) - len,
+                        "%ssampled 1/%u ",
+                        (msg[len - 1] != ' ') ? " " : "", evt.sample_rate);
+    }
+
     len += snprintf(msg + len, sizeof(msg) - len, "\n");
 
     fmt = msg;
@@ -47,11 +47,13 @@ class event_mgr {
         /**
          * @brief - store logs temporarily in the queue and pass it to the storage thread.
          *
-         * Called by the parser or filter code.
+         * Called by the parser or filter code. Once the queue holds the
+         * configured number of events, the queue drop policy applies.
          *
          * @param [in] evt - firewall event structure.
+         * @param [in] ifname - interface the event is seen on, for the drop stats.
         */
-        void store(event &evt);
+        void store(event &evt, const std::string &ifname);
 
         /**
          * @brief - get matching rule id for given event.
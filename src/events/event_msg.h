@@ -42,6 +42,11 @@ struct event_msg {
     event_type evt_type;
     event_description evt_desc;
     uint32_t ethertype;
+    // receive timestamp of the packet
+    uint64_t ts_sec;
+    uint32_t ts_nsec;
+    // 1 in sample_rate flows inspected
+    uint32_t sample_rate;
     uint8_t data[0];
 } __attribute__ ((__packed__));
 
@@ -59,7 +64,7 @@ enum class Encryption_Algorithm {
  * @brief - A high level header for the event message.
  */
 struct event_msg_hdr {
-#define EVT_FILE_VERSION 1
+#define EVT_FILE_VERSION 3
     //
     // Version of the event message
     uint8_t version;
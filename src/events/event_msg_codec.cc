@@ -14,6 +14,9 @@ int event_msg_codec::serialize(event &e, event_msg *evt_msg)
     evt_msg->evt_desc = e.evt_details;
     evt_msg->rule_id = e.rule_id;
     evt_msg->ethertype = e.ethertype;
+    evt_msg->ts_sec = e.ts.tv_sec;
+    evt_msg->ts_nsec = e.ts.tv_nsec;
+    evt_msg->sample_rate = e.sample_rate;
 
     total_len = sizeof(event_msg);
 
@@ -52,6 +55,9 @@ int event_msg_codec::deserialize(event &e, event_msg *evt_msg)
     e.evt_details = evt_msg->evt_desc;
     e.rule_id = evt_msg->rule_id;
     e.ethertype = evt_msg->ethertype;
+    e.ts.tv_sec = evt_msg->ts_sec;
+    e.ts.tv_nsec = evt_msg->ts_nsec;
+    e.sample_rate = evt_msg->sample_rate;
 
     switch (static_cast<Ether_Type>(evt_msg->ethertype)) {
         case Ether_Type::Ether_Type_IPv4: {
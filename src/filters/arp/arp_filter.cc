@@ -34,7 +34,8 @@ event_description arp_filter::add_arp_frame(parser &p)
             arp_entry arp_e(p.arp_h.sender_hw_addr,
                             p.arp_h.target_hw_addr,
                             p.arp_h.sender_proto_addr,
-                            p.arp_h.target_proto_addr);
+                            p.arp_h.target_proto_addr,
+                            p.rx_ts);
 
             //
             // if ARP Request is received set it
@@ -53,13 +54,21 @@ event_description arp_filter::add_arp_frame(parser &p)
             }
 
             tunables *t_conf = tunables::instance();
-            timespec cur;
             double delta;
 
-            clock_gettime(CLOCK_MONOTONIC, &cur);
-            delta = diff_time_ns(&cur, &it->last_seen) / 1000000;
+            //
+            // gap is measured on the receive timestamps, so the queueing
+            // delay before the filter does not shrink or stretch it.
+            delta = diff_time_ns(&p.rx_ts, &it->last_seen) / 1000000;
 
-            it->last_seen = cur;
+            //
+            // frames of the same sender may be filtered out of order
+            // by different workers, the gap is the same either way.
+            if (delta < 0) {
+                delta = -delta;
+            } else {
+                it->last_seen = p.rx_ts;
+            }
 
             if (delta < t_conf->arp_t.interframe_gap_msec)
                 return event_description::Evt_ARP_Flood_Maybe_In_Progress;
@@ -51,15 +51,16 @@ struct arp_entry {
     explicit arp_entry(uint8_t *sender_macaddr,
                        uint8_t *target_macaddr,
                        uint32_t sender_ip,
-                       uint32_t target_ip) :
+                       uint32_t target_ip,
+                       const struct timespec &seen) :
                 sender_ipaddr(sender_ip),
                 target_ipaddr(target_ip),
                 resolved(false),
-                state(Arp_State::Unknown)
+                state(Arp_State::Unknown),
+                last_seen(seen)
     {
         std::memcpy(sender_mac, sender_macaddr, FW_MACADDR_LEN);
         std::memcpy(target_mac, target_macaddr, FW_MACADDR_LEN);
-        clock_gettime(CLOCK_MONOTONIC, &last_seen);
     }
     ~arp_entry() { }
     void print(logger *log)
@@ -1,2 +1,68 @@
+/**
+ * @brief - Implements ip address blacklist.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <fstream>
+#include <sstream>
 #include <blacklist_ip.h>
 
+namespace firewall {
+
+fw_error_type blacklist_ip::init(const std::string &filename, logger *log)
+{
+    uint8_t addr[IP_LPM_V6_ADDR_LEN];
+    uint32_t prefix_len;
+    uint32_t addr_len;
+    uint32_t n_v4 = 0;
+    uint32_t n_v6 = 0;
+    uint32_t line_no = 0;
+    std::string line;
+
+    v4_.clear();
+    v6_.clear();
+
+    if (filename.empty()) {
+        return fw_error_type::eNo_Error;
+    }
+
+    std::ifstream f(filename);
+    if (!f.is_open()) {
+        log->error("blacklist: failed to open %s\n", filename.c_str());
+        return fw_error_type::eConfig_Error;
+    }
+
+    while (std::getline(f, line)) {
+        std::string prefix;
+
+        line_no ++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        if (!(fields >> prefix)) {
+            continue;
+        }
+
+        if (ip_prefix_parse(prefix, addr_len, addr, prefix_len) < 0) {
+            log->error("blacklist: invalid prefix %s at %s:%u\n",
+                       prefix.c_str(), filename.c_str(), line_no);
+            return fw_error_type::eConfig_Error;
+        }
+
+        if (addr_len == IP_LPM_V4_ADDR_LEN) {
+            v4_.add(addr, prefix_len, 1);
+            n_v4 ++;
+        } else {
+            v6_.add(addr, prefix_len, 1);
+            n_v6 ++;
+        }
+    }
+
+    v4_.build();
+    v6_.build();
+
+    log->info("blacklist: loaded %u ipv4 and %u ipv6 prefixes, %zu bytes\n",
+              n_v4, n_v6, v4_.mem_bytes() + v6_.mem_bytes());
+
+    return fw_error_type::eNo_Error;
+}
+
+}
@@ -1,6 +1,98 @@
+/**
+ * @brief - Implements ip address blacklist.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
 #ifndef __FW_FILTERS_BLACKLIST_IP_H__
 #define __FW_FILTERS_BLACKLIST_IP_H__
 
-#endif
+#include <stdint.h>
+#include <string>
+#include <event_def.h>
+#include <logger.h>
+#include <common.h>
+#include <ip_lpm.h>
+
+namespace firewall {
+
+/**
+ * @brief - denies the packets from or to a blacklisted network.
+ *
+ * The list file holds one ipv4 or ipv6 prefix per line, a bare address is
+ * a host, '#' starts a comment. Loaded once at startup and read only
+ * afterwards.
+*/
+class blacklist_ip {
+    public:
+        ~blacklist_ip() { }
+
+        static blacklist_ip *instance()
+        {
+            static blacklist_ip bl;
+            return &bl;
+        }
+
+        /**
+         * @brief - load the blacklist.
+         *
+         * @param [in] filename - list file, empty if there is no blacklist
+         * @param [in] log - logger
+         *
+         * @return eNo_Error on success, eConfig_Error if the file cannot be
+         *         read or has a malformed prefix.
+        */
+        fw_error_type init(const std::string &filename, logger *log);
+
+        /**
+         * @brief - check the addresses of an ipv4 packet.
+         *
+         * @param [in] src - source address in host byte order
+         * @param [in] dst - destination address in host byte order
+         *
+         * @return Evt_Parse_Ok if neither address is blacklisted.
+        */
+        inline event_description check_v4(uint32_t src, uint32_t dst) const
+        {
+            if (v4_.lookup_v4(src)) {
+                return event_description::Evt_IP_Src_Blacklisted;
+            }
+            if (v4_.lookup_v4(dst)) {
+                return event_description::Evt_IP_Dst_Blacklisted;
+            }
 
+            return event_description::Evt_Parse_Ok;
+        }
 
+        /**
+         * @brief - check the addresses of an ipv6 packet.
+         *
+         * @param [in] src - source address in network byte order
+         * @param [in] dst - destination address in network byte order
+         *
+         * @return Evt_Parse_Ok if neither address is blacklisted.
+        */
+        inline event_description check_v6(const uint8_t *src, const uint8_t *dst) const
+        {
+            if (v6_.lookup(src)) {
+                return event_description::Evt_IP_Src_Blacklisted;
+            }
+            if (v6_.lookup(dst)) {
+                return event_description::Evt_IP_Dst_Blacklisted;
+            }
+
+            return event_description::Evt_Parse_Ok;
+        }
+
+    private:
+        explicit blacklist_ip() :
+                    v4_(IP_LPM_V4_ADDR_LEN),
+                    v6_(IP_LPM_V6_ADDR_LEN)
+        { }
+
+        ip_lpm v4_;
+        ip_lpm v6_;
+};
+
+}
+
+#endif
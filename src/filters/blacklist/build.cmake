@@ -0,0 +1,7 @@
+project(firewall)
+cmake_minimum_required(VERSION 3.22)
+
+file(GLOB FILTER_BLACKLIST_SOURCES ${PROJECT_SOURCE_DIR}/src/filters/blacklist/*.cc)
+
+include_directories(./src/filters/blacklist/)
+
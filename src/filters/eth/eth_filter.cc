@@ -9,41 +9,53 @@ int eth_filter::run_filter(parser &p,
                            std::vector<rule_config_item>::iterator &it,
                            logger *log, bool debug)
 {
-    bool deny_matched = false;
     event_mgr *evt_mgr = event_mgr::instance();
+    //
+    // signatures of the rule found in this packet. The rule is shared by
+    // all the workers, so the match state is kept here and not in the rule.
+    eth_sig_bitmask eth_detected;
+    vlan_sig_bitmask vlan_detected;
+    bool deny_matched;
     event evt;
 
     if ((it->sig_mask.eth_sig.from_src) &&
-        (std::memcmp(p.eh.src_mac, it->eth_rule.from_src, FW_MACADDR_LEN) == 0)) {
-        if (it->type == rule_type::Deny)
-            deny_matched = true;
-
-        it->sig_detected.eth_sig.from_src = 1;
+        (std::memcmp(p.get_src_mac(), it->eth_rule.from_src, FW_MACADDR_LEN) == 0)) {
+        eth_detected.from_src = 1;
     }
     if ((it->sig_mask.eth_sig.to_dst) &&
-        (std::memcmp(p.eh.dst_mac, it->eth_rule.to_dst, FW_MACADDR_LEN) == 0)) {
-        if (it->type == rule_type::Deny)
-            deny_matched = true;
-
-        it->sig_detected.eth_sig.to_dst = 1;
+        (std::memcmp(p.get_dst_mac(), it->eth_rule.to_dst, FW_MACADDR_LEN) == 0)) {
+        eth_detected.to_dst = 1;
     }
     if ((it->sig_mask.eth_sig.ethertype) &&
-        (p.eh.ethertype == it->eth_rule.ethertype)) {
-        if (it->type == rule_type::Deny)
-            deny_matched = true;
-
+        (p.get_ethertype() == it->eth_rule.ethertype)) {
         //
         // what to do for Allowed events?
-        it->sig_detected.eth_sig.ethertype = 1;
+        eth_detected.ethertype = 1;
     }
 
+    //
+    // vlan rules match on the vid, and on the priority if it is given
+    if ((it->sig_mask.vlan_sig.vid) &&
+        p.protocols_avail.has_vlan() &&
+        (p.get_vlan_id() == it->vlan_rule.vid) &&
+        (!it->sig_mask.vlan_sig.vlan_pri || (p.get_vlan_pri() == it->vlan_rule.pri))) {
+        vlan_detected.vid = 1;
+    }
+
+    //
+    // a deny rule matches on any one of its signatures
+    deny_matched = (it->type == rule_type::Deny) &&
+                   (eth_detected.active() || vlan_detected.vid);
+
     //
     // if the ruletype is deny, fill the event
     if (deny_matched) {
         evt.rule_id = it->rule_id;
         evt.evt_type = event_type::Evt_Deny;
-        evt.ethertype = p.eh.ethertype;
-        evt_mgr->store(evt);
+        evt.ethertype = p.get_ethertype();
+        evt.ts = p.rx_ts;
+        evt.sample_rate = p.sample_rate;
+        evt_mgr->store(evt, p.get_ifname());
         return -1;
     }
 
@@ -15,6 +15,8 @@ fw_error_type filter::init()
     arp_filter *arp_f = arp_filter::instance();
     icmp_filter *icmp_f = icmp_filter::instance();
     port_filter *port_f = port_filter::instance();
+    blacklist_ip *blacklist = blacklist_ip::instance();
+    network_map *nw_map = network_map::instance();
     int ret;
 
     ret = tunable_cfg->parse(conf->tunables_config_filename);
@@ -26,9 +28,17 @@ fw_error_type filter::init()
     log->info("filter: parsed tunables config\n");
 
     arp_f->init(log);
-    icmp_f->init();
+    ret = icmp_f->init(conf->affinity.housekeeping_cpus);
+    if (ret != 0) {
+        log->error("filter: failed to pin icmp list manager thread\n");
+    }
     port_f->init();
 
+    if ((blacklist->init(conf->blacklist_filename, log) != fw_error_type::eNo_Error) ||
+        (nw_map->init(conf->network_map_filename, log) != fw_error_type::eNo_Error)) {
+        return fw_error_type::eConfig_Error;
+    }
+
     return fw_error_type::eNo_Error;
 }
 
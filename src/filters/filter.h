@@ -14,6 +14,8 @@
 #include <arp_filter.h>
 #include <icmp_filter.h>
 #include <port_filter.h>
+#include <blacklist_ip.h>
+#include <network_map.h>
 #include <common.h>
 
 namespace firewall {
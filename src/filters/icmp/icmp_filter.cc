@@ -109,12 +109,12 @@ void icmp_filter::manage_icmp(parser &p)
 
             seq_info.state = Icmp_State::Echo_Req_Observed;
             seq_info.seq = p.icmp_h.echo_req->seq_no;
-            timestamp_perf(&seq_info.seq_ts);
+            seq_info.seq_ts = p.rx_ts;
             i.seq_info.push_back(seq_info);
             i.id = p.icmp_h.echo_req->id;
             i.n_icmp = 0;
 
-            timestamp_perf(&i.cur_echo_req_time);
+            i.cur_echo_req_time = p.rx_ts;
 
             icmp_list_.push_back(i);
         } else if (p.icmp_h.echo_reply) {
@@ -159,7 +159,7 @@ void icmp_filter::manage_icmp(parser &p)
             it->prev_echo_reply_time = it->cur_echo_reply_time;
             //
             // update the echo_reply
-            timestamp_perf(&it->cur_echo_reply_time);
+            it->cur_echo_reply_time = p.rx_ts;
         }
         if (p.icmp_h.echo_req) {
             it->sender_ip = p.ipv4_h.src_addr;
@@ -169,14 +169,14 @@ void icmp_filter::manage_icmp(parser &p)
 
             seq_info.state = Icmp_State::Echo_Req_Observed;
             seq_info.seq = p.icmp_h.echo_req->seq_no;
-            timestamp_perf(&seq_info.seq_ts);
+            seq_info.seq_ts = p.rx_ts;
             it->seq_info.push_back(seq_info);
 
             it->prev_echo_req_time = it->prev_echo_req_time;
 
             //
             // update the echo_req with new sequence number
-            timestamp_perf(&it->cur_echo_req_time);
+            it->cur_echo_req_time = p.rx_ts;
         }
     }
 }
@@ -195,7 +195,9 @@ void icmp_filter::list_mgr_thread()
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         std::vector<icmp_info>::iterator it;
 
-        timestamp_perf(&tp);
+        //
+        // entries are stamped with the receive time of the frames
+        timestamp_wall(&tp);
         std::unique_lock<std::mutex> lock(table_lock_);
         for (it = icmp_list_.begin(); it != icmp_list_.end(); it ++) {
             std::vector<icmp_seq_info>::iterator it1;
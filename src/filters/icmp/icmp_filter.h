@@ -14,6 +14,7 @@
 #include <logger.h>
 #include <time_util.h>
 #include <tunables.h>
+#include <cpu_affinity.h>
 
 namespace firewall {
 
@@ -107,11 +108,20 @@ class icmp_filter {
 
         /**
          * @brief - initializes the ICMP filter.
+         *
+         * @param [in] cpus - cpus of the list manager thread, any cpu if empty
+         *
+         * @return 0 on success, -1 if the thread can not be pinned.
         */
-        void init()
+        int init(const std::vector<uint32_t> &cpus)
         {
+            int ret;
+
             list_mgr_thr_ = std::make_unique<std::thread>(&icmp_filter::list_mgr_thread, this);
+            ret = cpu_affinity_set(list_mgr_thr_->native_handle(), cpus);
             list_mgr_thr_->detach();
+
+            return ret;
         }
 
         event_description run_auto_sig_checks(parser &p, logger *log, bool debug);
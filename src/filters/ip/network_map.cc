@@ -0,0 +1,73 @@
+/**
+ * @brief - Implements network map of the protected site.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#include <fstream>
+#include <sstream>
+#include <network_map.h>
+
+namespace firewall {
+
+fw_error_type network_map::init(const std::string &filename, logger *log)
+{
+    uint8_t addr[IP_LPM_V6_ADDR_LEN];
+    uint32_t prefix_len;
+    uint32_t addr_len;
+    uint32_t line_no = 0;
+    std::string line;
+
+    v4_.clear();
+    v6_.clear();
+    names_.clear();
+
+    if (filename.empty()) {
+        return fw_error_type::eNo_Error;
+    }
+
+    std::ifstream f(filename);
+    if (!f.is_open()) {
+        log->error("network_map: failed to open %s\n", filename.c_str());
+        return fw_error_type::eConfig_Error;
+    }
+
+    while (std::getline(f, line)) {
+        std::string prefix;
+        std::string name;
+        int ret;
+
+        line_no ++;
+        std::istringstream fields(line.substr(0, line.find('#')));
+        if (!(fields >> prefix)) {
+            continue;
+        }
+
+        if (!(fields >> name) ||
+            (ip_prefix_parse(prefix, addr_len, addr, prefix_len) < 0)) {
+            log->error("network_map: invalid network at %s:%u\n",
+                       filename.c_str(), line_no);
+            return fw_error_type::eConfig_Error;
+        }
+
+        names_.push_back(name);
+        if (addr_len == IP_LPM_V4_ADDR_LEN) {
+            ret = v4_.add(addr, prefix_len, names_.size());
+        } else {
+            ret = v6_.add(addr, prefix_len, names_.size());
+        }
+        if (ret < 0) {
+            log->error("network_map: too many networks in %s\n", filename.c_str());
+            return fw_error_type::eConfig_Error;
+        }
+    }
+
+    v4_.build();
+    v6_.build();
+
+    log->info("network_map: loaded %zu networks, %zu bytes\n",
+              names_.size(), v4_.mem_bytes() + v6_.mem_bytes());
+
+    return fw_error_type::eNo_Error;
+}
+
+}
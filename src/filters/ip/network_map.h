@@ -0,0 +1,149 @@
+/**
+ * @brief - Implements network map of the protected site.
+ *
+ * @copyright - 2023-present. Devendra Naga. All rights reserved.
+*/
+#ifndef __FW_FILTERS_NETWORK_MAP_H__
+#define __FW_FILTERS_NETWORK_MAP_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <event_def.h>
+#include <logger.h>
+#include <common.h>
+#include <ip_lpm.h>
+
+namespace firewall {
+
+/**
+ * @brief - networks of the site, a packet with neither address in any of
+ *          them is denied.
+ *
+ * Traffic between the site and the outside has one address in the map,
+ * only a packet with both ends outside the site, which the sensor should
+ * not see, is denied. Sources that are not yet or only locally addressed,
+ * the unspecified address of DHCP and IPv6 duplicate address detection
+ * and the link local networks, are not checked.
+ *
+ * The map file holds one network per line, a prefix followed by the name
+ * of the network, '#' starts a comment. A prefix inside a larger network
+ * belongs to the smaller one. An address family without any network in
+ * the map is not checked. Loaded once at startup and read only
+ * afterwards.
+*/
+class network_map {
+    public:
+        ~network_map() { }
+
+        static network_map *instance()
+        {
+            static network_map nm;
+            return &nm;
+        }
+
+        /**
+         * @brief - load the network map.
+         *
+         * @param [in] filename - map file, empty if there is no map
+         * @param [in] log - logger
+         *
+         * @return eNo_Error on success, eConfig_Error if the file cannot be
+         *         read or has a malformed line.
+        */
+        fw_error_type init(const std::string &filename, logger *log);
+
+        /**
+         * @brief - find the network of an ipv4 address.
+         *
+         * @param [in] addr - address in host byte order
+         *
+         * @return network id, 0 if the address is in no network.
+        */
+        inline uint32_t find_v4(uint32_t addr) const { return v4_.lookup_v4(addr); }
+
+        /**
+         * @brief - find the network of an ipv6 address.
+         *
+         * @param [in] addr - address in network byte order
+         *
+         * @return network id, 0 if the address is in no network.
+        */
+        inline uint32_t find_v6(const uint8_t *addr) const { return v6_.lookup(addr); }
+
+        /**
+         * @brief - name of a network returned by find_v4() or find_v6().
+        */
+        const std::string &network_name(uint32_t id) const { return names_[id - 1]; }
+
+        /**
+         * @brief - check the addresses of an ipv4 packet.
+         *
+         * @param [in] src - source address in host byte order
+         * @param [in] dst - destination address in host byte order
+         *
+         * @return Evt_Parse_Ok if either address is in the map.
+        */
+        inline event_description check_v4(uint32_t src, uint32_t dst) const
+        {
+            //
+            // 0.0.0.0 and 169.254.0.0/16 sources are not checked
+            if (v4_.empty() || (src == 0) || ((src >> 16) == 0xA9FE)) {
+                return event_description::Evt_Parse_Ok;
+            }
+
+            if (!find_v4(src) && !find_v4(dst)) {
+                return event_description::Evt_IP_Not_In_Network_Map;
+            }
+
+            return event_description::Evt_Parse_Ok;
+        }
+
+        /**
+         * @brief - check the addresses of an ipv6 packet.
+         *
+         * @param [in] src - source address in network byte order
+         * @param [in] dst - destination address in network byte order
+         *
+         * @return Evt_Parse_Ok if either address is in the map.
+        */
+        inline event_description check_v6(const uint8_t *src, const uint8_t *dst) const
+        {
+            uint8_t src_bits = 0;
+            uint32_t i;
+
+            if (v6_.empty()) {
+                return event_description::Evt_Parse_Ok;
+            }
+
+            //
+            // :: and fe80::/10 sources are not checked
+            for (i = 0; i < IP_LPM_V6_ADDR_LEN; i ++) {
+                src_bits |= src[i];
+            }
+            if ((src_bits == 0) || ((src[0] == 0xFE) && ((src[1] & 0xC0) == 0x80))) {
+                return event_description::Evt_Parse_Ok;
+            }
+
+            if (!find_v6(src) && !find_v6(dst)) {
+                return event_description::Evt_IP_Not_In_Network_Map;
+            }
+
+            return event_description::Evt_Parse_Ok;
+        }
+
+    private:
+        explicit network_map() :
+                    v4_(IP_LPM_V4_ADDR_LEN),
+                    v6_(IP_LPM_V6_ADDR_LEN)
+        { }
+
+        ip_lpm v4_;
+        ip_lpm v6_;
+        // network id i is names_[i - 1]
+        std::vector<std::string> names_;
+};
+
+}
+
+#endif
@@ -12,7 +12,7 @@ bool inline in_range(uint32_t val, uint32_t min, uint32_t max)
     return false;
 }
 
-void port_filter::match_port_ranges(parser &p,
+int port_filter::match_port_ranges(parser &p,
                                     std::vector<rule_config_item>::iterator &rule,
                                     logger *log,
                                     bool debug)
@@ -22,16 +22,13 @@ void port_filter::match_port_ranges(parser &p,
     uint32_t src_port;
     uint32_t dst_port;
 
-    if (p.protocols_avail.has_tcp()) {
-        src_port = p.tcp_h.src_port;
-        dst_port = p.tcp_h.dst_port;
-    } else if (p.protocols_avail.has_udp()) {
-        src_port = p.udp_h.src_port;
-        dst_port = p.udp_h.dst_port;
+    if (p.has_port()) {
+        src_port = static_cast<uint32_t>(p.get_src_port());
+        dst_port = static_cast<uint32_t>(p.get_dst_port());
     } else {
         //
         // should we raise an event ?
-        return;
+        return 0;
     }
 
     //
@@ -54,57 +51,59 @@ void port_filter::match_port_ranges(parser &p,
             evt_type = event_type::Evt_Allow;
 
         evt_mgr->store(evt_type, event_description::Evt_Port_Matched, p);
+
+        //
+        // a deny ends the rule walk
+        if (rule->type == rule_type::Deny)
+            return -1;
     }
+
+    return 0;
 }
 
-void port_filter::run(parser &p,
+int port_filter::run(parser &p,
                       std::vector<rule_config_item>::iterator &rule,
                       logger *log,
                       bool debug)
 {
-    if (rule->sig_mask.port_list_sig.port_list)
-        match_allowed_ports(p, rule, log, debug);
     if (rule->sig_mask.port_list_sig.port_range)
-        match_port_ranges(p, rule, log, debug);
+        return match_port_ranges(p, rule, log, debug);
+
+    return 0;
 }
 
-void port_filter::match_allowed_ports(parser &p,
-                                      std::vector<rule_config_item>::iterator &rule,
-                                      logger *log,
-                                      bool debug)
+int port_filter::run_port_lists(parser &p, const port_list_level &lists)
 {
-    bool match = false;
-    event_type evt_type;
     event_mgr *evt_mgr = event_mgr::instance();
+    uint16_t src_port;
+    uint16_t dst_port;
 
-    match = match_ports(rule->port_rule.port_list, p, log, debug);
-    if (match == false)
-        evt_type = event_type::Evt_Deny;
-    else
-        evt_type = event_type::Evt_Allow;
+    if (!p.has_port())
+        return 0;
 
-    evt_mgr->store(evt_type, event_description::Evt_Port_Matched, p);
-}
+    src_port = static_cast<uint16_t>(p.get_src_port());
+    dst_port = static_cast<uint16_t>(p.get_dst_port());
 
-bool port_filter::match_ports(std::vector<uint16_t> &port_list,
-                              parser &p,
-                              logger *log,
-                              bool debug)
-{
-    for (auto it : port_list) {
-        if (p.protocols_avail.has_tcp()) {
-            if ((it == p.tcp_h.src_port) || (it == p.tcp_h.dst_port)) {
-                return true;
-            }
-        }
-        if (p.protocols_avail.has_udp()) {
-            if ((it == p.udp_h.src_port) || (it == p.udp_h.dst_port)) {
-                return true;
-            }
+    //
+    // the deny lists deny the ports in them, the allow lists deny every
+    // port that is not in one of them. One bit test per port whatever the
+    // number and size of the lists.
+    if (!lists.deny_ports.empty() &&
+        (lists.deny_ports.has(src_port) || lists.deny_ports.has(dst_port))) {
+        evt_mgr->store(event_type::Evt_Deny, event_description::Evt_Port_Matched, p);
+        return -1;
+    }
+
+    if (!lists.allow_ports.empty()) {
+        if (lists.allow_ports.has(src_port) || lists.allow_ports.has(dst_port)) {
+            evt_mgr->store(event_type::Evt_Allow, event_description::Evt_Port_Matched, p);
+        } else {
+            evt_mgr->store(event_type::Evt_Deny, event_description::Evt_Port_Matched, p);
+            return -1;
         }
     }
 
-    return false;
+    return 0;
 }
 
 void port_filter::init()
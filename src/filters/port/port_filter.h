@@ -4,6 +4,7 @@
 #include <vector>
 #include <logger.h>
 #include <rule_parser.h>
+#include <rule_engine.h>
 
 namespace firewall {
 
@@ -19,13 +20,27 @@ class port_filter {
         ~port_filter() { }
 
         void init();
-        void run(parser &p, std::vector<rule_config_item>::iterator &rule, logger *log, bool debug);
+        /**
+         * @brief - match the packet against the port range of a rule.
+         *
+         * @return -1 if a deny rule matched, 0 otherwise.
+        */
+        int run(parser &p, std::vector<rule_config_item>::iterator &rule, logger *log, bool debug);
+
+        /**
+         * @brief - match the packet against the port lists of the rules
+         *          of one priority, merged by rule_engine.
+         *
+         * @param [in] p - parser of the packet
+         * @param [in] lists - port lists of the priority level
+         *
+         * @return -1 if the packet is denied, 0 otherwise.
+        */
+        int run_port_lists(parser &p, const port_list_level &lists);
 
     private:
         explicit port_filter() { }
-        void match_allowed_ports(parser &p, std::vector<rule_config_item>::iterator &rule, logger *log, bool debug);
-        bool match_ports(std::vector<uint16_t> &port_list, parser &p, logger *log, bool debug);
-        void match_port_ranges(parser &p,
+        int match_port_ranges(parser &p,
                                std::vector<rule_config_item>::iterator &rule,
                                logger *log, bool debug);
 };
@@ -2,7 +2,8 @@ project(firewall)
 cmake_minimum_required(VERSION 3.22)
 
 SET(PARSER_SOURCES
-	./src/parser/parser.cc)
+	./src/parser/parser.cc
+	./src/parser/dissector_registry.cc)
 
 include_directories(./src/parser/)
 
@@ -0,0 +1,97 @@
+/**
+ * @brief - implements the table driven dissector registry of the parser.
+ *
+ * @copyright - 2023-present. All rights reserved. Devendra Naga.
+*/
+#include <ether_types.h>
+#include <protocols_types.h>
+#include <port_numbers.h>
+#include <dissector_registry.h>
+
+namespace firewall {
+
+void dissector_registry::clear()
+{
+    std::memset(l3_, 0, sizeof(l3_));
+    std::memset(l4_, 0, sizeof(l4_));
+    std::memset(udp_app_, 0, sizeof(udp_app_));
+    std::memset(tcp_app_, 0, sizeof(tcp_app_));
+}
+
+//
+// well known ports are dissected on both tcp and udp
+void dissector_registry::add_app_port(uint16_t port, App_Dissector d)
+{
+    udp_app_[port] = static_cast<uint8_t>(d);
+    tcp_app_[port] = static_cast<uint8_t>(d);
+}
+
+void dissector_registry::build(const rule_config *rules)
+{
+    clear();
+
+    l3_[static_cast<uint16_t>(Ether_Type::Ether_Type_ARP)] =
+                            static_cast<uint8_t>(L3_Dissector::Arp);
+    l3_[static_cast<uint16_t>(Ether_Type::Ether_Type_IPv4)] =
+                            static_cast<uint8_t>(L3_Dissector::IPv4);
+    l3_[static_cast<uint16_t>(Ether_Type::Ether_Type_IPv6)] =
+                            static_cast<uint8_t>(L3_Dissector::IPv6);
+    l3_[static_cast<uint16_t>(Ether_Type::Ether_Type_IEEE8021X)] =
+                            static_cast<uint8_t>(L3_Dissector::Eap);
+
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_Udp)] =
+                            static_cast<uint8_t>(L4_Dissector::Udp);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_Tcp)] =
+                            static_cast<uint8_t>(L4_Dissector::Tcp);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_Icmp)] =
+                            static_cast<uint8_t>(L4_Dissector::Icmp);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_Icmp6)] =
+                            static_cast<uint8_t>(L4_Dissector::Icmp6);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_Igmp)] =
+                            static_cast<uint8_t>(L4_Dissector::Igmp);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_ESP)] =
+                            static_cast<uint8_t>(L4_Dissector::Esp);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_GREP)] =
+                            static_cast<uint8_t>(L4_Dissector::Gre);
+    l4_[static_cast<uint8_t>(protocols_types::Protocol_VRRP)] =
+                            static_cast<uint8_t>(L4_Dissector::Vrrp);
+
+    //
+    // DHCP operates on two ports one server and one client
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_DHCP_Server),
+                 App_Dissector::Dhcp);
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_DHCP_Client),
+                 App_Dissector::Dhcp);
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_TFTP),
+                 App_Dissector::Tftp);
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_NTP),
+                 App_Dissector::Ntp);
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_TLS),
+                 App_Dissector::Tls);
+#if defined(FW_ENABLE_AUTOMOTIVE)
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_DoIP),
+                 App_Dissector::DoIP);
+#endif
+    add_app_port(static_cast<uint16_t>(Port_Numbers::Port_Number_MQTT),
+                 App_Dissector::Mqtt);
+
+    //
+    // custom udp ports of the rules, a well known port is not overridden.
+    for (auto &it : rules->rules_cfg_) {
+        if (!it.sig_mask.udp_sig.port || (it.udp_rule.port > 0xFFFF))
+            continue;
+
+        if (udp_app_[it.udp_rule.port] !=
+                            static_cast<uint8_t>(App_Dissector::None))
+            continue;
+
+#if defined(FW_ENABLE_AUTOMOTIVE)
+        if (it.udp_rule.app_type == App_Type::SomeIP) {
+            udp_app_[it.udp_rule.port] =
+                            static_cast<uint8_t>(App_Dissector::SomeIP);
+        }
+#endif
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+/**
+ * @brief - implements the table driven dissector registry of the parser.
+ *
+ * @copyright - 2023-present. All rights reserved. Devendra Naga.
+*/
+#ifndef __FW_DISSECTOR_REGISTRY_H__
+#define __FW_DISSECTOR_REGISTRY_H__
+
+#include <stdint.h>
+#include <cstring>
+#include <rule_parser.h>
+
+namespace firewall {
+
+/**
+ * @brief - L3 dissectors, selected by the ethertype.
+*/
+enum class L3_Dissector : uint8_t {
+    None,
+    Arp,
+    IPv4,
+    IPv6,
+    Eap,
+    Max,
+};
+
+/**
+ * @brief - L4 dissectors, selected by the ipv4 protocol or ipv6 next header.
+*/
+enum class L4_Dissector : uint8_t {
+    None,
+    Udp,
+    Tcp,
+    Icmp,
+    Icmp6,
+    Igmp,
+    Esp,
+    Gre,
+    Vrrp,
+    Max,
+};
+
+/**
+ * @brief - application dissectors, selected by the tcp or udp port.
+*/
+enum class App_Dissector : uint8_t {
+    None,
+    Dhcp,
+    Tftp,
+    Ntp,
+    Tls,
+    DoIP,
+    Mqtt,
+    SomeIP,
+    Max,
+};
+
+/**
+ * @brief - maps ethertype, ip protocol and port to a dissector.
+ *
+ * Each table is indexed directly with the header field, so the dispatch
+ * cost is one load whatever the number of rules. The custom ports of the
+ * rules are written into the port tables when the registry is built.
+*/
+struct dissector_registry {
+    explicit dissector_registry() { clear(); }
+    ~dissector_registry() { }
+
+    /**
+     * @brief - fill the tables with the built in dissectors and the
+     *          custom ports of the rules.
+     *
+     * @param [in] rules - rules of all the interfaces, after
+     *                     rule_config::build()
+    */
+    void build(const rule_config *rules);
+
+    inline L3_Dissector l3(uint16_t ethertype) const
+    {
+        return static_cast<L3_Dissector>(l3_[ethertype]);
+    }
+
+    inline L4_Dissector l4(uint8_t proto) const
+    {
+        return static_cast<L4_Dissector>(l4_[proto]);
+    }
+
+    inline App_Dissector udp_app(uint16_t port) const
+    {
+        return static_cast<App_Dissector>(udp_app_[port]);
+    }
+
+    inline App_Dissector tcp_app(uint16_t port) const
+    {
+        return static_cast<App_Dissector>(tcp_app_[port]);
+    }
+
+    private:
+        void clear();
+        void add_app_port(uint16_t port, App_Dissector d);
+
+        uint8_t l3_[65536];
+        uint8_t l4_[256];
+        uint8_t udp_app_[65536];
+        uint8_t tcp_app_[65536];
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
  *
  * @copyright - 2023-present. All rights reserved. Devendra Naga.
 */
+#include <algorithm>
 #include <logger.h>
 #include <parser.h>
 #include <packet_stats.h>
@@ -16,15 +17,112 @@ namespace firewall {
 parser::parser(const std::string ifname,
                rule_config *rule_list,
                logger *log) :
-                        ipv6_encap_h(nullptr),
+                        os_type_t(os_type::Unknown),
+                        pkt_len(0),
+                        rx_ts(),
+                        sample_rate(1),
                         ifname_(ifname),
                         rule_list_(rule_list),
                         log_(log),
-                        pkt_dump_(false)
+                        pkt_dump_(false),
+                        decode_mode_(Parser_Decode_Mode::Full),
+                        dissect_layers_(0xFFFFFFFF),
+                        hdr_views_(false),
+                        buf_(nullptr)
 {
+    reg_.build(rule_list_);
 }
 parser::~parser() { }
 
+void parser::set_dissect_depth(Parser_Dissect_Depth depth)
+{
+    if (depth == Parser_Dissect_Depth::Full) {
+        dissect_layers_ = 0xFFFFFFFF;
+        return;
+    }
+
+    //
+    // L2 and L3 are always dissected to reach the upper layers and
+    // for the ARP and IP checks. The auto signatures, ICMP checks and
+    // known exploit ports, are at L4, so only the application layer
+    // depends on the rules.
+    dissect_layers_ = rule_list_->get_required_layers() |
+                      static_cast<uint32_t>(Rule_Layer::L2) |
+                      static_cast<uint32_t>(Rule_Layer::L3) |
+                      static_cast<uint32_t>(Rule_Layer::L4);
+}
+
+//
+// reset a layer back to its default constructed state
+template <typename T>
+static inline void reset_layer(T &hdr)
+{
+    hdr = T();
+}
+
+void parser::reset()
+{
+    if (present_bits.eth)
+        reset_layer(eh);
+    if (present_bits.ieee8021ad)
+        reset_layer(ieee8021ad_h);
+    if (present_bits.vlan)
+        reset_layer(vh);
+    if (present_bits.macsec)
+        reset_layer(macsec_h);
+    if (present_bits.pppoe)
+        reset_layer(pppoe_h);
+    if (present_bits.arp)
+        reset_layer(arp_h);
+    if (present_bits.ieee8021x_eap)
+        reset_layer(ieee8021x_h);
+    if (present_bits.ipv4)
+        reset_layer(ipv4_h);
+    if (present_bits.ipv6)
+        reset_layer(ipv6_h);
+    if (present_bits.ipv6_encap)
+        reset_layer(ipv6_encap_h);
+    if (present_bits.udp)
+        reset_layer(udp_h);
+    if (present_bits.tcp)
+        reset_layer(tcp_h);
+    if (present_bits.icmp)
+        reset_layer(icmp_h);
+    if (present_bits.icmp6)
+        reset_layer(icmp6_h);
+    if (present_bits.igmp)
+        reset_layer(igmp_h);
+    if (present_bits.gre)
+        reset_layer(gre_h);
+    if (present_bits.vrrp)
+        reset_layer(vrrp_h);
+    if (present_bits.dhcp)
+        reset_layer(dhcp_h);
+    if (present_bits.tftp)
+        reset_layer(tftp_h);
+    if (present_bits.ntp)
+        reset_layer(ntp_h);
+    if (present_bits.tls)
+        reset_layer(tls_h);
+    if (present_bits.mqtt)
+        reset_layer(mqtt_h);
+#if defined(FW_ENABLE_AUTOMOTIVE)
+    if (present_bits.doip)
+        reset_layer(doip_h);
+    if (present_bits.someip)
+        reset_layer(someip_h);
+#endif
+
+    present_bits = protocol_present_bits();
+    protocols_avail = protocol_bits();
+    os_type_t = os_type::Unknown;
+    pkt_len = 0;
+    rx_ts = timespec();
+    sample_rate = 1;
+    offs = layer_offsets();
+    hdr_views_ = false;
+}
+
 /**
  * Detect OS signatures by looking at the TTL value of ipv4 frame.
  * 
@@ -35,7 +133,7 @@ void parser::detect_os_signature()
     uint32_t ttl = 0;
 
     if (protocols_avail.has_ipv4()) {
-        ttl = ipv4_h.ttl;
+        ttl = get_ttl();
     }
 
     switch (ttl) {
@@ -58,7 +156,6 @@ event_description parser::parse_l4(packet &pkt)
 {
     event_description evt_desc = event_description::Evt_Unknown_Error;
     protocols_types proto;
-    firewall_pkt_stats *stats = firewall_pkt_stats::instance();
 
     //
     // parse the rest of l4 frames.
@@ -81,106 +178,110 @@ event_description parser::parse_l4(packet &pkt)
     // ipv6-ah sets the nh of the original ipv6 packet so
     // that we can parse.
     if (proto == protocols_types::Protocol_IPv6_Encapsulation) {
-        ipv6_encap_h = std::make_shared<ipv6_hdr>();
-        if (!ipv6_encap_h)
-            return event_description::Evt_Out_Of_Memory;
+        present_bits.ipv6_encap = 1;
 
-        evt_desc = ipv6_encap_h->deserialize(pkt, log_, pkt_dump_);
+        evt_desc = ipv6_encap_h.deserialize(pkt, log_, pkt_dump_);
         if (evt_desc != event_description::Evt_Parse_Ok)
             return evt_desc;
 
-        proto = static_cast<protocols_types>(ipv6_encap_h->nh);
+        proto = static_cast<protocols_types>(ipv6_encap_h.nh);
+    }
+
+    evt_desc = dissect_l4(pkt, proto);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        evt_desc = validate_l4_checksum(pkt);
+
+    //
+    // parse failure or unsupported protocol
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        firewall_pkt_stats::instance()->stats_update(evt_desc, ifname_);
+        return evt_desc;
     }
 
+    offs.payload = pkt.off;
+
+    return parse_l4_app(pkt);
+}
+
 //
-// we need to iterate more than one time, if we are parsing tunneled frames
-tun_parse:
+// validate the tcp, udp or icmp6 checksum along with the pseudo header of
+// the ip header in front of it. Fragments and tunneled frames are not
+// validated, and lengths that do not fit the frame are left to the
+// ip and l4 length checks.
+event_description parser::validate_l4_checksum(const packet &pkt)
+{
+    protocols_types proto = static_cast<protocols_types>(offs.l4_proto);
+    const uint8_t *l3 = buf_ + offs.l3;
+    uint32_t l4_end;
+    uint32_t l4_len;
+    uint32_t sum;
 
-    switch (proto) {
-        case protocols_types::Protocol_Udp: {
-            present_bits.udp = 1;
-            stats->stats_update(Pktstats_Type::Type_UDP_Rx, ifname_);
-
-            evt_desc = udp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_udp();
-        } break;
-        case protocols_types::Protocol_Icmp: {
-            //
-            // set ICMP is present
-            present_bits.icmp = 1;
-
-            //
-            // update icmp rx stats
-            stats->stats_update(Pktstats_Type::Type_ICMP_Rx, ifname_);
-
-            evt_desc = icmp_filter::instance()->run_auto_sig_checks(
-                                             *this, log_, pkt_dump_);
-            if (evt_desc != event_description::Evt_Parse_Ok)
-                break;
+    if ((proto != protocols_types::Protocol_Tcp) &&
+        (proto != protocols_types::Protocol_Udp) &&
+        (proto != protocols_types::Protocol_Icmp6))
+        return event_description::Evt_Parse_Ok;
+
+    if (protocols_avail.has_gre() || present_bits.ipv6_encap)
+        return event_description::Evt_Parse_Ok;
+
+    //
+    // the kernel verified the checksum, or it is offloaded and not yet computed
+    if (pkt.has_rx_flag(Packet_Rx_Flag::Csum_Valid) ||
+        pkt.has_rx_flag(Packet_Rx_Flag::Csum_Not_Ready))
+        return event_description::Evt_Parse_Ok;
+
+    if (offs.has(Layer_Flag::IPv4)) {
+        ipv4_view ip(l3);
+
+        if (ip.is_a_frag() || (proto == protocols_types::Protocol_Icmp6))
+            return event_description::Evt_Parse_Ok;
+
+        l4_end = offs.l3 + ip.total_len();
+    } else if (offs.has(Layer_Flag::IPv6)) {
+        l4_end = offs.l3 + ipv6_view::hdr_len + ipv6_view(l3).payload_len();
+    } else {
+        return event_description::Evt_Parse_Ok;
+    }
+
+    if ((l4_end > pkt_len) || (l4_end < offs.l4))
+        return event_description::Evt_Parse_Ok;
+
+    l4_len = l4_end - offs.l4;
+
+    if (proto == protocols_types::Protocol_Udp) {
+        if (l4_len < udp_view::hdr_len)
+            return event_description::Evt_Parse_Ok;
 
-            evt_desc = icmp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_icmp();
-        } break;
-        case protocols_types::Protocol_Icmp6: {
-            present_bits.icmp6 = 1;
-
-            //
-            // update icmp6 rx stats
-            stats->stats_update(Pktstats_Type::Type_ICMP6_Rx, ifname_);
-
-            evt_desc = icmp6_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_icmp6();
-        } break;
-        case protocols_types::Protocol_Igmp: {
-            present_bits.igmp = 1;
-
-            evt_desc = igmp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_igmp();
-        } break;
-        case protocols_types::Protocol_Tcp: {
-            present_bits.tcp = 1;
-            stats->stats_update(Pktstats_Type::Type_TCP_Rx, ifname_);
-
-            evt_desc = tcp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_tcp();
-        } break;
         //
-        // Since ESP is an encrypted frame and we cannot track it
-        // Pass this frame.
-        case protocols_types::Protocol_ESP: {
-            evt_desc = event_description::Evt_Parse_Ok;
-        } break;
-        case protocols_types::Protocol_GREP: {
-            present_bits.gre = 1;
-            evt_desc = gre_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok) {
-                protocols_avail.set_gre();
-                proto = get_protocol_type();
-                goto tun_parse;
-            }
-        } break;
-        case protocols_types::Protocol_VRRP: {
-            present_bits.vrrp = 1;
-            evt_desc = vrrp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_vrrp();
-        } break;
-        default:
-            evt_desc = event_description::Evt_Unknown_Protocol;
-        break;
+        // zero checksum is not computed by the sender, allowed over ipv4 only
+        if ((udp_view(buf_ + offs.l4).checksum() == 0) && offs.has(Layer_Flag::IPv4))
+            return event_description::Evt_Parse_Ok;
     }
 
-    //
-    // parse failure or unsupported protocol
-    if (evt_desc != event_description::Evt_Parse_Ok) {
-        return evt_desc;
+    if (offs.has(Layer_Flag::IPv4)) {
+        sum = csum_pseudo_ipv4(l3, offs.l4_proto, l4_len);
+    } else {
+        sum = csum_pseudo_ipv6(l3, offs.l4_proto, l4_len);
     }
 
+    sum = csum_partial(buf_ + offs.l4, l4_len, sum);
+    if (csum_fold(sum) == 0xFFFF)
+        return event_description::Evt_Parse_Ok;
+
+    switch (proto) {
+        case protocols_types::Protocol_Tcp:
+            return event_description::Evt_Tcp_Chksum_Invalid;
+        case protocols_types::Protocol_Udp:
+            return event_description::Evt_Udp_Chksum_Invalid;
+        default:
+            return event_description::Evt_Icmp6_Chksum_Invalid;
+    }
+}
+
+event_description parser::parse_l4_app(packet &pkt)
+{
+    event_description evt_desc = event_description::Evt_Parse_Ok;
+
     //
     // parse application
     if (this->has_port()) {
@@ -197,6 +298,342 @@ tun_parse:
     return evt_desc;
 }
 
+//
+// fast path of the zero copy decode for the frames that make up most of the
+// traffic: ethernet, at most one vlan tag, ipv4 without options and not a
+// fragment or ipv6 without extension headers, then tcp or udp. Each shape
+// is checked with a few masked compares against fixed offsets and the
+// offsets and the 5-tuple are filled in one go. The offsets are written
+// only on a hit.
+//
+// returns -1 if the frame is of any other shape, it then takes the staged
+// decode below.
+static int decode_fast_path(packet &pkt, layer_offsets &offs)
+{
+    const uint8_t *b = pkt.buf;
+    uint32_t len = pkt.buf_len;
+    uint32_t l3 = eth_view::hdr_len;
+    uint32_t l4;
+    uint32_t payload;
+    uint16_t ether;
+    uint16_t tci = 0;
+    uint16_t flags = 0;
+    uint8_t proto;
+
+    //
+    // shortest frame taken is ethernet, ipv4 and udp
+    if (len < eth_view::hdr_len + ipv4_view::hdr_len_min + udp_view::hdr_len)
+        return -1;
+
+    ether = load_be16(b + 12);
+    if (ether == static_cast<uint16_t>(Ether_Type::Ether_Type_VLAN)) {
+        tci = load_be16(b + eth_view::hdr_len);
+        ether = load_be16(b + eth_view::hdr_len + 2);
+        l3 += vlan_view::hdr_len;
+        flags |= static_cast<uint16_t>(Layer_Flag::Vlan);
+    }
+
+    if (pkt.has_rx_flag(Packet_Rx_Flag::Vlan)) {
+        tci = pkt.vlan_tci;
+        flags |= static_cast<uint16_t>(Layer_Flag::Vlan);
+    }
+
+    if (ether == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv4)) {
+        //
+        // version 4 and a 20 byte header in the first byte, more fragments
+        // and fragment offset in the flags word, DF may be set.
+        if ((len < l3 + ipv4_view::hdr_len_min) ||
+            (b[l3] != 0x45) ||
+            (load_be16(b + l3 + 6) & 0x3FFF))
+            return -1;
+
+        proto = b[l3 + 9];
+        l4 = l3 + ipv4_view::hdr_len_min;
+        flags |= static_cast<uint16_t>(Layer_Flag::IPv4);
+    } else if (ether == static_cast<uint16_t>(Ether_Type::Ether_Type_IPv6)) {
+        if ((len < l3 + ipv6_view::hdr_len) ||
+            ((b[l3] & 0xF0) != (IPV6_VERSION << 4)))
+            return -1;
+
+        proto = b[l3 + 6];
+        l4 = l3 + ipv6_view::hdr_len;
+        flags |= static_cast<uint16_t>(Layer_Flag::IPv6);
+    } else {
+        return -1;
+    }
+
+    if (proto == static_cast<uint8_t>(protocols_types::Protocol_Udp)) {
+        payload = l4 + udp_view::hdr_len;
+        flags |= static_cast<uint16_t>(Layer_Flag::Udp);
+    } else if (proto == static_cast<uint8_t>(protocols_types::Protocol_Tcp)) {
+        //
+        // data offset is in the top nibble, at least 5 words
+        if ((len < l4 + tcp_view::hdr_len_min) || (b[l4 + 12] < 0x50))
+            return -1;
+
+        payload = l4 + ((b[l4 + 12] >> 4) << 2);
+        flags |= static_cast<uint16_t>(Layer_Flag::Tcp);
+    } else {
+        return -1;
+    }
+
+    if (len < payload)
+        return -1;
+
+    offs.l2 = 0;
+    offs.l3 = l3;
+    offs.l4 = l4;
+    offs.payload = payload;
+    offs.ethertype = ether;
+    offs.vlan_tci = tci;
+    offs.l4_proto = proto;
+    offs.flags = flags;
+    if (flags & static_cast<uint16_t>(Layer_Flag::IPv4)) {
+        offs.src_addr = load_be32(b + l3 + 12);
+        offs.dst_addr = load_be32(b + l3 + 16);
+    }
+    offs.src_port = load_be16(b + l4);
+    offs.dst_port = load_be16(b + l4 + 2);
+    pkt.off = payload;
+
+    return 0;
+}
+
+//
+// the zero copy decode is split in stages so that a batch of packets can go
+// through each stage together. Each stage starts at the offset recorded by
+// the previous one.
+//
+// returns -1 if the packet is anything else, such as a fragment, a tunnel
+// or a truncated header; such packets take the full decode.
+static int decode_l2_views(const packet &pkt, layer_offsets &offs)
+{
+    const uint8_t *b = pkt.buf;
+    uint32_t len = pkt.buf_len;
+    uint32_t off = 0;
+    uint16_t ether;
+
+    if (len < eth_view::hdr_len)
+        return -1;
+
+    offs.l2 = 0;
+    ether = eth_view(b).ethertype();
+    off = eth_view::hdr_len;
+
+    //
+    // vlan tag stripped by the NIC, there are no tag bytes in the frame
+    if (pkt.has_rx_flag(Packet_Rx_Flag::Vlan)) {
+        offs.vlan_tci = pkt.vlan_tci;
+        offs.set(Layer_Flag::Vlan);
+    }
+
+    if (static_cast<Ether_Type>(ether) == Ether_Type::Ether_Type_VLAN) {
+        if (len < off + vlan_view::hdr_len)
+            return -1;
+
+        offs.vlan_tci = load_be16(b + off);
+        ether = vlan_view(b + off).ethertype();
+        off += vlan_view::hdr_len;
+        offs.set(Layer_Flag::Vlan);
+    }
+
+    offs.ethertype = ether;
+    offs.l3 = off;
+
+    return 0;
+}
+
+static int decode_l3_views(const packet &pkt, layer_offsets &offs)
+{
+    const uint8_t *b = pkt.buf;
+    uint32_t len = pkt.buf_len;
+    uint32_t off = offs.l3;
+    uint8_t proto;
+
+    if (static_cast<Ether_Type>(offs.ethertype) == Ether_Type::Ether_Type_IPv4) {
+        if (len < off + ipv4_view::hdr_len_min)
+            return -1;
+
+        ipv4_view ip(b + off);
+
+        if ((ip.version() != IPV4_VERSION) ||
+            (ip.hdr_len() < ipv4_view::hdr_len_min) ||
+            (len < off + ip.hdr_len()) ||
+            ip.is_a_frag())
+            return -1;
+
+        proto = ip.protocol();
+        off += ip.hdr_len();
+        offs.src_addr = ip.src_addr();
+        offs.dst_addr = ip.dst_addr();
+        offs.set(Layer_Flag::IPv4);
+    } else if (static_cast<Ether_Type>(offs.ethertype) == Ether_Type::Ether_Type_IPv6) {
+        if (len < off + ipv6_view::hdr_len)
+            return -1;
+
+        ipv6_view ip(b + off);
+
+        if (ip.version() != IPV6_VERSION)
+            return -1;
+
+        proto = ip.nh();
+        off += ipv6_view::hdr_len;
+        offs.set(Layer_Flag::IPv6);
+    } else {
+        return -1;
+    }
+
+    offs.l4 = off;
+    offs.l4_proto = proto;
+
+    return 0;
+}
+
+static int decode_l4_views(packet &pkt, layer_offsets &offs)
+{
+    const uint8_t *b = pkt.buf;
+    uint32_t len = pkt.buf_len;
+    uint32_t off = offs.l4;
+
+    if (static_cast<protocols_types>(offs.l4_proto) == protocols_types::Protocol_Tcp) {
+        if (len < off + tcp_view::hdr_len_min)
+            return -1;
+
+        tcp_view tcp(b + off);
+
+        if ((tcp.hdr_len() < tcp_view::hdr_len_min) ||
+            (len < off + tcp.hdr_len()))
+            return -1;
+
+        offs.src_port = tcp.src_port();
+        offs.dst_port = tcp.dst_port();
+        off += tcp.hdr_len();
+        offs.set(Layer_Flag::Tcp);
+    } else if (static_cast<protocols_types>(offs.l4_proto) == protocols_types::Protocol_Udp) {
+        if (len < off + udp_view::hdr_len)
+            return -1;
+
+        udp_view udp(b + off);
+
+        offs.src_port = udp.src_port();
+        offs.dst_port = udp.dst_port();
+        off += udp_view::hdr_len;
+        offs.set(Layer_Flag::Udp);
+    } else {
+        return -1;
+    }
+
+    offs.payload = off;
+    pkt.off = off;
+
+    return 0;
+}
+
+//
+// run the ip, tcp and udp checks of the full decode on a frame decoded with
+// the header views, using the same predicates. Nothing is reported here, a
+// frame that any check flags is handed to the full decode, which raises
+// the event.
+//
+// returns -1 if a check flags the frame.
+int parser::check_hdr_views(packet &pkt, const layer_offsets &o)
+{
+    const uint8_t *b = pkt.buf;
+    uint32_t len = pkt.buf_len;
+    event_description evt_desc = event_description::Evt_Parse_Ok;
+
+    if (o.has(Layer_Flag::IPv4)) {
+        ipv4_view ip(b + o.l3);
+
+        if ((ip.total_len() < ip.hdr_len()) ||
+            ip.reserved() ||
+            (ip.ttl() == 0) ||
+            ((int32_t)(len - o.l4) < (int32_t)(ip.total_len() - ip.hdr_len())) ||
+            (ipv4_hdr::check_addrs(ip.src_addr(), ip.dst_addr()) !=
+                                        event_description::Evt_Parse_Ok))
+            return -1;
+
+        if (ip.hdr_len() > ipv4_view::hdr_len_min) {
+            ipv4_options opt;
+
+            pkt.off = o.l3 + ipv4_view::hdr_len_min;
+            evt_desc = opt.deserialize(pkt, log_, ip.hdr_len() - ipv4_view::hdr_len_min, false);
+        }
+    } else {
+        ipv6_view ip(b + o.l3);
+        const uint8_t *dst = ip.dst_addr();
+        uint8_t dst_bits = 0;
+        uint32_t i;
+
+        for (i = 0; i < IPV6_ADDR_LEN; i ++) {
+            dst_bits |= dst[i];
+        }
+
+        //
+        // the payload length is compared from the end of its own field
+        // as in ipv6_hdr::deserialize
+        if ((len - o.l3 - 6 < ip.payload_len()) ||
+            (ip.hop_limit() == 0) ||
+            (dst_bits == 0))
+            return -1;
+    }
+
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        pkt.off = o.payload;
+        return -1;
+    }
+
+    if (o.has(Layer_Flag::Tcp)) {
+        tcp_view tcp(b + o.l4);
+
+        if ((tcp.src_port() == 0) || (tcp.dst_port() == 0) ||
+            (tcp_hdr::check_flags(b[o.l4 + 12], tcp.flags()) !=
+                                        event_description::Evt_Parse_Ok))
+            return -1;
+
+        if (tcp.hdr_len() > tcp_view::hdr_len_min) {
+            tcp_hdr_options opts;
+
+            pkt.off = o.l4 + tcp_view::hdr_len_min;
+            evt_desc = opts.deserialize(pkt, tcp.hdr_len() - tcp_view::hdr_len_min, log_);
+        }
+    } else {
+        udp_view udp(b + o.l4);
+
+        if ((udp.src_port() == 0) || (udp.dst_port() == 0) ||
+            ((int32_t)(len - o.payload) < (int32_t)udp.length() - (int32_t)udp_view::hdr_len))
+            return -1;
+    }
+
+    pkt.off = o.payload;
+
+    return (evt_desc == event_description::Evt_Parse_Ok) ? 0 : -1;
+}
+
+//
+// walk ethernet, a single vlan tag, ipv4 or ipv6 and tcp or udp through the
+// header views and record only the layer offsets. The header fields are not
+// copied; the protocol checks of the full decode run on the views and a
+// frame they flag takes the full decode.
+int parser::decode_hdr_views(packet &pkt)
+{
+    if (decode_fast_path(pkt, offs) == 0) {
+        if (check_hdr_views(pkt, offs) < 0)
+            return -1;
+
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Fast_Path, ifname_);
+        return 0;
+    }
+
+    if ((decode_l2_views(pkt, offs) < 0) ||
+        (decode_l3_views(pkt, offs) < 0) ||
+        (decode_l4_views(pkt, offs) < 0) ||
+        (check_hdr_views(pkt, offs) < 0))
+        return -1;
+
+    return 0;
+}
+
 bool parser::exploit_search(packet &pkt)
 {
     Port_Numbers port;
@@ -228,86 +665,174 @@ bool parser::exploit_search(packet &pkt)
     return false;
 }
 
-event_description parser::parse_app_pkt(packet &pkt, Port_Numbers port)
+event_description parser::parse_app(packet &pkt)
 {
-    event_description evt_desc = event_description::Evt_Unknown_Error;
+    uint16_t dst_port = static_cast<uint16_t>(this->get_dst_port());
+    uint16_t src_port = static_cast<uint16_t>(this->get_src_port());
+    App_Dissector d;
+
+    //
+    // the dst port is looked up first and the src port afterwards
+    if (protocols_avail.has_udp()) {
+        d = reg_.udp_app(dst_port);
+        if (d == App_Dissector::None)
+            d = reg_.udp_app(src_port);
+    } else {
+        d = reg_.tcp_app(dst_port);
+        if (d == App_Dissector::None)
+            d = reg_.tcp_app(src_port);
+    }
+
+    //
+    // a port with no dissector is still denied when no rule reads the
+    // application layer, only the payload of the known ports is skipped.
+    if ((d != App_Dissector::None) && !dissects(Rule_Layer::App)) {
+        return event_description::Evt_Parse_Ok;
+    }
+
+    return (this->*app_dissectors_[static_cast<uint8_t>(d)])(pkt);
+}
+
+int parser::run(packet &pkt)
+{
+    begin_packet(pkt);
+
+    if (decode_mode_ == Parser_Decode_Mode::Zero_Copy) {
+        if (decode_hdr_views(pkt) == 0) {
+            hdr_views_ = true;
+            return run_hdr_views(pkt);
+        }
 
-   switch (port) {
         //
-        // DHCP operates on two ports one server and one client
-        case Port_Numbers::Port_Number_DHCP_Server:
-        case Port_Numbers::Port_Number_DHCP_Client: {
-            present_bits.dhcp = 1;
-
-            evt_desc = dhcp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_dhcp();
-        } break;
-        case Port_Numbers::Port_Number_TFTP: {
-            present_bits.tftp = 1;
-
-            evt_desc = tftp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_tftp();
-        } break;
-        case Port_Numbers::Port_Number_NTP: {
-            present_bits.ntp = 1;
-
-            evt_desc = ntp_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_ntp();
-        } break;
-        case Port_Numbers::Port_Number_TLS: {
-            present_bits.tls = 1;
-
-            evt_desc = tls_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_tls();
-        } break;
-#if defined(FW_ENABLE_AUTOMOTIVE)
-        case Port_Numbers::Port_Number_DoIP: {
-            present_bits.mqtt = 1;
+        // not a plain tcp / udp frame, decode it fully
+        offs = layer_offsets();
+        pkt.off = 0;
+    }
 
-            evt_desc = doip_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_doip();
-        } break;
-#endif
-        case Port_Numbers::Port_Number_MQTT: {
-            present_bits.mqtt = 1;
+    return run_full(pkt);
+}
 
-            evt_desc = mqtt_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_mqtt();
-        } break;
-        default:
-            evt_desc = event_description::Evt_Unknown_Port;
-        break;
+void parser::run_batch(packet *const *pkts, uint32_t n_pkts, int *rets)
+{
+    layer_offsets batch_offs[PARSER_BATCH_MAX];
+    //
+    // 0 - full decode, 1 - staged decode, 2 - fast path
+    int8_t decoded[PARSER_BATCH_MAX];
+    uint32_t n_fast = 0;
+    uint32_t i;
+
+    n_pkts = std::min<uint32_t>(n_pkts, PARSER_BATCH_MAX);
+
+    if (decode_mode_ != Parser_Decode_Mode::Zero_Copy) {
+        for (i = 0; i < n_pkts; i ++) {
+            reset();
+            rets[i] = run(*pkts[i]);
+        }
+        return;
     }
 
     //
-    // for unknown ports lets call custom parser and find if
-    // the port number is defined in the configuration.
-    if (evt_desc == event_description::Evt_Unknown_Port) {
-        evt_desc = parse_custom_ports(pkt);
+    // fast path and L2, the headers of the packets further in the batch
+    // are fetched while this one is decoded.
+    for (i = 0; i < n_pkts; i ++) {
+        if (i + PARSER_BATCH_PREFETCH < n_pkts) {
+            __builtin_prefetch(pkts[i + PARSER_BATCH_PREFETCH]->buf);
+        }
+
+        batch_offs[i] = layer_offsets();
+        if (decode_fast_path(*pkts[i], batch_offs[i]) == 0) {
+            decoded[i] = 2;
+            continue;
+        }
+
+        decoded[i] = (decode_l2_views(*pkts[i], batch_offs[i]) == 0);
     }
 
-    return evt_desc;
+    //
+    // L3
+    for (i = 0; i < n_pkts; i ++) {
+        if (decoded[i] == 1) {
+            decoded[i] = (decode_l3_views(*pkts[i], batch_offs[i]) == 0);
+        }
+    }
+
+    //
+    // L4
+    for (i = 0; i < n_pkts; i ++) {
+        if (decoded[i] == 1) {
+            decoded[i] = (decode_l4_views(*pkts[i], batch_offs[i]) == 0);
+        }
+    }
+
+    //
+    // protocol checks, the packets they flag are decoded fully below
+    for (i = 0; i < n_pkts; i ++) {
+        if (decoded[i] && (check_hdr_views(*pkts[i], batch_offs[i]) < 0)) {
+            decoded[i] = 0;
+        }
+        if (decoded[i] == 2) {
+            n_fast ++;
+        }
+    }
+
+    if (n_fast > 0) {
+        firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_Fast_Path, ifname_, n_fast);
+    }
+
+    //
+    // checksums, application dissectors and the rule filters, the packets
+    // that are not plain tcp / udp are decoded fully here.
+    for (i = 0; i < n_pkts; i ++) {
+        packet &pkt = *pkts[i];
+
+        reset();
+        begin_packet(pkt);
+
+        if (decoded[i]) {
+            offs = batch_offs[i];
+            hdr_views_ = true;
+            rets[i] = run_hdr_views(pkt);
+        } else {
+            pkt.off = 0;
+            rets[i] = run_full(pkt);
+        }
+    }
 }
 
-event_description parser::parse_app(packet &pkt)
+//
+// blacklist and network map lookups of the outer ip addresses
+event_description parser::run_ip_lists()
 {
-    event_description evt_desc = event_description::Evt_Unknown_Error;
+    const blacklist_ip *blacklist = blacklist_ip::instance();
+    const network_map *nw_map = network_map::instance();
+    event_description evt_desc;
+
+    if (protocols_avail.has_ipv4()) {
+        uint32_t src = get_ipv4_src_addr();
+        uint32_t dst = get_ipv4_dst_addr();
 
-    evt_desc = parse_app_pkt(pkt, this->get_dst_port());
-    if (evt_desc == event_description::Evt_Unknown_Error) {
-        evt_desc = parse_app_pkt(pkt, this->get_src_port());
+        evt_desc = blacklist->check_v4(src, dst);
+        if (evt_desc == event_description::Evt_Parse_Ok) {
+            evt_desc = nw_map->check_v4(src, dst);
+        }
+    } else {
+        const uint8_t *src = hdr_views_ ? ipv6_view(buf_ + offs.l3).src_addr() :
+                                          ipv6_h.src_addr;
+        const uint8_t *dst = hdr_views_ ? ipv6_view(buf_ + offs.l3).dst_addr() :
+                                          ipv6_h.dst_addr;
+
+        evt_desc = blacklist->check_v6(src, dst);
+        if (evt_desc == event_description::Evt_Parse_Ok) {
+            evt_desc = nw_map->check_v6(src, dst);
+        }
     }
 
     return evt_desc;
 }
 
-int parser::run(packet &pkt)
+//
+// full decode of a packet, copies each header out of the packet
+int parser::run_full(packet &pkt)
 {
     event_mgr *evt_mgr = event_mgr::instance();
     Ether_Type ether;
@@ -315,6 +840,7 @@ int parser::run(packet &pkt)
     firewall_pkt_stats *stats = firewall_pkt_stats::instance();
 
     present_bits.eth = 1;
+    offs.l2 = pkt.off;
 
     //
     // deserialize ethernet header
@@ -327,6 +853,25 @@ int parser::run(packet &pkt)
 
     ether = eh.get_ethertype();
 
+    //
+    // vlan tag is stripped by the NIC, rebuild the vlan layer from the
+    // receive metadata, the ethertype in the frame is the inner one.
+    if (pkt.has_rx_flag(Packet_Rx_Flag::Vlan)) {
+        present_bits.vlan = 1;
+
+        //
+        // update VLAN stats
+        stats->stats_update(Pktstats_Type::Type_VLAN_Rx, ifname_);
+
+        evt_desc = vh.deserialize_tag(pkt.vlan_tci, eh.ethertype, log_, pkt_dump_);
+        if (evt_desc != event_description::Evt_Parse_Ok) {
+            evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+            return -1;
+        }
+        protocols_avail.set_vlan();
+        offs.set(Layer_Flag::Vlan);
+    }
+
     //
     // check if its IEEE 802.1ad provider bridge, parse it
     if (eh.has_ethertype_8021ad()) {
@@ -357,6 +902,7 @@ int parser::run(packet &pkt)
             return -1;
         }
         protocols_avail.set_vlan();
+        offs.set(Layer_Flag::Vlan);
         ether = vh.get_ethertype();
     }
 
@@ -403,41 +949,12 @@ int parser::run(packet &pkt)
         ether = pppoe_h.get_ethertype();
     }
 
+    offs.l3 = pkt.off;
+    offs.ethertype = static_cast<uint16_t>(ether);
+
     //
     // parse the rest of the l2 / l3 frames.
-    switch (ether) {
-        case Ether_Type::Ether_Type_ARP: {
-            evt_desc = run_arp_filter(pkt, log_, pkt_dump_);
-        } break;
-        case Ether_Type::Ether_Type_IPv4: {
-            present_bits.ipv4 = 1;
-            stats->stats_update(Pktstats_Type::Type_IPv4_Rx, ifname_);
-
-            evt_desc = ipv4_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_IPV4_Hdr_Chksum_Invalid) {
-                firewall_pkt_stats::instance()->stats_update(evt_desc, ifname_);
-            }
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_ipv4();
-        } break;
-        case Ether_Type::Ether_Type_IPv6: {
-            present_bits.ipv6 = 1;
-            stats->stats_update(Pktstats_Type::Type_IPv6_Rx, ifname_);
-
-            evt_desc = ipv6_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_ipv6();
-        } break;
-        case Ether_Type::Ether_Type_IEEE8021X: {
-            present_bits.ieee8021x_eap = 1;
-            evt_desc = ieee8021x_h.deserialize(pkt, log_, pkt_dump_);
-            if (evt_desc == event_description::Evt_Parse_Ok)
-                protocols_avail.set_eap();
-        } break;
-        default:
-            evt_desc = event_description::Evt_Unknown_Error;
-        break;
-    }
+    evt_desc = dissect_l3(pkt, ether);
 
     //
     // parser failed to parse the input packet, deny it.
@@ -448,6 +965,12 @@ int parser::run(packet &pkt)
 
     if (protocols_avail.has_ipv4() ||
         protocols_avail.has_ipv6()) {
+        evt_desc = run_ip_lists();
+        if (evt_desc != event_description::Evt_Parse_Ok) {
+            evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+            return -1;
+        }
+
         evt_desc = parse_l4(pkt);
         //
         // parser failed to parse the input packet, deny it.
@@ -468,6 +991,76 @@ int parser::run(packet &pkt)
     return 0;
 }
 
+//
+// rest of the run for the packets decoded with the header views
+int parser::run_hdr_views(packet &pkt)
+{
+    event_mgr *evt_mgr = event_mgr::instance();
+    event_description evt_desc;
+    firewall_pkt_stats *stats = firewall_pkt_stats::instance();
+
+    protocols_avail.set_eth();
+
+    if (offs.has(Layer_Flag::Vlan)) {
+        stats->stats_update(Pktstats_Type::Type_VLAN_Rx, ifname_);
+        protocols_avail.set_vlan();
+    }
+
+    if (offs.has(Layer_Flag::IPv4)) {
+        stats->stats_update(Pktstats_Type::Type_IPv4_Rx, ifname_);
+        protocols_avail.set_ipv4();
+    } else {
+        stats->stats_update(Pktstats_Type::Type_IPv6_Rx, ifname_);
+        protocols_avail.set_ipv6();
+    }
+
+    if (offs.has(Layer_Flag::Tcp)) {
+        stats->stats_update(Pktstats_Type::Type_TCP_Rx, ifname_);
+        protocols_avail.set_tcp();
+    } else {
+        stats->stats_update(Pktstats_Type::Type_UDP_Rx, ifname_);
+        protocols_avail.set_udp();
+    }
+
+    //
+    // checksums are validated in this mode as well. The ipv4 header
+    // checksum goes before the ip lists, as ipv4_hdr::deserialize does in
+    // the full decode, and the l4 checksum after them.
+    if (offs.has(Layer_Flag::IPv4) &&
+        !pkt.has_rx_flag(Packet_Rx_Flag::Csum_Not_Ready) &&
+        (csum_fold(csum_partial(buf_ + offs.l3, ipv4_view(buf_ + offs.l3).hdr_len(), 0)) != 0xFFFF)) {
+        evt_desc = event_description::Evt_IPV4_Hdr_Chksum_Invalid;
+        stats->stats_update(evt_desc, ifname_);
+        evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+        return -1;
+    }
+
+    evt_desc = run_ip_lists();
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+        return -1;
+    }
+
+    evt_desc = validate_l4_checksum(pkt);
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        stats->stats_update(evt_desc, ifname_);
+        evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+        return -1;
+    }
+
+    evt_desc = parse_l4_app(pkt);
+    if (evt_desc != event_description::Evt_Parse_Ok) {
+        evt_mgr->store(event_type::Evt_Deny, evt_desc, *this);
+        return -1;
+    }
+
+    detect_os_signature();
+
+    run_rule_filters(pkt, log_, pkt_dump_);
+
+    return 0;
+}
+
 event_description parser::run_arp_filter(packet &pkt,
                                          logger *log, bool pkt_dump)
 {
@@ -496,77 +1089,418 @@ event_description parser::run_arp_filter(packet &pkt,
     return evt_desc;
 }
 
-void parser::run_rule_filters(packet &p,
-                              logger *log,
-                              bool pkt_dump)
+//
+// L3 dissectors, indexed by L3_Dissector.
+const parser::dissector_fn parser::l3_dissectors_[] = {
+    &parser::dissect_l3_unknown,
+    &parser::dissect_arp,
+    &parser::dissect_ipv4,
+    &parser::dissect_ipv6,
+    &parser::dissect_eap,
+};
+
+//
+// L4 dissectors, indexed by L4_Dissector.
+const parser::dissector_fn parser::l4_dissectors_[] = {
+    &parser::dissect_l4_unknown,
+    &parser::dissect_udp,
+    &parser::dissect_tcp,
+    &parser::dissect_icmp,
+    &parser::dissect_icmp6,
+    &parser::dissect_igmp,
+    &parser::dissect_esp,
+    &parser::dissect_gre,
+    &parser::dissect_vrrp,
+};
+
+//
+// application dissectors, indexed by App_Dissector.
+const parser::dissector_fn parser::app_dissectors_[] = {
+    &parser::dissect_app_unknown,
+    &parser::dissect_dhcp,
+    &parser::dissect_tftp,
+    &parser::dissect_ntp,
+    &parser::dissect_tls,
+    &parser::dissect_doip,
+    &parser::dissect_mqtt,
+    &parser::dissect_someip,
+};
+
+event_description parser::dissect_l3(packet &pkt, Ether_Type ether)
 {
-    std::vector<rule_config_item>::iterator it;
-    int denied = -1;
+    L3_Dissector d = reg_.l3(static_cast<uint16_t>(ether));
 
-    for (it = rule_list_->rules_cfg_.begin();
-         it != rule_list_->rules_cfg_.end(); it ++) {
-        //
-        // run eh filtering
-        if (it->sig_mask.eth_sig.active()) {
-            denied = eth_filter::instance()->run_filter(*this, it, log, pkt_dump);
-            if (denied != 0)
-                break;
-        }
+    static_assert(sizeof(l3_dissectors_) / sizeof(l3_dissectors_[0]) ==
+                  static_cast<size_t>(L3_Dissector::Max), "l3 dissector table");
 
-        //
-        // run port filtering
-        if (it->sig_mask.port_list_sig.port_list)
-            port_filter::instance()->run(*this, it, log, pkt_dump);
+    return (this->*l3_dissectors_[static_cast<uint8_t>(d)])(pkt);
+}
 
-        if (it->sig_mask.icmp_sig.icmp_non_zero_payload)
-            icmp_filter::instance()->run_filter(*this, it, log_, pkt_dump_);
+event_description parser::dissect_l4(packet &pkt, protocols_types proto)
+{
+    L4_Dissector d = reg_.l4(static_cast<uint8_t>(proto));
+
+    static_assert(sizeof(l4_dissectors_) / sizeof(l4_dissectors_[0]) ==
+                  static_cast<size_t>(L4_Dissector::Max), "l4 dissector table");
+    static_assert(sizeof(app_dissectors_) / sizeof(app_dissectors_[0]) ==
+                  static_cast<size_t>(App_Dissector::Max), "app dissector table");
+
+    offs.l4 = pkt.off;
+    offs.l4_proto = static_cast<uint8_t>(proto);
+
+    return (this->*l4_dissectors_[static_cast<uint8_t>(d)])(pkt);
+}
+
+event_description parser::dissect_l3_unknown(packet &pkt)
+{
+    return event_description::Evt_Unknown_Error;
+}
+
+event_description parser::dissect_arp(packet &pkt)
+{
+    return run_arp_filter(pkt, log_, pkt_dump_);
+}
+
+event_description parser::dissect_ipv4(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.ipv4 = 1;
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_IPv4_Rx, ifname_);
+
+    evt_desc = ipv4_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_IPV4_Hdr_Chksum_Invalid) {
+        firewall_pkt_stats::instance()->stats_update(evt_desc, ifname_);
+    }
+    if (evt_desc == event_description::Evt_Parse_Ok) {
+        protocols_avail.set_ipv4();
+        offs.set(Layer_Flag::IPv4);
     }
+
+    return evt_desc;
 }
 
-event_description parser::parse_custom_app_ports(packet &pkt,
-                                                 Packet_Direction dir,
-                                                 App_Type app_type,
-                                                 int port)
+event_description parser::dissect_ipv6(packet &pkt)
 {
-    event_description evt_desc = event_description::Evt_Unknown_Error;
+    event_description evt_desc;
+
+    present_bits.ipv6 = 1;
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_IPv6_Rx, ifname_);
+
+    evt_desc = ipv6_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok) {
+        protocols_avail.set_ipv6();
+        offs.set(Layer_Flag::IPv6);
+    }
+
+    return evt_desc;
+}
+
+event_description parser::dissect_eap(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.ieee8021x_eap = 1;
+
+    evt_desc = ieee8021x_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_eap();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_l4_unknown(packet &pkt)
+{
+    return event_description::Evt_Unknown_Protocol;
+}
+
+event_description parser::dissect_udp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.udp = 1;
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_UDP_Rx, ifname_);
+
+    evt_desc = udp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok) {
+        protocols_avail.set_udp();
+        offs.set(Layer_Flag::Udp);
+    }
+
+    return evt_desc;
+}
+
+event_description parser::dissect_tcp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.tcp = 1;
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_TCP_Rx, ifname_);
+
+    evt_desc = tcp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok) {
+        protocols_avail.set_tcp();
+        offs.set(Layer_Flag::Tcp);
+    }
+
+    return evt_desc;
+}
+
+event_description parser::dissect_icmp(packet &pkt)
+{
+    event_description evt_desc;
+
+    //
+    // set ICMP is present
+    present_bits.icmp = 1;
+
+    //
+    // update icmp rx stats
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_ICMP_Rx, ifname_);
+
+    evt_desc = icmp_filter::instance()->run_auto_sig_checks(
+                                     *this, log_, pkt_dump_);
+    if (evt_desc != event_description::Evt_Parse_Ok)
+        return evt_desc;
+
+    evt_desc = icmp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_icmp();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_icmp6(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.icmp6 = 1;
+
+    //
+    // update icmp6 rx stats
+    firewall_pkt_stats::instance()->stats_update(Pktstats_Type::Type_ICMP6_Rx, ifname_);
+
+    evt_desc = icmp6_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_icmp6();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_igmp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.igmp = 1;
+
+    evt_desc = igmp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_igmp();
+
+    return evt_desc;
+}
+
+//
+// Since ESP is an encrypted frame and we cannot track it
+// Pass this frame.
+event_description parser::dissect_esp(packet &pkt)
+{
+    return event_description::Evt_Parse_Ok;
+}
+
+//
+// tunneled frames, dissect the inner protocol. For now we parsed IPV4 in GRE.
+event_description parser::dissect_gre(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.gre = 1;
+
+    evt_desc = gre_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc != event_description::Evt_Parse_Ok)
+        return evt_desc;
+
+    protocols_avail.set_gre();
+
+    return dissect_l4(pkt, get_protocol_type());
+}
+
+event_description parser::dissect_vrrp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.vrrp = 1;
+
+    evt_desc = vrrp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_vrrp();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_app_unknown(packet &pkt)
+{
+    return event_description::Evt_Unknown_Port;
+}
+
+event_description parser::dissect_dhcp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.dhcp = 1;
+
+    evt_desc = dhcp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_dhcp();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_tftp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.tftp = 1;
+
+    evt_desc = tftp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_tftp();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_ntp(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.ntp = 1;
+
+    evt_desc = ntp_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_ntp();
+
+    return evt_desc;
+}
+
+event_description parser::dissect_tls(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.tls = 1;
+
+    evt_desc = tls_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_tls();
+
+    return evt_desc;
+}
 
-    if ((udp_h.dst_port == port) ||
-        (udp_h.src_port == port)) {
+event_description parser::dissect_doip(packet &pkt)
+{
 #if defined(FW_ENABLE_AUTOMOTIVE)
-       if (app_type == App_Type::SomeIP) {
-           evt_desc = someip_h.deserialize(pkt, log_, pkt_dump_);
-       }
+    event_description evt_desc;
+
+    present_bits.doip = 1;
+
+    evt_desc = doip_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_doip();
+
+    return evt_desc;
+#else
+    return event_description::Evt_Unknown_Port;
 #endif
-    }
+}
+
+event_description parser::dissect_mqtt(packet &pkt)
+{
+    event_description evt_desc;
+
+    present_bits.mqtt = 1;
+
+    evt_desc = mqtt_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_mqtt();
+
+    return evt_desc;
+}
+
+//
+// registered on the custom udp ports of the someip rules
+event_description parser::dissect_someip(packet &pkt)
+{
+#if defined(FW_ENABLE_AUTOMOTIVE)
+    event_description evt_desc;
+
+    present_bits.someip = 1;
+
+    evt_desc = someip_h.deserialize(pkt, log_, pkt_dump_);
+    if (evt_desc == event_description::Evt_Parse_Ok)
+        protocols_avail.set_someip();
 
     return evt_desc;
+#else
+    return event_description::Evt_Unknown_Port;
+#endif
 }
 
-event_description parser::parse_custom_ports(packet &pkt)
+void parser::run_rule_filters(packet &p,
+                              logger *log,
+                              bool pkt_dump)
 {
-    event_description evt_desc = event_description::Evt_Unknown_Port;
-    Packet_Direction dir;
-    App_Type app_type;
-    int port = -1;
+    std::vector<rule_config_item>::iterator it;
+    const port_list_level *port_lists;
+    rule_lookup_fields f;
+    rule_candidates c;
+    uint32_t rule_pos;
+    int denied = -1;
+
+    f.src_mac = get_src_mac();
+    f.dst_mac = get_dst_mac();
+    f.ethertype = get_ethertype();
+    f.has_vlan = protocols_avail.has_vlan();
+    f.vid = f.has_vlan ? get_vlan_id() : 0;
+    f.has_icmp = protocols_avail.has_icmp();
+    f.has_port = has_port();
+    f.src_port = f.has_port ? static_cast<uint16_t>(get_src_port()) : 0;
+    f.dst_port = f.has_port ? static_cast<uint16_t>(get_dst_port()) : 0;
 
-    for (auto it : rule_list_->rules_cfg_) {
-        port = -1;
+    //
+    // only the rules filed under the fields of this packet are run, in
+    // the order of their priority.
+    rule_list_->get_engine().lookup(f, c);
+
+    while (c.next(rule_pos)) {
+        it = rule_list_->rules_cfg_.begin() + rule_pos;
 
-        if (this->protocols_avail.has_udp() && it.sig_mask.udp_sig.port) {
-            dir = it.udp_rule.dir;
-            app_type = it.udp_rule.app_type;
-            port = it.udp_rule.port;
+        //
+        // run eh filtering, the first deny stops the rule walk
+        if (it->sig_mask.eth_sig.active() || it->sig_mask.vlan_sig.vid) {
+            denied = eth_filter::instance()->run_filter(*this, it, log, pkt_dump);
+            if (denied != 0)
+                break;
         }
 
-        if (port != -1) {
-            evt_desc = parse_custom_app_ports(pkt, dir, app_type, port);
-            if (evt_desc != event_description::Evt_Parse_Ok)
-                return evt_desc;
+        //
+        // run the port lists of the priority level that starts here
+        port_lists = rule_list_->get_engine().get_port_lists(rule_pos);
+        if (port_lists) {
+            denied = port_filter::instance()->run_port_lists(*this, *port_lists);
+            if (denied != 0)
+                break;
         }
-    }
 
-   return evt_desc;
-}
+        //
+        // run port range filtering
+        if (it->sig_mask.port_list_sig.port_range) {
+            denied = port_filter::instance()->run(*this, it, log, pkt_dump);
+            if (denied != 0)
+                break;
+        }
 
+        if (it->sig_mask.icmp_sig.icmp_non_zero_payload)
+            icmp_filter::instance()->run_filter(*this, it, log_, pkt_dump_);
+    }
 }
 
+}
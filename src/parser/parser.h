@@ -59,17 +59,27 @@
 #include <known_exploits.h>
 
 #include <packet.h>
+#include <hdr_views.h>
+#include <checksum.h>
+#include <config.h>
 #include <port_numbers.h>
 #include <rule_parser.h>
+#include <dissector_registry.h>
 #include <os_signatures.h>
 #include <packet_stats.h>
 #include <eth_filter.h>
 #include <arp_filter.h>
 #include <icmp_filter.h>
 #include <port_filter.h>
+#include <blacklist_ip.h>
+#include <network_map.h>
 
 namespace firewall {
 
+//
+// headers of the packet these many ahead are fetched while decoding
+#define PARSER_BATCH_PREFETCH 4
+
 /**
  * @brief - defines which protocols are available.
 */
@@ -221,6 +231,7 @@ struct protocol_present_bits {
     uint32_t ieee8021x_eap:1;
     uint32_t ipv4:1;
     uint32_t ipv6:1;
+    uint32_t ipv6_encap:1;
     uint32_t ipsec_ah:1;
     uint32_t tcp:1;
     uint32_t udp:1;
@@ -251,6 +262,17 @@ struct protocol_present_bits {
 */
 struct parser {
     public:
+        /**
+         * @brief - create a parser.
+         *
+         * The dissector registry is filled from the rules here, so the
+         * parser is created after rule_config::build(), once the rules
+         * files of all the interfaces are in.
+         *
+         * @param [in] ifname - interface the frames come from
+         * @param [in] rule_list - rules, read only while parsing
+         * @param [in] log - logger
+        */
         explicit parser(const std::string ifname,
                         rule_config *rule_list,
                         logger *log);
@@ -278,7 +300,7 @@ struct parser {
         ipv6_hdr ipv6_h;
 
         // IPv6 Encapsulation header
-        std::shared_ptr<ipv6_hdr> ipv6_encap_h;
+        ipv6_hdr ipv6_encap_h;
 
         // IPSec Authentication header
         ipsec_ah_hdr ipsec_ah_h;
@@ -343,10 +365,149 @@ struct parser {
 
         uint32_t pkt_len;
 
+        // receive timestamp of the current packet (CLOCK_REALTIME)
+        struct timespec rx_ts;
+
+        // sampling rate the current packet was inspected at
+        uint32_t sample_rate;
+
+        // offset of each layer in the current packet
+        layer_offsets offs;
+
         int run(packet &pkt);
 
+        /**
+         * @brief - run a vector of packets through the parser and filters.
+         *
+         * With the zero copy decode, each decode stage (L2, L3, L4) runs
+         * over all the packets before the next one, then the checksums,
+         * application dissectors and rule filters run for each packet.
+         * The parser is reset before each packet.
+         *
+         * @param [in] pkts - packets, at most PARSER_BATCH_MAX
+         * @param [in] n_pkts - number of packets
+         * @param [out] rets - result of run() for each packet
+        */
+        void run_batch(packet *const *pkts, uint32_t n_pkts, int *rets);
+
+        /**
+         * @brief - reset the parser to parse next packet.
+         *
+         * Only the layers that are marked present by the last run are
+         * cleared, so that one parser can be reused for every packet.
+        */
+        void reset();
+
+        /**
+         * @brief - set how the L2 to L4 headers are decoded.
+         *
+         * @param [in] mode - decode mode
+        */
+        void set_decode_mode(Parser_Decode_Mode mode) { decode_mode_ = mode; }
+
+        /**
+         * @brief - set how deep the packets are dissected.
+         *
+         * With Rules depth, the layers to dissect are taken from the
+         * rules, so set it after rule_config::build().
+         *
+         * @param [in] depth - dissect depth
+        */
+        void set_dissect_depth(Parser_Dissect_Depth depth);
+
+        /**
+         * @brief - is the layer dissected ?
+         *
+         * @param [in] layer - protocol layer
+         *
+         * @return true if the layer is dissected.
+        */
+        bool dissects(Rule_Layer layer) const
+        {
+            return !!(dissect_layers_ & static_cast<uint32_t>(layer));
+        }
+
+        /**
+         * @brief - are the headers of this packet read through views ?
+         *
+         * @return true if the L2 to L4 headers are not copied.
+        */
+        bool has_hdr_views() const { return hdr_views_; }
+
+        //
+        // header fields used by the filters and the events, read from
+        // the packet through the header views in zero copy decode mode.
+        const uint8_t *get_src_mac() const
+        {
+            return hdr_views_ ? eth_view(buf_ + offs.l2).src_mac() : eh.src_mac;
+        }
+
+        const uint8_t *get_dst_mac() const
+        {
+            return hdr_views_ ? eth_view(buf_ + offs.l2).dst_mac() : eh.dst_mac;
+        }
+
+        const std::string &get_ifname() const { return ifname_; }
+
+        //
+        // valid only if protocols_avail.has_vlan()
+        uint16_t get_vlan_id() const
+        {
+            return hdr_views_ ? (offs.vlan_tci & 0x0FFF) : vh.vid;
+        }
+
+        uint8_t get_vlan_pri() const
+        {
+            return hdr_views_ ? (offs.vlan_tci >> 13) : vh.pri;
+        }
+
+        uint16_t get_ethertype() const
+        {
+            return hdr_views_ ? eth_view(buf_ + offs.l2).ethertype() : eh.ethertype;
+        }
+
+        uint16_t get_l3_ethertype() const
+        {
+            if (hdr_views_)
+                return offs.ethertype;
+
+            return protocols_avail.has_vlan() ? vh.ethertype : eh.ethertype;
+        }
+
+        uint8_t get_ip_protocol() const
+        {
+            if (hdr_views_)
+                return offs.l4_proto;
+
+            return protocols_avail.has_ipv6() ? ipv6_h.nh : ipv4_h.protocol;
+        }
+
+        uint8_t get_ttl() const
+        {
+            if (hdr_views_) {
+                if (offs.has(Layer_Flag::IPv4))
+                    return ipv4_view(buf_ + offs.l3).ttl();
+                return ipv6_view(buf_ + offs.l3).hop_limit();
+            }
+
+            return protocols_avail.has_ipv6() ? ipv6_h.hop_limit : ipv4_h.ttl;
+        }
+
+        uint32_t get_ipv4_src_addr() const
+        {
+            return hdr_views_ ? offs.src_addr : ipv4_h.src_addr;
+        }
+
+        uint32_t get_ipv4_dst_addr() const
+        {
+            return hdr_views_ ? offs.dst_addr : ipv4_h.dst_addr;
+        }
+
         protocols_types get_protocol_type()
         {
+            if (hdr_views_)
+                return static_cast<protocols_types>(offs.l4_proto);
+
             //
             // sometimes we get tunneled frames,
             // in that case we need to find the real protocol type
@@ -371,7 +532,7 @@ struct parser {
             return false;
         }
 
-        bool has_port()
+        bool has_port() const
         {
             if (protocols_avail.has_udp() ||
                 protocols_avail.has_tcp()) {
@@ -381,8 +542,11 @@ struct parser {
             return false;
         }
 
-        Port_Numbers get_dst_port()
+        Port_Numbers get_dst_port() const
         {
+            if (hdr_views_)
+                return static_cast<Port_Numbers>(offs.dst_port);
+
             if (protocols_avail.has_udp()) {
                 return static_cast<Port_Numbers>(udp_h.dst_port);
             } else if (protocols_avail.has_tcp()) {
@@ -392,8 +556,11 @@ struct parser {
             return Port_Numbers::Port_Number_Max;
         }
 
-        Port_Numbers get_src_port()
+        Port_Numbers get_src_port() const
         {
+            if (hdr_views_)
+                return static_cast<Port_Numbers>(offs.src_port);
+
             if (protocols_avail.has_udp()) {
                 return static_cast<Port_Numbers>(udp_h.src_port);
             } else if (protocols_avail.has_tcp()) {
@@ -407,25 +574,76 @@ struct parser {
 
     private:
         void detect_os_signature();
+        int decode_hdr_views(packet &pkt);
+        int run_hdr_views(packet &pkt);
+        int run_full(packet &pkt);
+
+        inline void begin_packet(const packet &pkt)
+        {
+            pkt_len = pkt.buf_len;
+            rx_ts = pkt.rx_ts;
+            sample_rate = pkt.sample_rate;
+            buf_ = pkt.buf;
+        }
         event_description parse_l4(packet &pkt);
-        event_description parse_app_pkt(packet &pkt, Port_Numbers port);
+        event_description parse_l4_app(packet &pkt);
+        event_description validate_l4_checksum(const packet &pkt);
+        event_description run_ip_lists();
+        int check_hdr_views(packet &pkt, const layer_offsets &o);
         event_description parse_app(packet &pkt);
-        event_description parse_custom_ports(packet &pkt);
-        event_description parse_custom_app_ports(packet &pkt,
-                                                 Packet_Direction dir,
-                                                 App_Type type,
-                                                 int port);
+        event_description dissect_l3(packet &pkt, Ether_Type ether);
+        event_description dissect_l4(packet &pkt, protocols_types proto);
+
+        //
+        // dissectors of the registry, one for each dissector id.
+        event_description dissect_l3_unknown(packet &pkt);
+        event_description dissect_arp(packet &pkt);
+        event_description dissect_ipv4(packet &pkt);
+        event_description dissect_ipv6(packet &pkt);
+        event_description dissect_eap(packet &pkt);
+        event_description dissect_l4_unknown(packet &pkt);
+        event_description dissect_udp(packet &pkt);
+        event_description dissect_tcp(packet &pkt);
+        event_description dissect_icmp(packet &pkt);
+        event_description dissect_icmp6(packet &pkt);
+        event_description dissect_igmp(packet &pkt);
+        event_description dissect_esp(packet &pkt);
+        event_description dissect_gre(packet &pkt);
+        event_description dissect_vrrp(packet &pkt);
+        event_description dissect_app_unknown(packet &pkt);
+        event_description dissect_dhcp(packet &pkt);
+        event_description dissect_tftp(packet &pkt);
+        event_description dissect_ntp(packet &pkt);
+        event_description dissect_tls(packet &pkt);
+        event_description dissect_doip(packet &pkt);
+        event_description dissect_mqtt(packet &pkt);
+        event_description dissect_someip(packet &pkt);
         event_description run_arp_filter(packet &pkt, logger *log, bool pkt_dump);
         void run_rule_filters(packet &pkt,
                               logger *log,
                               bool pkt_dump);
         bool exploit_search(packet &pkt);
 
+        typedef event_description (parser::*dissector_fn)(packet &pkt);
+
+        static const dissector_fn l3_dissectors_[];
+        static const dissector_fn l4_dissectors_[];
+        static const dissector_fn app_dissectors_[];
+
         std::string ifname_;
         rule_config *rule_list_;
+        // dissector tables, built from the rules
+        dissector_registry reg_;
         logger *log_;
         exploit_match expl_;
         bool pkt_dump_;
+        Parser_Decode_Mode decode_mode_;
+        // bitmask of Rule_Layer dissected for each packet
+        uint32_t dissect_layers_;
+        // headers of the current packet are read through views
+        bool hdr_views_;
+        // frame of the current packet, valid during run
+        const uint8_t *buf_;
 };
 
 }
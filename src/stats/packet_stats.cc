@@ -7,15 +7,31 @@
 
 namespace firewall {
 
+//
+// counters of an interface are updated by all of its workers.
+static inline void stats_inc(uint64_t &counter)
+{
+    __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+}
+
 void firewall_pkt_stats::stats_update(event_description evt_desc,
                                       const std::string &ifname) noexcept
 {
     switch (evt_desc) {
         case event_description::Evt_IPV4_Hdr_Chksum_Invalid: {
-            stats_[ifname].n_ipv4_chksum_errors ++;
+            stats_inc(stats_[ifname].n_ipv4_chksum_errors);
         } break;
         case event_description::Evt_Icmp_Inval_Chksum: {
-            stats_[ifname].n_icmp_chksum_errors ++;
+            stats_inc(stats_[ifname].n_icmp_chksum_errors);
+        } break;
+        case event_description::Evt_Udp_Chksum_Invalid: {
+            stats_inc(stats_[ifname].n_udp_chksum_errors);
+        } break;
+        case event_description::Evt_Tcp_Chksum_Invalid: {
+            stats_inc(stats_[ifname].n_tcp_chksum_errors);
+        } break;
+        case event_description::Evt_Icmp6_Chksum_Invalid: {
+            stats_inc(stats_[ifname].n_icmp6_chksum_errors);
         } break;
         default:
             return;
@@ -27,46 +43,73 @@ void firewall_pkt_stats::stats_update(Pktstats_Type type,
 {
     switch (type) {
         case Pktstats_Type::Type_Rx: {
-            stats_[ifname].n_rx ++;
+            stats_inc(stats_[ifname].n_rx);
         } break;
         case Pktstats_Type::Type_VLAN_Rx: {
-            stats_[ifname].n_vlan_processed ++;
+            stats_inc(stats_[ifname].n_vlan_processed);
         } break;
         case Pktstats_Type::Type_ARP_Rx: {
-            stats_[ifname].n_arp_processed ++;
+            stats_inc(stats_[ifname].n_arp_processed);
         } break;
         case Pktstats_Type::Type_IPv4_Rx: {
-            stats_[ifname].n_ipv4_processed ++;
+            stats_inc(stats_[ifname].n_ipv4_processed);
         } break;
         case Pktstats_Type::Type_IPv6_Rx: {
-            stats_[ifname].n_ipv6_processed ++;
+            stats_inc(stats_[ifname].n_ipv6_processed);
         } break;
         case Pktstats_Type::Type_TCP_Rx: {
-            stats_[ifname].n_tcp_processed ++;
+            stats_inc(stats_[ifname].n_tcp_processed);
         } break;
         case Pktstats_Type::Type_UDP_Rx: {
-            stats_[ifname].n_udp_processed ++;
+            stats_inc(stats_[ifname].n_udp_processed);
         } break;
         case Pktstats_Type::Type_ICMP_Rx: {
-            stats_[ifname].n_icmp_processed ++;
+            stats_inc(stats_[ifname].n_icmp_processed);
         } break;
         case Pktstats_Type::Type_ICMP6_Rx: {
-            stats_[ifname].n_icmp6_processed ++;
+            stats_inc(stats_[ifname].n_icmp6_processed);
         } break;
         case Pktstats_Type::Type_MACsec_Rx: {
-            stats_[ifname].n_macsec_processed ++;
+            stats_inc(stats_[ifname].n_macsec_processed);
         } break;
         case Pktstats_Type::Type_PPPOE_Rx: {
-            stats_[ifname].n_pppoe_processed ++;
+            stats_inc(stats_[ifname].n_pppoe_processed);
         } break;
         case Pktstats_Type::Type_Deny: {
-            stats_[ifname].n_deny ++;
+            stats_inc(stats_[ifname].n_deny);
         } break;
         case Pktstats_Type::Type_Allowed: {
-            stats_[ifname].n_allowed ++;
+            stats_inc(stats_[ifname].n_allowed);
         } break;
         case Pktstats_Type::Type_Events: {
-            stats_[ifname].n_events ++;
+            stats_inc(stats_[ifname].n_events);
+        } break;
+        case Pktstats_Type::Type_Rx_Queue_Full: {
+            stats_inc(stats_[ifname].n_rx_queue_full);
+        } break;
+        case Pktstats_Type::Type_Pool_Drop: {
+            stats_inc(stats_[ifname].n_pool_drops);
+        } break;
+        case Pktstats_Type::Type_Rx_Head_Drop: {
+            stats_inc(stats_[ifname].n_rx_head_drops);
+        } break;
+        case Pktstats_Type::Type_Rx_Bulk_Drop: {
+            stats_inc(stats_[ifname].n_rx_bulk_drops);
+        } break;
+        case Pktstats_Type::Type_Pcap_Queue_Full: {
+            stats_inc(stats_[ifname].n_pcap_queue_full);
+        } break;
+        case Pktstats_Type::Type_Event_Queue_Full: {
+            stats_inc(stats_[ifname].n_event_queue_full);
+        } break;
+        case Pktstats_Type::Type_Sampled_Out: {
+            stats_inc(stats_[ifname].n_sampled_out);
+        } break;
+        case Pktstats_Type::Type_Deny_Est: {
+            stats_inc(stats_[ifname].n_deny_est);
+        } break;
+        case Pktstats_Type::Type_Fast_Path: {
+            stats_inc(stats_[ifname].n_fast_path);
         } break;
         case Pktstats_Type::Type_Startup_Time: {
             timestamp_wall(&stats_[ifname].startup_time);
@@ -76,6 +119,27 @@ void firewall_pkt_stats::stats_update(Pktstats_Type type,
     }
 }
 
+void firewall_pkt_stats::stats_update(Pktstats_Type type,
+                                      const std::string &ifname,
+                                      uint64_t n)
+{
+    switch (type) {
+        case Pktstats_Type::Type_Deny_Est: {
+            __atomic_add_fetch(&stats_[ifname].n_deny_est, n, __ATOMIC_RELAXED);
+        } break;
+        case Pktstats_Type::Type_Fast_Path: {
+            __atomic_add_fetch(&stats_[ifname].n_fast_path, n, __ATOMIC_RELAXED);
+        } break;
+        default:
+            return;
+    }
+}
+
+void firewall_pkt_stats::set_sample_rate(const std::string &ifname, uint32_t rate)
+{
+    __atomic_store_n(&stats_[ifname].sample_rate, rate, __ATOMIC_RELAXED);
+}
+
 void firewall_pkt_stats::get(const std::string &ifname, firewall_intf_stats &if_stats)
 {
     if_stats = stats_[ifname];
@@ -39,6 +39,25 @@ struct firewall_intf_stats {
     uint64_t n_pppoe_processed;
     uint64_t n_ipv4_chksum_errors;
     uint64_t n_icmp_chksum_errors;
+    uint64_t n_udp_chksum_errors;
+    uint64_t n_tcp_chksum_errors;
+    uint64_t n_icmp6_chksum_errors;
+    uint64_t n_rx_queue_full;
+    uint64_t n_pool_drops;
+    // oldest frames dropped by the drop head policy
+    uint64_t n_rx_head_drops;
+    // bulk frames dropped to keep the priority reserve
+    uint64_t n_rx_bulk_drops;
+    uint64_t n_pcap_queue_full;
+    uint64_t n_event_queue_full;
+    // frames of the flows left out by sampling
+    uint64_t n_sampled_out;
+    // denied frames scaled by the sampling rate of each
+    uint64_t n_deny_est;
+    // 1 in sample_rate flows inspected, 1 if not sampling
+    uint32_t sample_rate;
+    // frames decoded by the fast path of the zero copy decode
+    uint64_t n_fast_path;
 
     explicit firewall_intf_stats() :
                     ifname(""),
@@ -57,7 +76,20 @@ struct firewall_intf_stats {
                     n_macsec_processed(0),
                     n_pppoe_processed(0),
                     n_ipv4_chksum_errors(0),
-                    n_icmp_chksum_errors(0)
+                    n_icmp_chksum_errors(0),
+                    n_udp_chksum_errors(0),
+                    n_tcp_chksum_errors(0),
+                    n_icmp6_chksum_errors(0),
+                    n_rx_queue_full(0),
+                    n_pool_drops(0),
+                    n_rx_head_drops(0),
+                    n_rx_bulk_drops(0),
+                    n_pcap_queue_full(0),
+                    n_event_queue_full(0),
+                    n_sampled_out(0),
+                    n_deny_est(0),
+                    sample_rate(1),
+                    n_fast_path(0)
     { }
     ~firewall_intf_stats() { }
 };
@@ -78,6 +110,15 @@ enum class Pktstats_Type {
     Type_Deny,
     Type_Allowed,
     Type_Events,
+    Type_Rx_Queue_Full,
+    Type_Pool_Drop,
+    Type_Rx_Head_Drop,
+    Type_Rx_Bulk_Drop,
+    Type_Pcap_Queue_Full,
+    Type_Event_Queue_Full,
+    Type_Sampled_Out,
+    Type_Deny_Est,
+    Type_Fast_Path,
 };
 
 /**
@@ -108,6 +149,25 @@ class firewall_pkt_stats {
         */
         void stats_update(Pktstats_Type type,
                           const std::string &ifname);
+
+        /**
+         * @brief - add a count to the counters that are scaled estimates.
+         *
+         * @param [in] type - packet stats type
+         * @param [in] ifname - interface name
+         * @param [in] n - count to add
+        */
+        void stats_update(Pktstats_Type type,
+                          const std::string &ifname,
+                          uint64_t n);
+
+        /**
+         * @brief - set the current sampling rate of an interface.
+         *
+         * @param [in] ifname - interface name
+         * @param [in] rate - 1 in rate flows inspected
+        */
+        void set_sample_rate(const std::string &ifname, uint32_t rate);
         void get(const std::string &ifname, firewall_intf_stats &if_stats);
         void get(std::map<std::string, firewall_intf_stats> &stats) { stats = stats_; }
         firewall_pkt_stats(const firewall_pkt_stats &) = delete;
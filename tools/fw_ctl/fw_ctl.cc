@@ -167,6 +167,18 @@ void fw_ctl::local_sock_get_stats()
         fprintf(stderr, "\t\t n_rx: %ju\n", stats->n_rx);
         fprintf(stderr, "\t\t n_allowed: %ju\n", stats->n_allowed);
         fprintf(stderr, "\t\t n_deny: %ju\n", stats->n_deny);
+        fprintf(stderr, "\t\t n_pool_drops: %ju\n", stats->n_pool_drops);
+        fprintf(stderr, "\t\t n_rx_queue_full: %ju\n", stats->n_rx_queue_full);
+        fprintf(stderr, "\t\t n_rx_head_drops: %ju\n", stats->n_rx_head_drops);
+        fprintf(stderr, "\t\t n_rx_bulk_drops: %ju\n", stats->n_rx_bulk_drops);
+        fprintf(stderr, "\t\t n_pcap_queue_full: %ju\n", stats->n_pcap_queue_full);
+        fprintf(stderr, "\t\t n_event_queue_full: %ju\n", stats->n_event_queue_full);
+        fprintf(stderr, "\t\t sample_rate: 1/%u\n", stats->sample_rate);
+        fprintf(stderr, "\t\t n_sampled_out: %ju\n", stats->n_sampled_out);
+        fprintf(stderr, "\t\t n_deny_est: %ju\n", stats->n_deny_est);
+        fprintf(stderr, "\t\t n_fast_path: %ju (%.1f%% of n_rx)\n",
+                        stats->n_fast_path,
+                        stats->n_rx ? (100.0 * stats->n_fast_path) / stats->n_rx : 0.0);
         fprintf(stderr, "\t }\n");
 
         off += sizeof(struct fwctl_stats);
@@ -217,9 +229,13 @@ void fw_ctl::listen_for_mqtt_msgs()
         }
 
         fprintf(stderr, "event: {\n");
+        fprintf(stderr, "\t timestamp: %ld.%09ld\n",
+                        static_cast<long>(evt.ts.tv_sec),
+                        static_cast<long>(evt.ts.tv_nsec));
         fprintf(stderr, "\t event_type: %d\n", static_cast<int>(evt.evt_type));
         fprintf(stderr, "\t event_description: %d\n", static_cast<int>(evt.evt_details));
         fprintf(stderr, "\t ethertype: %04x\n", evt.ethertype);
+        fprintf(stderr, "\t sample_rate: 1/%u\n", evt.sample_rate);
         fprintf(stderr, "}\n");
     }
 }